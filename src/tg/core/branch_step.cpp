@@ -0,0 +1,26 @@
+#include "tg/core/branch_step.hpp"
+
+namespace tg::core
+{
+
+BranchStep::BranchStep(std::string_view shortname, std::string_view predicate_name)
+    : Step{}
+{
+    this->info().set_shortname(shortname);
+    this->info().set_step_type<BranchStep>();
+    this->info().add_data<bool>(predicate_name, DataUsage::Read);
+}
+
+BranchStep::~BranchStep()
+{
+}
+
+void BranchStep::execute(std::vector<VarData>& data)
+{
+    this->pre_execute_validation(data);
+    const bool taken = data.at(0).as<bool>();
+    data.at(taken ? 2u : 3u) = data.at(1);
+    this->post_execute_validation(data);
+}
+
+} // namespace tg::core
@@ -0,0 +1,65 @@
+#pragma once
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+
+namespace tg::core
+{
+
+/**
+ * @brief A Step that routes its input to one of two outputs, as decided at
+ * runtime by a boolean predicate computed by an upstream Step.
+ *
+ * @details The data is, by local index:
+ * - 0: the predicate (bool, Read);
+ * - 1: the input (T, Read);
+ * - 2: the "then" output (T, optional Write), produced if the predicate is true;
+ * - 3: the "else" output (T, optional Write), produced otherwise.
+ *
+ * The input is forwarded by sharing, not copied. The untaken output is left
+ * unproduced, so the Executor cancels the whole subgraph that depends on it.
+ * To route several data items on the same predicate, use one BranchStep per
+ * item. A Step that joins both sides should mark their outputs as optional
+ * inputs.
+ *
+ * @note Use ```create<T>()``` to construct.
+ */
+class BranchStep
+    : public Step
+{
+public:
+    /**
+     * @brief Creates a BranchStep for data of type T.
+     * @param shortname The name of the Step.
+     * @param predicate_name The name of the bool predicate data.
+     * @param input_name The name of the input data.
+     * @param then_name The name of the output taken if the predicate is true.
+     * @param else_name The name of the output taken if the predicate is false.
+     */
+    template <typename T>
+    static std::shared_ptr<BranchStep> create(
+        std::string_view shortname,
+        std::string_view predicate_name,
+        std::string_view input_name,
+        std::string_view then_name,
+        std::string_view else_name)
+    {
+        auto step = std::shared_ptr<BranchStep>(new BranchStep(shortname, predicate_name));
+        auto& info = step->info();
+        info.add_data<T>(input_name, DataUsage::Read);
+        info.add_data<T>(then_name, DataUsage::Write);
+        info.add_data<T>(else_name, DataUsage::Write);
+        info.mark_data_as_optional(then_name);
+        info.mark_data_as_optional(else_name);
+        return step;
+    }
+
+    ~BranchStep() override;
+
+    using Step::info;
+    void execute(std::vector<VarData>& data) override;
+
+private:
+    BranchStep(std::string_view shortname, std::string_view predicate_name);
+};
+
+} // namespace tg::core
@@ -0,0 +1,144 @@
+#include "tg/core/buffer_pool.hpp"
+
+namespace tg::core
+{
+
+namespace //(unnamed)
+{
+
+struct BufferFuncs
+{
+    std::function<VarData(const DataMeta&)> m_make;
+    std::function<VarData(const VarData&)> m_share;
+    std::function<bool(const VarData&)> m_is_unshared;
+};
+
+struct BufferRegistry
+{
+    std::mutex m_mutex;
+    std::unordered_map<std::type_index, BufferFuncs> m_funcs;
+};
+
+BufferRegistry& buffer_registry()
+{
+    static BufferRegistry registry;
+    return registry;
+}
+
+std::optional<BufferFuncs> find_funcs(std::type_index type)
+{
+    BufferRegistry& registry = buffer_registry();
+    std::lock_guard<std::mutex> lock(registry.m_mutex);
+    auto iter = registry.m_funcs.find(type);
+    if (iter == registry.m_funcs.end())
+    {
+        return std::nullopt;
+    }
+    return iter->second;
+}
+
+} // namespace(unnamed)
+
+BufferPool::BufferPool(size_t capacity)
+    : m_mutex{}
+    , m_capacity{capacity}
+    , m_pooled_bytes{0u}
+    , m_reuse_count{0u}
+    , m_alloc_count{0u}
+    , m_entries{}
+{
+}
+
+BufferPool::~BufferPool()
+{
+}
+
+bool BufferPool::is_registered(std::type_index type)
+{
+    return find_funcs(type).has_value();
+}
+
+bool BufferPool::is_reusable(const VarData& value)
+{
+    if (!value.is_unique())
+    {
+        return false;
+    }
+    const std::optional<BufferFuncs> funcs = find_funcs(value.type());
+    return funcs.has_value() && funcs->m_is_unshared(value);
+}
+
+VarData BufferPool::acquire(std::type_index type, const DataMeta& meta)
+{
+    if (!meta.is_exact())
+    {
+        return VarData{};
+    }
+    const std::optional<BufferFuncs> funcs = find_funcs(type);
+    if (!funcs.has_value())
+    {
+        return VarData{};
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (Entry& entry : m_entries)
+        {
+            if (entry.m_type == type && entry.m_meta == meta && funcs->m_is_unshared(entry.m_master))
+            {
+                ++m_reuse_count;
+                return funcs->m_share(entry.m_master);
+            }
+        }
+        ++m_alloc_count;
+    }
+    // Allocated outside the lock; the pixels are the expensive part.
+    VarData master = funcs->m_make(meta);
+    const size_t bytes = meta.bytes();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_pooled_bytes + bytes > m_capacity)
+    {
+        return master;
+    }
+    m_pooled_bytes += bytes;
+    m_entries.push_back(Entry{type, meta, master});
+    return funcs->m_share(master);
+}
+
+size_t BufferPool::capacity() const
+{
+    return m_capacity;
+}
+
+size_t BufferPool::pooled_bytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pooled_bytes;
+}
+
+size_t BufferPool::reuse_count() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_reuse_count;
+}
+
+size_t BufferPool::alloc_count() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_alloc_count;
+}
+
+void BufferPool::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_pooled_bytes = 0u;
+}
+
+void BufferPool::stc_register(std::type_index type, MakeFunc make, ShareFunc share, UnsharedFunc is_unshared)
+{
+    BufferRegistry& registry = buffer_registry();
+    std::lock_guard<std::mutex> lock(registry.m_mutex);
+    registry.m_funcs[type] = BufferFuncs{std::move(make), std::move(share), std::move(is_unshared)};
+}
+
+} // namespace tg::core
@@ -0,0 +1,123 @@
+#pragma once
+#include "tg/core/fwd.hpp"
+#include "tg/core/data_meta.hpp"
+
+namespace tg::core
+{
+
+/**
+ * @brief A pool of output buffers, reused across runs, from which the
+ * Executor preallocates the outputs of Steps whose shape is inferred (see
+ * ```Executor::set_buffer_pool()```).
+ *
+ * @details The pool keeps one master buffer per allocation, and hands out
+ * values that share its storage. A master is reused for a later request
+ * with the same type and metadata once nothing but the pool refers to its
+ * storage any more, i.e. once the run that received it has dropped or
+ * overwritten it. Hence a result kept by the caller is never overwritten.
+ *
+ * The core does not know the buffer types; each library registers its own,
+ * e.g. ```tg::opencv::register_buffer_types()``` for ```cv::Mat```. The
+ * copy of a registered type must share storage (as ```cv::Mat``` does).
+ *
+ * Buffers beyond the capacity are still allocated, but not pooled.
+ *
+ * @note Thread-safe.
+ */
+class BufferPool
+{
+public:
+    static constexpr size_t default_capacity = size_t{256u} << 20u;
+
+    explicit BufferPool(size_t capacity = default_capacity);
+    ~BufferPool();
+
+public:
+    /**
+     * @brief Registers (or replaces) how buffers of type T are made, and how
+     * to tell that a master buffer is no longer shared.
+     */
+    template <typename T>
+    static void register_type(std::function<T(const DataMeta&)> make, std::function<bool(const T&)> is_unshared)
+    {
+        if (!make || !is_unshared)
+        {
+            throw std::invalid_argument("BufferPool::register_type(): functions cannot be empty.");
+        }
+        stc_register(
+            std::type_index(typeid(T)),
+            [make](const DataMeta& meta) -> VarData {
+                return std::make_shared<T>(make(meta));
+            },
+            [](const VarData& master) -> VarData {
+                return std::make_shared<T>(master.as<T>());
+            },
+            [is_unshared](const VarData& master) -> bool {
+                return is_unshared(master.as<T>());
+            }
+        );
+    }
+
+    /**
+     * @brief Whether buffers of the type can be made.
+     */
+    static bool is_registered(std::type_index type);
+
+    /**
+     * @brief Whether a value of a registered type may be written over:
+     * nothing else refers to it or to its storage. False if empty or of
+     * an unregistered type.
+     */
+    static bool is_reusable(const VarData& value);
+
+    /**
+     * @brief Returns a buffer of the type with the given (exact) metadata,
+     * reusing a pooled one if possible; or an empty VarData if the type is
+     * not registered or the metadata is not exact.
+     */
+    VarData acquire(std::type_index type, const DataMeta& meta);
+
+    size_t capacity() const;
+    size_t pooled_bytes() const;
+
+    /**
+     * @brief The number of requests served by a pooled buffer, and by a new
+     * one.
+     */
+    size_t reuse_count() const;
+    size_t alloc_count() const;
+
+    /**
+     * @brief Drops all pooled buffers; those still in use live on, unpooled.
+     */
+    void clear();
+
+private:
+    using MakeFunc = std::function<VarData(const DataMeta&)>;
+    using ShareFunc = std::function<VarData(const VarData&)>;
+    using UnsharedFunc = std::function<bool(const VarData&)>;
+    static void stc_register(std::type_index type, MakeFunc make, ShareFunc share, UnsharedFunc is_unshared);
+
+private:
+    BufferPool(const BufferPool&) = delete;
+    BufferPool(BufferPool&&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+    BufferPool& operator=(BufferPool&&) = delete;
+
+private:
+    struct Entry
+    {
+        std::type_index m_type;
+        DataMeta m_meta;
+        VarData m_master;
+    };
+
+    mutable std::mutex m_mutex;
+    size_t m_capacity;
+    size_t m_pooled_bytes;
+    size_t m_reuse_count;
+    size_t m_alloc_count;
+    std::vector<Entry> m_entries;
+};
+
+} // namespace tg::core
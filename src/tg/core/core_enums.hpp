@@ -10,4 +10,48 @@ enum class DataUsage
     Consume
 };
 
+/**
+ * @brief How a ScopeStep is executed within its parent.
+ */
+enum class ScopeStepMode
+{
+    /**
+     * @brief The Steps of the nested Scope are flattened into the parent Plan.
+     */
+    Inline,
+
+    /**
+     * @brief The nested Scope runs as one task, with its own sub-Executor.
+     */
+    Macro
+};
+
+/**
+ * @brief The lane of a ThreadPool task.
+ *
+ * @details Latency-critical tasks are always taken before batch tasks,
+ * except for the share of picks reserved for batch work (see
+ * ```ThreadPool::set_batch_share()```).
+ */
+enum class TaskPriority
+{
+    Latency,
+    Batch
+};
+
+/**
+ * @brief The state of a RunControl.
+ */
+enum class RunStatus
+{
+    Active,
+    Cancelled,
+    DeadlineExceeded,
+
+    /**
+     * @brief The run completed; later cancellation has no effect.
+     */
+    Finished
+};
+
 } // namespace tg::core
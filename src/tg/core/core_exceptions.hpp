@@ -11,4 +11,10 @@ class StepInfoNotEmpty : std::runtime_error { using std::runtime_error::runtime_
 class StepInfoNameNotFound : std::runtime_error { using std::runtime_error::runtime_error; };
 class StepInfoBadIndex : std::runtime_error { using std::runtime_error::runtime_error; };
 
+/**
+ * @brief Thrown by ```Executor::run()``` when the run was stopped by its
+ * RunControl (cancelled, or past its deadline).
+ */
+class RunCancelled : public std::runtime_error { using std::runtime_error::runtime_error; };
+
 } // namespace tg::core
@@ -0,0 +1,493 @@
+#include <algorithm>
+#include "tg/core/dag_validator.hpp"
+#include "tg/core/data_info_tuple.hpp"
+#include "tg/core/details/binding_resolver.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+
+namespace tg::core
+{
+
+struct DagValidator::StepNode
+{
+    StepPtr m_step;
+
+    /**
+     * @brief Data the Step cannot start without (non-optional Read or Consume).
+     */
+    std::vector<size_t> m_required;
+
+    /**
+     * @brief All data the Step reads, including optional reads.
+     */
+    std::vector<size_t> m_read;
+    std::vector<size_t> m_consumed;
+    std::vector<size_t> m_written;
+    bool m_alive;
+    bool m_reached;
+    size_t m_pending;
+};
+
+struct DagValidator::DataNode
+{
+    std::string m_name;
+    std::vector<size_t> m_writers;
+    std::vector<size_t> m_readers;
+    std::vector<size_t> m_consumers;
+
+    /**
+     * @brief Steps that require the data (see ```StepNode::m_required```).
+     */
+    std::vector<size_t> m_dependents;
+    bool m_global_input;
+    bool m_ready;
+};
+
+namespace //(unnamed)
+{
+
+void erase_value(std::vector<size_t>& values, size_t value)
+{
+    auto iter = std::find(values.begin(), values.end(), value);
+    if (iter != values.end())
+    {
+        values.erase(iter);
+    }
+}
+
+} // namespace(unnamed)
+
+bool ValidationReport::is_valid() const
+{
+    return m_unreachable_steps.empty() &&
+        m_unproduced_reads.empty() &&
+        m_multiple_writers.empty() &&
+        m_multiple_consumers.empty();
+}
+
+DagValidator::DagValidator()
+    : m_steps{}
+    , m_data{}
+    , m_data_by_name{}
+    , m_dirty_data{}
+    , m_dirty_steps{}
+    , m_validated{false}
+    , m_cone_epoch{}
+    , m_epoch{0u}
+    , m_unreachable_steps{}
+    , m_unproduced_data{}
+    , m_multiple_writers{}
+    , m_multiple_consumers{}
+{
+}
+
+DagValidator::DagValidator(const Scope& scope)
+    : DagValidator()
+{
+    details::BindingResolver resolver(scope);
+    for (const auto& binding : resolver.bindings())
+    {
+        this->add_step(binding.m_step, binding.m_data_infos);
+    }
+}
+
+DagValidator::~DagValidator()
+{
+}
+
+void DagValidator::declare_global_input(std::string_view data_name)
+{
+    const size_t data_id = this->detail_data_id(std::string(data_name));
+    m_data.at(data_id).m_global_input = true;
+    this->detail_mark_dirty(data_id);
+}
+
+size_t DagValidator::add_step(StepPtr step)
+{
+    if (!step)
+    {
+        throw std::invalid_argument("DagValidator::add_step(): step cannot be null.");
+    }
+    std::vector<DataInfoTuple> data_infos;
+    step->info().get_data_infos(data_infos);
+    return this->add_step(std::move(step), data_infos);
+}
+
+size_t DagValidator::add_step(StepPtr step, const std::vector<DataInfoTuple>& data_infos)
+{
+    if (!step)
+    {
+        throw std::invalid_argument("DagValidator::add_step(): step cannot be null.");
+    }
+    const size_t step_id = m_steps.size();
+    StepNode& node = m_steps.emplace_back();
+    node.m_step = std::move(step);
+    node.m_alive = true;
+    node.m_reached = false;
+    node.m_pending = 0u;
+    for (const auto& data_info : data_infos)
+    {
+        const size_t data_id = this->detail_data_id(data_info.m_shortname);
+        DataNode& data = m_data.at(data_id);
+        switch (data_info.m_usage)
+        {
+        case DataUsage::Read:
+            node.m_read.push_back(data_id);
+            data.m_readers.push_back(step_id);
+            break;
+        case DataUsage::Consume:
+            node.m_consumed.push_back(data_id);
+            data.m_consumers.push_back(step_id);
+            break;
+        case DataUsage::Write:
+            node.m_written.push_back(data_id);
+            data.m_writers.push_back(step_id);
+            break;
+        }
+        if (data_info.m_usage != DataUsage::Write && !data_info.m_optional)
+        {
+            node.m_required.push_back(data_id);
+            data.m_dependents.push_back(step_id);
+        }
+        this->detail_mark_dirty(data_id);
+    }
+    m_cone_epoch.push_back(0u);
+    m_dirty_steps.push_back(step_id);
+    return step_id;
+}
+
+void DagValidator::remove_step(size_t step_id)
+{
+    if (step_id >= m_steps.size() || !m_steps.at(step_id).m_alive)
+    {
+        throw std::out_of_range("DagValidator::remove_step(): no such step.");
+    }
+    StepNode& node = m_steps.at(step_id);
+    for (size_t data_id : node.m_read)
+    {
+        erase_value(m_data.at(data_id).m_readers, step_id);
+        this->detail_mark_dirty(data_id);
+    }
+    for (size_t data_id : node.m_consumed)
+    {
+        erase_value(m_data.at(data_id).m_consumers, step_id);
+        this->detail_mark_dirty(data_id);
+    }
+    for (size_t data_id : node.m_written)
+    {
+        erase_value(m_data.at(data_id).m_writers, step_id);
+        this->detail_mark_dirty(data_id);
+    }
+    for (size_t data_id : node.m_required)
+    {
+        erase_value(m_data.at(data_id).m_dependents, step_id);
+    }
+    node = StepNode{};
+    node.m_alive = false;
+    node.m_reached = false;
+    node.m_pending = 0u;
+    m_unreachable_steps.erase(step_id);
+}
+
+ValidationReport DagValidator::validate()
+{
+    m_validated = false;
+    return this->revalidate();
+}
+
+ValidationReport DagValidator::revalidate()
+{
+    if (!m_validated)
+    {
+        m_dirty_data.clear();
+        m_dirty_steps.clear();
+        for (size_t data_id = 0u; data_id < m_data.size(); ++data_id)
+        {
+            m_dirty_data.push_back(data_id);
+        }
+        for (size_t step_id = 0u; step_id < m_steps.size(); ++step_id)
+        {
+            m_dirty_steps.push_back(step_id);
+        }
+    }
+    for (size_t data_id : m_dirty_data)
+    {
+        this->detail_update_data_issues(data_id);
+    }
+    std::vector<size_t> cone;
+    this->detail_collect_cone(cone);
+    this->detail_visit_cone(cone);
+    m_dirty_data.clear();
+    m_dirty_steps.clear();
+    m_validated = true;
+    return this->detail_report();
+}
+
+size_t DagValidator::step_count() const
+{
+    return m_steps.size();
+}
+
+size_t DagValidator::data_count() const
+{
+    return m_data.size();
+}
+
+bool DagValidator::is_step_alive(size_t step_id) const
+{
+    return m_steps.at(step_id).m_alive;
+}
+
+const StepPtr& DagValidator::step_at(size_t step_id) const
+{
+    return m_steps.at(step_id).m_step;
+}
+
+const std::string& DagValidator::data_name(size_t data_id) const
+{
+    return m_data.at(data_id).m_name;
+}
+
+std::optional<size_t> DagValidator::find_data(std::string_view data_name) const
+{
+    auto iter = m_data_by_name.find(std::string(data_name));
+    if (iter == m_data_by_name.end())
+    {
+        return std::nullopt;
+    }
+    return iter->second;
+}
+
+std::string DagValidator::describe(const ValidationReport& report) const
+{
+    auto step_label = [this](size_t step_id) {
+        return "Step " + m_steps.at(step_id).m_step->info().shortname() + " (#" + std::to_string(step_id) + ")";
+    };
+    std::string result;
+    for (size_t data_id : report.m_multiple_writers)
+    {
+        result += "Data " + m_data.at(data_id).m_name + " has multiple writers.\n";
+    }
+    for (size_t data_id : report.m_multiple_consumers)
+    {
+        result += "Data " + m_data.at(data_id).m_name + " has multiple consumers.\n";
+    }
+    for (const auto& [step_id, data_id] : report.m_unproduced_reads)
+    {
+        result += step_label(step_id) + " reads " + m_data.at(data_id).m_name + ", which is never produced.\n";
+    }
+    for (size_t step_id : report.m_unreachable_steps)
+    {
+        result += step_label(step_id) + " is unreachable.\n";
+    }
+    return result;
+}
+
+size_t DagValidator::detail_data_id(const std::string& data_name)
+{
+    auto [iter, inserted] = m_data_by_name.emplace(data_name, m_data.size());
+    if (inserted)
+    {
+        DataNode& data = m_data.emplace_back();
+        data.m_name = data_name;
+        data.m_global_input = false;
+        data.m_ready = false;
+    }
+    return iter->second;
+}
+
+void DagValidator::detail_mark_dirty(size_t data_id)
+{
+    m_dirty_data.push_back(data_id);
+}
+
+void DagValidator::detail_update_data_issues(size_t data_id)
+{
+    const DataNode& data = m_data.at(data_id);
+    auto update = [data_id](std::set<size_t>& issues, bool found) {
+        if (found)
+        {
+            issues.insert(data_id);
+        }
+        else
+        {
+            issues.erase(data_id);
+        }
+    };
+    update(m_multiple_writers, data.m_writers.size() > 1u);
+    update(m_multiple_consumers, data.m_consumers.size() > 1u);
+    update(m_unproduced_data, data.m_writers.empty() && !data.m_global_input && !data.m_dependents.empty());
+}
+
+void DagValidator::detail_collect_cone(std::vector<size_t>& cone)
+{
+    /**
+     * @note The reachability of a Step only depends on its upstream, so the
+     * region to revisit is everything downstream of the edited Steps and
+     * data (the forward cone).
+     */
+    ++m_epoch;
+    auto enter = [this, &cone](size_t step_id) {
+        if (m_steps.at(step_id).m_alive && m_cone_epoch.at(step_id) != m_epoch)
+        {
+            m_cone_epoch.at(step_id) = m_epoch;
+            cone.push_back(step_id);
+        }
+    };
+    for (size_t step_id : m_dirty_steps)
+    {
+        enter(step_id);
+    }
+    for (size_t data_id : m_dirty_data)
+    {
+        const DataNode& data = m_data.at(data_id);
+        for (size_t step_id : data.m_dependents)
+        {
+            enter(step_id);
+        }
+        for (size_t step_id : data.m_consumers)
+        {
+            enter(step_id);
+        }
+    }
+    for (size_t visit = 0u; visit < cone.size(); ++visit)
+    {
+        const StepNode& node = m_steps.at(cone.at(visit));
+        for (size_t data_id : node.m_written)
+        {
+            for (size_t step_id : m_data.at(data_id).m_dependents)
+            {
+                enter(step_id);
+            }
+            for (size_t step_id : m_data.at(data_id).m_consumers)
+            {
+                enter(step_id);
+            }
+        }
+        for (size_t data_id : node.m_read)
+        {
+            for (size_t step_id : m_data.at(data_id).m_consumers)
+            {
+                enter(step_id);
+            }
+        }
+    }
+}
+
+void DagValidator::detail_visit_cone(const std::vector<size_t>& cone)
+{
+    auto in_cone = [this](size_t step_id) {
+        return m_cone_epoch.at(step_id) == m_epoch;
+    };
+    for (size_t step_id : cone)
+    {
+        m_steps.at(step_id).m_reached = false;
+    }
+    // Data availability from outside the cone.
+    auto refresh_ready = [this](size_t data_id) {
+        DataNode& data = m_data.at(data_id);
+        data.m_ready = data.m_global_input;
+        for (size_t writer : data.m_writers)
+        {
+            data.m_ready = data.m_ready || m_steps.at(writer).m_reached;
+        }
+    };
+    for (size_t data_id : m_dirty_data)
+    {
+        refresh_ready(data_id);
+    }
+    for (size_t step_id : cone)
+    {
+        for (size_t data_id : m_steps.at(step_id).m_written)
+        {
+            refresh_ready(data_id);
+        }
+    }
+    // Kahn's algorithm restricted to the cone.
+    std::vector<size_t> queue;
+    for (size_t step_id : cone)
+    {
+        StepNode& node = m_steps.at(step_id);
+        node.m_pending = 0u;
+        for (size_t data_id : node.m_required)
+        {
+            node.m_pending += m_data.at(data_id).m_ready ? 0u : 1u;
+        }
+        for (size_t data_id : node.m_consumed)
+        {
+            for (size_t reader : m_data.at(data_id).m_readers)
+            {
+                node.m_pending += (reader != step_id && !m_steps.at(reader).m_reached) ? 1u : 0u;
+            }
+        }
+        if (node.m_pending == 0u)
+        {
+            queue.push_back(step_id);
+        }
+    }
+    auto release = [this, &queue, &in_cone](size_t step_id) {
+        if (in_cone(step_id) && --m_steps.at(step_id).m_pending == 0u)
+        {
+            queue.push_back(step_id);
+        }
+    };
+    for (size_t visit = 0u; visit < queue.size(); ++visit)
+    {
+        const size_t step_id = queue.at(visit);
+        StepNode& node = m_steps.at(step_id);
+        node.m_reached = true;
+        for (size_t data_id : node.m_written)
+        {
+            DataNode& data = m_data.at(data_id);
+            if (data.m_ready)
+            {
+                continue;
+            }
+            data.m_ready = true;
+            for (size_t dependent : data.m_dependents)
+            {
+                release(dependent);
+            }
+        }
+        for (size_t data_id : node.m_read)
+        {
+            for (size_t consumer : m_data.at(data_id).m_consumers)
+            {
+                if (consumer != step_id)
+                {
+                    release(consumer);
+                }
+            }
+        }
+    }
+    for (size_t step_id : cone)
+    {
+        if (m_steps.at(step_id).m_reached)
+        {
+            m_unreachable_steps.erase(step_id);
+        }
+        else
+        {
+            m_unreachable_steps.insert(step_id);
+        }
+    }
+}
+
+ValidationReport DagValidator::detail_report() const
+{
+    ValidationReport report;
+    report.m_unreachable_steps.assign(m_unreachable_steps.begin(), m_unreachable_steps.end());
+    report.m_multiple_writers.assign(m_multiple_writers.begin(), m_multiple_writers.end());
+    report.m_multiple_consumers.assign(m_multiple_consumers.begin(), m_multiple_consumers.end());
+    for (size_t data_id : m_unproduced_data)
+    {
+        for (size_t step_id : m_data.at(data_id).m_dependents)
+        {
+            report.m_unproduced_reads.emplace_back(step_id, data_id);
+        }
+    }
+    std::sort(report.m_unproduced_reads.begin(), report.m_unproduced_reads.end());
+    return report;
+}
+
+} // namespace tg::core
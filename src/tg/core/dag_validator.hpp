@@ -0,0 +1,174 @@
+#pragma once
+#include <set>
+#include "tg/core/fwd.hpp"
+
+namespace tg::core
+{
+
+/**
+ * @brief The findings of a DagValidator pass; identifiers refer to the
+ * step and data ids of the validator.
+ */
+struct ValidationReport
+{
+public:
+    /**
+     * @brief Steps that can never start from the global inputs: blocked by
+     * an unproduced read, part of a cycle, or downstream of such Steps.
+     */
+    std::vector<size_t> m_unreachable_steps;
+
+    /**
+     * @brief Pairs of (step id, data id) where a Step requires data that
+     * has no writer and is not a declared global input.
+     */
+    std::vector<std::pair<size_t, size_t>> m_unproduced_reads;
+
+    /**
+     * @brief Data with more than one writer.
+     */
+    std::vector<size_t> m_multiple_writers;
+
+    /**
+     * @brief Data with more than one consumer.
+     */
+    std::vector<size_t> m_multiple_consumers;
+
+public:
+    bool is_valid() const;
+};
+
+/**
+ * @brief Validates the dependency graph of Steps and data before it is
+ * compiled into a Plan, and re-validates it incrementally after edits.
+ *
+ * @details The graph is bipartite: a Step depends on the data it requires
+ * (non-optional Read or Consume), and data becomes available once any of its
+ * writers has run, or from the start if it is a declared global input. A
+ * consumer additionally waits for all other readers of the data. Unlike the
+ * Plan, the validator accepts any graph, so that every deviation can be
+ * reported at once.
+ *
+ * ```validate()``` visits every Step reachable from the global inputs in
+ * one O(V+E) pass (Kahn's algorithm); unvisited Steps are unreachable. After
+ * ```add_step()```, ```remove_step()``` or ```declare_global_input()```,
+ * ```revalidate()``` visits only the affected region: the Steps downstream
+ * of the edited data, whose reachability may have changed. The findings
+ * elsewhere are kept from the previous pass.
+ *
+ * Step ids are stable; a removed Step leaves a tombstone.
+ *
+ * @note Not thread-safe.
+ */
+class DagValidator
+{
+public:
+    /**
+     * @brief Creates an empty validator, to be populated with ```add_step()```.
+     */
+    DagValidator();
+
+    /**
+     * @brief Creates a validator with the Steps of a frozen Scope, with
+     * data names resolved as the Plan would (inline ScopeSteps, wires).
+     */
+    explicit DagValidator(const Scope& scope);
+
+    ~DagValidator();
+
+public:
+    /**
+     * @brief Declares data that the caller provides before execution.
+     */
+    void declare_global_input(std::string_view data_name);
+
+    /**
+     * @brief Adds a Step, bound to data by the short names in its StepInfo.
+     * @returns The step id.
+     */
+    size_t add_step(StepPtr step);
+
+    /**
+     * @brief Adds a Step, bound to data by the given data infos.
+     * @returns The step id.
+     */
+    size_t add_step(StepPtr step, const std::vector<DataInfoTuple>& data_infos);
+
+    /**
+     * @brief Removes a Step.
+     * @exception std::out_of_range if there is no such Step.
+     */
+    void remove_step(size_t step_id);
+
+    /**
+     * @brief Validates the whole graph.
+     */
+    ValidationReport validate();
+
+    /**
+     * @brief Validates only the region affected by the edits since the
+     * last pass; equivalent to ```validate()``` for the first pass.
+     */
+    ValidationReport revalidate();
+
+    /**
+     * @brief The number of step ids, including removed Steps.
+     */
+    size_t step_count() const;
+    size_t data_count() const;
+    bool is_step_alive(size_t step_id) const;
+    const StepPtr& step_at(size_t step_id) const;
+    const std::string& data_name(size_t data_id) const;
+    std::optional<size_t> find_data(std::string_view data_name) const;
+
+    /**
+     * @brief Formats a report with step and data names, one finding per line.
+     */
+    std::string describe(const ValidationReport& report) const;
+
+private:
+    struct StepNode;
+    struct DataNode;
+
+private:
+    size_t detail_data_id(const std::string& data_name);
+    void detail_mark_dirty(size_t data_id);
+    void detail_update_data_issues(size_t data_id);
+    void detail_collect_cone(std::vector<size_t>& cone);
+    void detail_visit_cone(const std::vector<size_t>& cone);
+    ValidationReport detail_report() const;
+
+private:
+    DagValidator(const DagValidator&) = delete;
+    DagValidator(DagValidator&&) = delete;
+    DagValidator& operator=(const DagValidator&) = delete;
+    DagValidator& operator=(DagValidator&&) = delete;
+
+private:
+    std::vector<StepNode> m_steps;
+    std::vector<DataNode> m_data;
+    std::unordered_map<std::string, size_t> m_data_by_name;
+
+    /**
+     * @brief Edits since the last pass.
+     */
+    std::vector<size_t> m_dirty_data;
+    std::vector<size_t> m_dirty_steps;
+    bool m_validated;
+
+    /**
+     * @brief Cone membership by epoch, to avoid clearing marks per pass.
+     */
+    std::vector<size_t> m_cone_epoch;
+    size_t m_epoch;
+
+    /**
+     * @brief Current findings, maintained per pass.
+     */
+    std::set<size_t> m_unreachable_steps;
+    std::set<size_t> m_unproduced_data;
+    std::set<size_t> m_multiple_writers;
+    std::set<size_t> m_multiple_consumers;
+};
+
+} // namespace tg::core
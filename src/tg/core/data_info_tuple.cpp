@@ -8,6 +8,7 @@ DataInfoTuple::DataInfoTuple(size_t local_index, std::string shortname, DataUsag
     , m_shortname(std::move(shortname))
     , m_usage(usage)
     , m_type(type)
+    , m_optional(false)
 {}
 
 DataInfoTuple::~DataInfoTuple() = default;
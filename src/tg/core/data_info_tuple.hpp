@@ -15,6 +15,12 @@ public:
     DataUsage m_usage;
     std::type_index m_type;
 
+    /**
+     * @brief An optional input may be absent (never produced) without
+     * cancelling the Step; an optional output may be left unproduced.
+     */
+    bool m_optional;
+
 public:
     DataInfoTuple(size_t local_index, std::string shortname, DataUsage usage, std::type_index type);
     ~DataInfoTuple();
@@ -0,0 +1,93 @@
+#include "tg/core/data_meta.hpp"
+
+namespace tg::core
+{
+
+namespace //(unnamed)
+{
+
+using MetaFuncs = std::unordered_map<std::type_index, std::function<std::optional<DataMeta>(const VarData&)>>;
+
+/**
+ * @brief The functions are an immutable map, replaced atomically by
+ * registration; executions describe their inputs without locking.
+ */
+struct MetaRegistry
+{
+    std::mutex m_mutex;
+    std::shared_ptr<const MetaFuncs> m_sp_funcs = std::make_shared<const MetaFuncs>();
+};
+
+MetaRegistry& meta_registry()
+{
+    static MetaRegistry registry;
+    return registry;
+}
+
+} // namespace(unnamed)
+
+DataMeta::DataMeta()
+    : DataMeta{unknown_extent, unknown_extent, 0, 0u}
+{
+}
+
+DataMeta::DataMeta(int rows, int cols, int type, size_t elem_size)
+    : m_rows{rows}
+    , m_cols{cols}
+    , m_type{type}
+    , m_elem_size{elem_size}
+{
+}
+
+bool DataMeta::is_exact() const
+{
+    return m_rows >= 0 && m_cols >= 0;
+}
+
+size_t DataMeta::bytes() const
+{
+    if (!this->is_exact())
+    {
+        return 0u;
+    }
+    return static_cast<size_t>(m_rows) * static_cast<size_t>(m_cols) * m_elem_size;
+}
+
+bool DataMeta::operator==(const DataMeta& other) const
+{
+    return m_rows == other.m_rows &&
+        m_cols == other.m_cols &&
+        m_type == other.m_type &&
+        m_elem_size == other.m_elem_size;
+}
+
+bool DataMeta::operator!=(const DataMeta& other) const
+{
+    return !(*this == other);
+}
+
+std::optional<DataMeta> DataMeta::of(const VarData& value)
+{
+    if (!value.has_value())
+    {
+        return std::nullopt;
+    }
+    const std::shared_ptr<const MetaFuncs> funcs = std::atomic_load(&meta_registry().m_sp_funcs);
+    auto iter = funcs->find(value.type());
+    if (iter == funcs->end())
+    {
+        return std::nullopt;
+    }
+    return iter->second(value);
+}
+
+void DataMeta::stc_register(std::type_index type, ErasedFunc func)
+{
+    MetaRegistry& registry = meta_registry();
+    std::lock_guard<std::mutex> lock(registry.m_mutex);
+    auto next = std::make_shared<MetaFuncs>(*std::atomic_load(&registry.m_sp_funcs));
+    (*next)[type] = std::move(func);
+    std::atomic_store(&registry.m_sp_funcs, std::shared_ptr<const MetaFuncs>(std::move(next)));
+}
+
+} // namespace tg::core
@@ -0,0 +1,75 @@
+#pragma once
+#include "tg/core/fwd.hpp"
+
+namespace tg::core
+{
+
+/**
+ * @brief The shape and element type of a dense 2D array, known before its
+ * buffer exists; used by shape inference (see ShapeInference).
+ *
+ * @details The core library does not depend on OpenCV, therefore this is a
+ * plain value type: ```m_type``` is an opaque element type code (for
+ * ```cv::Mat```, the OpenCV type such as ```CV_8UC3```), and
+ * ```m_elem_size``` is the size of one element, including all channels.
+ *
+ * An extent that depends on the data itself (e.g. the number of connected
+ * components) is ```unknown_extent```; such a DataMeta is not exact.
+ */
+struct DataMeta
+{
+public:
+    static constexpr int unknown_extent = -1;
+
+    int m_rows;
+    int m_cols;
+    int m_type;
+    size_t m_elem_size;
+
+public:
+    DataMeta();
+    DataMeta(int rows, int cols, int type, size_t elem_size);
+
+    /**
+     * @brief Whether both extents are known.
+     */
+    bool is_exact() const;
+
+    /**
+     * @brief The bytes of the buffer, or zero if the DataMeta is not exact.
+     */
+    size_t bytes() const;
+
+    bool operator==(const DataMeta& other) const;
+    bool operator!=(const DataMeta& other) const;
+
+public:
+    /**
+     * @brief Registers (or replaces) the function that describes a value of
+     * type T, e.g. ```tg::opencv::register_data_meta()``` for ```cv::Mat```.
+     * @note Thread-safe.
+     */
+    template <typename T>
+    static void register_type(std::function<std::optional<DataMeta>(const T&)> func)
+    {
+        if (!func)
+        {
+            throw std::invalid_argument("DataMeta::register_type(): function cannot be empty.");
+        }
+        stc_register(std::type_index(typeid(T)), [func](const VarData& value) -> std::optional<DataMeta> {
+            return func(value.as<T>());
+        });
+    }
+
+    /**
+     * @brief Describes a value, or nullopt if it is empty or of an
+     * unregistered type.
+     */
+    static std::optional<DataMeta> of(const VarData& value);
+
+private:
+    using ErasedFunc = std::function<std::optional<DataMeta>(const VarData&)>;
+    static void stc_register(std::type_index type, ErasedFunc func);
+};
+
+} // namespace tg::core
@@ -0,0 +1,50 @@
+#include "tg/core/data_size.hpp"
+
+namespace tg::core
+{
+
+namespace //(unnamed)
+{
+
+struct SizeRegistry
+{
+    std::mutex m_mutex;
+    std::unordered_map<std::type_index, std::function<size_t(const VarData&)>> m_funcs;
+};
+
+SizeRegistry& size_registry()
+{
+    static SizeRegistry registry;
+    return registry;
+}
+
+} // namespace(unnamed)
+
+size_t DataSize::bytes_of(const VarData& value)
+{
+    if (!value.has_value())
+    {
+        return 0u;
+    }
+    ErasedFunc func;
+    {
+        SizeRegistry& registry = size_registry();
+        std::lock_guard<std::mutex> lock(registry.m_mutex);
+        auto iter = registry.m_funcs.find(value.type());
+        if (iter == registry.m_funcs.end())
+        {
+            return 0u;
+        }
+        func = iter->second;
+    }
+    return func(value);
+}
+
+void DataSize::stc_register(std::type_index type, ErasedFunc func)
+{
+    SizeRegistry& registry = size_registry();
+    std::lock_guard<std::mutex> lock(registry.m_mutex);
+    registry.m_funcs[type] = std::move(func);
+}
+
+} // namespace tg::core
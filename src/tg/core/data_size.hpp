@@ -0,0 +1,47 @@
+#pragma once
+#include "tg/core/fwd.hpp"
+
+namespace tg::core
+{
+
+/**
+ * @brief A registry of functions that report the memory held by a value
+ * of a given type, used to predict the memory of a run (see
+ * ```Executor::set_memory_budget()```).
+ *
+ * @details The core does not know the data types of the Steps; each
+ * library registers its own, e.g. ```tg::opencv::register_data_sizes()```
+ * for ```cv::Mat```. Values of unregistered types count as zero bytes.
+ *
+ * @note Thread-safe.
+ */
+class DataSize
+{
+public:
+    /**
+     * @brief Registers (or replaces) the size function of type T.
+     */
+    template <typename T>
+    static void register_type(std::function<size_t(const T&)> func)
+    {
+        if (!func)
+        {
+            throw std::invalid_argument("DataSize::register_type(): function cannot be empty.");
+        }
+        stc_register(std::type_index(typeid(T)), [func](const VarData& value) -> size_t {
+            return func(value.as<T>());
+        });
+    }
+
+    /**
+     * @brief The bytes held by the value, or zero if it is empty or of an
+     * unregistered type.
+     */
+    static size_t bytes_of(const VarData& value);
+
+private:
+    using ErasedFunc = std::function<size_t(const VarData&)>;
+    static void stc_register(std::type_index type, ErasedFunc func);
+};
+
+} // namespace tg::core
@@ -0,0 +1,139 @@
+#include "tg/core/details/binding_resolver.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/scope_step.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/data/specialized/equiv_set.hpp"
+
+namespace tg::core::details
+{
+
+using EquivSet = tg::data::specialized::EquivSet;
+
+BindingResolver::BindingResolver(const Scope& scope)
+    : m_bindings{}
+    , m_aliases{}
+{
+    if (!scope.is_frozen())
+    {
+        throw std::invalid_argument("BindingResolver::BindingResolver(): Scope must be frozen.");
+    }
+    std::vector<std::pair<std::string, std::string>> wires = scope.wires();
+    for (const auto& step : scope.get_steps())
+    {
+        auto scope_step = std::dynamic_pointer_cast<ScopeStep>(step);
+        if (scope_step && scope_step->mode() == ScopeStepMode::Inline)
+        {
+            this->detail_inline(*scope_step, wires);
+            continue;
+        }
+        StepBinding& binding = m_bindings.emplace_back();
+        binding.m_step = step;
+        step->info().get_data_infos(binding.m_data_infos);
+    }
+    this->detail_unify(wires);
+}
+
+BindingResolver::~BindingResolver()
+{
+}
+
+const std::vector<StepBinding>& BindingResolver::bindings() const
+{
+    return m_bindings;
+}
+
+const std::vector<std::pair<std::string, std::string>>& BindingResolver::aliases() const
+{
+    return m_aliases;
+}
+
+void BindingResolver::detail_inline(ScopeStep& scope_step, std::vector<std::pair<std::string, std::string>>& wires)
+{
+    const Plan& inner = scope_step.inner_plan();
+    for (size_t inner_index = 0u; inner_index < inner.step_count(); ++inner_index)
+    {
+        if (!inner.is_step_alive(inner_index))
+        {
+            continue;
+        }
+        const PlanStep& inner_step = inner.step_at(inner_index);
+        StepBinding& binding = m_bindings.emplace_back();
+        binding.m_step = inner_step.m_step;
+        binding.m_step->info().get_data_infos(binding.m_data_infos);
+        for (size_t k = 0u; k < binding.m_data_infos.size(); ++k)
+        {
+            binding.m_data_infos.at(k).m_shortname = scope_step.private_name(inner_step.m_slots.at(k));
+        }
+    }
+    // Bound inner slots are receptacles wired onto the parent data.
+    for (size_t slot_index = 0u; slot_index < inner.slot_count(); ++slot_index)
+    {
+        if (scope_step.is_bound(slot_index))
+        {
+            wires.emplace_back(scope_step.outer_name(slot_index), scope_step.private_name(slot_index));
+        }
+    }
+}
+
+void BindingResolver::detail_unify(const std::vector<std::pair<std::string, std::string>>& wires)
+{
+    /**
+     * @note Wired names are numbered first, so that the root of each class
+     * (its smallest member) is its first wired name, if any, otherwise the
+     * name itself.
+     */
+    std::unordered_map<std::string, size_t> name_ids;
+    std::vector<std::string> names;
+    auto id_of = [&](const std::string& name) -> size_t {
+        auto [iter, inserted] = name_ids.emplace(name, names.size());
+        if (inserted)
+        {
+            names.push_back(name);
+        }
+        return iter->second;
+    };
+    EquivSet equiv_set;
+    for (const auto& [lhs, rhs] : wires)
+    {
+        const size_t lhs_id = id_of(lhs);
+        const size_t rhs_id = id_of(rhs);
+        equiv_set.link(lhs_id, rhs_id);
+    }
+    for (const auto& binding : m_bindings)
+    {
+        for (const auto& data_info : binding.m_data_infos)
+        {
+            equiv_set.insert(id_of(data_info.m_shortname));
+        }
+    }
+    std::vector<size_t> roots;
+    std::vector<std::pair<size_t, size_t>> members;
+    equiv_set.export_sorted(roots, members);
+    std::vector<size_t> root_of(names.size());
+    for (const auto& [root, member] : members)
+    {
+        root_of.at(member) = root;
+    }
+    std::vector<bool> root_used(names.size(), false);
+    for (auto& binding : m_bindings)
+    {
+        for (auto& data_info : binding.m_data_infos)
+        {
+            const size_t root = root_of.at(name_ids.at(data_info.m_shortname));
+            root_used.at(root) = true;
+            data_info.m_shortname = names.at(root);
+        }
+    }
+    // Wire-only classes (no Step uses any of their names) are dropped.
+    for (const auto& [root, member] : members)
+    {
+        if (root_used.at(root))
+        {
+            m_aliases.emplace_back(names.at(member), names.at(root));
+        }
+    }
+}
+
+} // namespace tg::core::details
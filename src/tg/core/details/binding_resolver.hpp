@@ -0,0 +1,67 @@
+#pragma once
+#include "tg/core/fwd.hpp"
+#include "tg/core/data_info_tuple.hpp"
+
+namespace tg::core::details
+{
+
+/**
+ * @brief The data items of one Step, with their names resolved.
+ */
+struct StepBinding
+{
+public:
+    StepPtr m_step;
+    std::vector<DataInfoTuple> m_data_infos;
+};
+
+/**
+ * @brief Resolves the data names of a frozen Scope into equivalence classes,
+ * as the first phase of compiling it.
+ *
+ * @details Inline ScopeSteps are flattened into their inner Steps, bound
+ * under private names and wired onto the parent data. All names connected
+ * by wires, directly or transitively, are unified with EquivSet.
+ *
+ * On return, the short name of each data item is replaced by the
+ * representative name of its class: its first wired name, if any,
+ * otherwise the name itself. Classes without any data item (wire-only
+ * names) are dropped.
+ *
+ * @note No further check is made; multiple writers or type mismatches are
+ * left to the caller.
+ */
+class BindingResolver
+{
+public:
+    explicit BindingResolver(const Scope& scope);
+    ~BindingResolver();
+
+public:
+    /**
+     * @brief The Steps in binding order, with resolved data names.
+     */
+    const std::vector<StepBinding>& bindings() const;
+
+    /**
+     * @brief Pairs of (name, representative name), for every name of every
+     * class used by the bindings, including the representative itself.
+     */
+    const std::vector<std::pair<std::string, std::string>>& aliases() const;
+
+private:
+    void detail_inline(ScopeStep& scope_step, std::vector<std::pair<std::string, std::string>>& wires);
+    void detail_unify(const std::vector<std::pair<std::string, std::string>>& wires);
+
+private:
+    BindingResolver(const BindingResolver&) = delete;
+    BindingResolver(BindingResolver&&) = delete;
+    BindingResolver& operator=(const BindingResolver&) = delete;
+    BindingResolver& operator=(BindingResolver&&) = delete;
+
+private:
+    std::vector<StepBinding> m_bindings;
+    std::vector<std::pair<std::string, std::string>> m_aliases;
+};
+
+} // namespace tg::core::details
@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <limits>
+#if defined(LINUX)
+#include <time.h>
+#endif
+#include "tg/core/details/fair_scheduler.hpp"
+
+namespace tg::core::details
+{
+
+namespace //(unnamed)
+{
+
+/**
+ * @brief The CPU time of the calling thread, where available; otherwise
+ * wall time, which also counts the time the thread was preempted.
+ */
+std::chrono::nanoseconds thread_cpu_time()
+{
+#if defined(LINUX)
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+#endif
+}
+
+} // namespace(unnamed)
+
+FairScheduler::FairScheduler()
+    : m_mutex{}
+    , m_tenants{}
+    , m_tenant_by_name{}
+    , m_virtual_clock{0.0}
+{
+}
+
+FairScheduler::~FairScheduler()
+{
+}
+
+size_t FairScheduler::tenant_index(const std::string& tenant)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto iter = m_tenant_by_name.find(tenant);
+    if (iter != m_tenant_by_name.end())
+    {
+        return iter->second;
+    }
+    auto p_tenant = std::make_unique<Tenant>();
+    p_tenant->m_name = tenant;
+    p_tenant->m_weight = 1.0;
+    p_tenant->m_virtual_time = m_virtual_clock;
+    p_tenant->m_average_cost = 0.0;
+    p_tenant->m_cpu_time = std::chrono::nanoseconds(0);
+    p_tenant->m_task_count = 0u;
+    p_tenant->m_queued_count = 0u;
+    m_tenants.push_back(std::move(p_tenant));
+    m_tenant_by_name.emplace(tenant, m_tenants.size() - 1u);
+    return m_tenants.size() - 1u;
+}
+
+void FairScheduler::set_weight(const std::string& tenant, double weight)
+{
+    if (!(weight > 0.0))
+    {
+        throw std::invalid_argument("FairScheduler::set_weight(): weight must be positive.");
+    }
+    const size_t index = this->tenant_index(tenant);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tenants.at(index)->m_weight = weight;
+}
+
+void FairScheduler::push(size_t tenant_index, Task task, TaskPriority priority)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Tenant& tenant = *m_tenants.at(tenant_index);
+    if (tenant.m_queued_count == 0u)
+    {
+        tenant.m_virtual_time = std::max(tenant.m_virtual_time, m_virtual_clock);
+    }
+    tenant.m_queues.at(static_cast<size_t>(priority)).push_back(std::move(task));
+    ++tenant.m_queued_count;
+}
+
+bool FairScheduler::run_next(TaskPriority priority)
+{
+    const size_t lane = static_cast<size_t>(priority);
+    Tenant* p_tenant = nullptr;
+    Task task;
+    double charged = 0.0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        double best = std::numeric_limits<double>::infinity();
+        for (const auto& p_candidate : m_tenants)
+        {
+            if (!p_candidate->m_queues.at(lane).empty() && p_candidate->m_virtual_time < best)
+            {
+                best = p_candidate->m_virtual_time;
+                p_tenant = p_candidate.get();
+            }
+        }
+        if (!p_tenant)
+        {
+            return false;
+        }
+        auto& queue = p_tenant->m_queues.at(lane);
+        task = std::move(queue.front());
+        queue.pop_front();
+        --p_tenant->m_queued_count;
+        m_virtual_clock = std::max(m_virtual_clock, p_tenant->m_virtual_time);
+        charged = p_tenant->m_average_cost;
+        p_tenant->m_virtual_time += charged / p_tenant->m_weight;
+    }
+    const auto start = thread_cpu_time();
+    task();
+    const auto elapsed = thread_cpu_time() - start;
+    const double cost = static_cast<double>(elapsed.count());
+    std::lock_guard<std::mutex> lock(m_mutex);
+    p_tenant->m_virtual_time += (cost - charged) / p_tenant->m_weight;
+    p_tenant->m_average_cost = (p_tenant->m_task_count == 0u) ? cost : (p_tenant->m_average_cost * 3.0 + cost) / 4.0;
+    p_tenant->m_cpu_time += elapsed;
+    ++p_tenant->m_task_count;
+    return true;
+}
+
+std::vector<TenantStats> FairScheduler::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<TenantStats> result;
+    result.reserve(m_tenants.size());
+    for (const auto& p_tenant : m_tenants)
+    {
+        result.push_back(TenantStats{p_tenant->m_name, p_tenant->m_weight, p_tenant->m_cpu_time, p_tenant->m_task_count});
+    }
+    return result;
+}
+
+} // namespace tg::core::details
@@ -0,0 +1,97 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <deque>
+#include "tg/core/fwd.hpp"
+#include "tg/core/executor.hpp"
+
+namespace tg::core::details
+{
+
+/**
+ * @brief Weighted fair queuing of pool tasks across tenants.
+ *
+ * @details Each tenant has its own queue (per lane of the pool) and a
+ * virtual time, which advances by the CPU time of its tasks divided by its
+ * weight. The owner pushes a task with ```push()```, and submits one
+ * token to the pool for it; the token calls ```run_next()```, which runs
+ * the queued task of the tenant with the smallest virtual time, not
+ * necessarily the one pushed with it. A tenant with a huge fan-out thus
+ * fills its own queue, while the workers keep serving the others in
+ * proportion to their weights.
+ *
+ * A task is charged its tenant's average cost when it is picked, and the
+ * difference when it finishes, so that concurrent picks see each other. A
+ * tenant that becomes backlogged starts at the current virtual time, so
+ * idling earns it no credit (start-time fair queuing).
+ */
+class FairScheduler
+{
+public:
+    using Task = std::function<void()>;
+
+public:
+    FairScheduler();
+    ~FairScheduler();
+
+public:
+    /**
+     * @brief Returns the index of the tenant, adding it with weight one if
+     * new.
+     */
+    size_t tenant_index(const std::string& tenant);
+
+    /**
+     * @exception std::invalid_argument if the weight is not positive.
+     */
+    void set_weight(const std::string& tenant, double weight);
+
+    /**
+     * @brief Queues a task of the tenant; the caller then submits one token
+     * to the given lane of the pool.
+     */
+    void push(size_t tenant_index, Task task, TaskPriority priority);
+
+    /**
+     * @brief Runs the fairest queued task in the given lane.
+     * @returns False if there was none.
+     */
+    bool run_next(TaskPriority priority);
+
+    std::vector<TenantStats> stats() const;
+
+private:
+    struct Tenant
+    {
+        std::string m_name;
+        double m_weight;
+
+        /**
+         * @brief Weighted CPU time received, in nanoseconds.
+         */
+        double m_virtual_time;
+        double m_average_cost;
+        std::chrono::nanoseconds m_cpu_time;
+        size_t m_task_count;
+        size_t m_queued_count;
+        std::array<std::deque<Task>, 2u> m_queues;
+    };
+
+private:
+    FairScheduler(const FairScheduler&) = delete;
+    FairScheduler(FairScheduler&&) = delete;
+    FairScheduler& operator=(const FairScheduler&) = delete;
+    FairScheduler& operator=(FairScheduler&&) = delete;
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<Tenant>> m_tenants;
+    std::unordered_map<std::string, size_t> m_tenant_by_name;
+
+    /**
+     * @brief The virtual time of the last picked task.
+     */
+    double m_virtual_clock;
+};
+
+} // namespace tg::core::details
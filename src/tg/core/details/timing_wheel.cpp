@@ -0,0 +1,168 @@
+#include <algorithm>
+#include "tg/core/details/timing_wheel.hpp"
+#include "tg/core/run_control.hpp"
+
+namespace tg::core::details
+{
+
+TimingWheel::TimingWheel()
+    : m_origin{Clock::now()}
+    , m_mutex{}
+    , m_cv{}
+    , m_slots(slot_count)
+    , m_cursor{0u}
+    , m_entry_count{0u}
+    , m_stop{false}
+    , m_thread{}
+{
+}
+
+TimingWheel::~TimingWheel()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+void TimingWheel::schedule(const RunControlPtr& control)
+{
+    if (!control || !control->deadline().has_value())
+    {
+        return;
+    }
+    Entry entry{0u, control, nullptr};
+    if (!this->detail_insert(control->deadline().value(), entry))
+    {
+        control->expire();
+    }
+}
+
+void TimingWheel::schedule_at(Clock::time_point time, Callback callback)
+{
+    if (!callback)
+    {
+        throw std::invalid_argument("TimingWheel::schedule_at(): callback cannot be empty.");
+    }
+    Entry entry{0u, {}, std::move(callback)};
+    if (!this->detail_insert(time, entry))
+    {
+        entry.m_callback();
+    }
+}
+
+size_t TimingWheel::entry_count() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entry_count;
+}
+
+bool TimingWheel::detail_insert(Clock::time_point time, Entry& entry)
+{
+    const size_t deadline_tick = this->detail_tick_of(time);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_entry_count == 0u)
+    {
+        // The timer skipped the ticks while the wheel was empty.
+        m_cursor = std::max(m_cursor, this->detail_tick_of(Clock::now()));
+    }
+    if (deadline_tick < m_cursor)
+    {
+        return false; // already due
+    }
+    entry.m_turns = (deadline_tick - m_cursor) / slot_count;
+    m_slots.at(deadline_tick % slot_count).push_back(std::move(entry));
+    ++m_entry_count;
+    if (!m_thread.joinable())
+    {
+        m_thread = std::thread([this]() { this->detail_timer_loop(); });
+    }
+    m_cv.notify_all();
+    return true;
+}
+
+void TimingWheel::detail_timer_loop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    std::vector<Entry> due;
+    while (!m_stop)
+    {
+        if (m_entry_count == 0u)
+        {
+            m_cv.wait(lock, [this]() { return m_stop || m_entry_count > 0u; });
+            continue;
+        }
+        // Process each tick that has fully elapsed.
+        const size_t now_tick = this->detail_tick_of(Clock::now());
+        while (m_cursor < now_tick && m_entry_count > 0u)
+        {
+            auto& slot = m_slots.at(m_cursor % slot_count);
+            auto keep = slot.begin();
+            for (auto& entry : slot)
+            {
+                const bool is_control = !entry.m_callback;
+                RunControlPtr control = is_control ? entry.m_control.lock() : nullptr;
+                if (is_control && (!control || control->status() != RunStatus::Active))
+                {
+                    --m_entry_count; // run over; dropped lazily
+                }
+                else if (entry.m_turns == 0u)
+                {
+                    due.push_back(std::move(entry));
+                    --m_entry_count;
+                }
+                else
+                {
+                    --entry.m_turns;
+                    if (&*keep != &entry)
+                    {
+                        *keep = std::move(entry);
+                    }
+                    ++keep;
+                }
+            }
+            slot.erase(keep, slot.end());
+            ++m_cursor;
+        }
+        if (m_entry_count == 0u)
+        {
+            m_cursor = std::max(m_cursor, now_tick);
+        }
+        if (!due.empty())
+        {
+            lock.unlock();
+            for (auto& entry : due)
+            {
+                if (entry.m_callback)
+                {
+                    entry.m_callback();
+                }
+                else if (RunControlPtr control = entry.m_control.lock())
+                {
+                    control->expire();
+                }
+            }
+            due.clear();
+            lock.lock();
+            continue; // time has passed meanwhile
+        }
+        const auto next_tick_end = m_origin + tick * static_cast<Clock::rep>(m_cursor + 1u);
+        m_cv.wait_until(lock, next_tick_end);
+    }
+}
+
+size_t TimingWheel::detail_tick_of(Clock::time_point time) const
+{
+    if (time <= m_origin)
+    {
+        return 0u;
+    }
+    return static_cast<size_t>(std::chrono::duration_cast<std::chrono::milliseconds>(time - m_origin) / tick);
+}
+
+} // namespace tg::core::details
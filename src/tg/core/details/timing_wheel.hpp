@@ -0,0 +1,105 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+#include "tg/core/fwd.hpp"
+
+namespace tg::core::details
+{
+
+/**
+ * @brief A hashed timing wheel that expires the RunControls of runs past
+ * their deadlines, and fires the other timers of an Executor (e.g. closing
+ * a batch).
+ *
+ * @details The wheel has ```slot_count``` slots of one ```tick``` each. A
+ * deadline goes into the slot of its tick, modulo the wheel size, with the
+ * number of full turns left; scheduling is O(1) regardless of how many
+ * runs are pending. A timer thread advances one slot per tick, expiring
+ * the entries with no turns left and counting down the others. Entries of
+ * finished runs are dropped lazily (they hold weak pointers).
+ *
+ * Due entries are expired or called outside the lock of the wheel, so
+ * that they may schedule again.
+ *
+ * The thread is started by the first ```schedule()```, and sleeps while
+ * the wheel is empty.
+ */
+class TimingWheel
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+    static constexpr size_t slot_count = 256u;
+    static constexpr std::chrono::milliseconds tick{1};
+
+public:
+    TimingWheel();
+
+    /**
+     * @brief Stops and joins the timer thread; pending entries are dropped.
+     */
+    ~TimingWheel();
+
+public:
+    /**
+     * @brief Arranges for ```control->expire()``` at its deadline; expires
+     * it at once if the deadline has passed.
+     */
+    void schedule(const RunControlPtr& control);
+
+    /**
+     * @brief Calls the callback on the timer thread once the time has
+     * passed; calls it at once if the time has passed already.
+     * @note The callback should only hand the work over (e.g. submit a
+     * task); it delays the other due entries.
+     */
+    void schedule_at(Clock::time_point time, Callback callback);
+
+    /**
+     * @brief The number of entries still in the wheel.
+     */
+    size_t entry_count() const;
+
+private:
+    /**
+     * @brief Either expires a control, or calls a callback.
+     */
+    struct Entry
+    {
+        size_t m_turns;
+        RunControlWPtr m_control;
+        Callback m_callback;
+    };
+
+private:
+    /**
+     * @brief Moves the entry into the slot of its time.
+     * @returns False, leaving the entry as is, if the time has passed.
+     */
+    bool detail_insert(Clock::time_point time, Entry& entry);
+    void detail_timer_loop();
+    size_t detail_tick_of(Clock::time_point time) const;
+
+private:
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel(TimingWheel&&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+    TimingWheel& operator=(TimingWheel&&) = delete;
+
+private:
+    const Clock::time_point m_origin;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<std::vector<Entry>> m_slots;
+
+    /**
+     * @brief The next tick to process; all earlier ticks are done.
+     */
+    size_t m_cursor;
+    size_t m_entry_count;
+    bool m_stop;
+    std::thread m_thread;
+};
+
+} // namespace tg::core::details
@@ -0,0 +1,1301 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <thread>
+#include "tg/core/executor.hpp"
+#include "tg/core/buffer_pool.hpp"
+#include "tg/core/data_size.hpp"
+#include "tg/core/memory_budget.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/resource_manager.hpp"
+#include "tg/core/roi_demand.hpp"
+#include "tg/core/run_control.hpp"
+#include "tg/core/shape_inference.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/thread_pool.hpp"
+#include "tg/core/details/fair_scheduler.hpp"
+#include "tg/core/details/timing_wheel.hpp"
+
+namespace tg::core
+{
+
+namespace //(unnamed)
+{
+
+/**
+ * @brief The number of Steps executing on this thread, nested in each other.
+ */
+thread_local size_t tls_step_depth = 0u;
+
+/**
+ * @brief The ResourceManager and BufferPool of the run whose Step is
+ * executing on this thread, if any.
+ */
+thread_local ResourceManager* tls_current_resources = nullptr;
+thread_local BufferPool* tls_current_buffers = nullptr;
+
+/**
+ * @brief Marks the calling thread as executing a Step of a run while in
+ * scope: runs nested in the Step are not admitted against the memory
+ * budget a second time, and share the ResourceManager and BufferPool of
+ * the run unless their Executor has its own.
+ */
+struct StepDepthScope
+{
+    StepDepthScope(ResourceManager* p_resources, BufferPool* p_buffers)
+        : m_p_previous_resources{tls_current_resources}
+        , m_p_previous_buffers{tls_current_buffers}
+    {
+        ++tls_step_depth;
+        tls_current_resources = p_resources;
+        tls_current_buffers = p_buffers;
+    }
+    ~StepDepthScope()
+    {
+        --tls_step_depth;
+        tls_current_resources = m_p_previous_resources;
+        tls_current_buffers = m_p_previous_buffers;
+    }
+    ResourceManager* m_p_previous_resources;
+    BufferPool* m_p_previous_buffers;
+};
+
+/**
+ * @brief Returns admitted bytes to the budget when leaving the scope.
+ */
+struct BudgetLease
+{
+    MemoryBudget* m_p_budget;
+    size_t m_bytes;
+    ~BudgetLease()
+    {
+        if (m_p_budget)
+        {
+            m_p_budget->release(m_bytes);
+        }
+    }
+};
+
+} // namespace(unnamed)
+
+/**
+ * @brief The shared state of one parallel run; owned jointly by the caller
+ * and the tasks in flight.
+ */
+struct Executor::RunState
+{
+    const Plan* m_p_plan;
+    std::vector<VarData>* m_p_slots;
+    RunArgs m_args;
+    ThreadPool* m_p_pool;
+    TaskPriority m_priority;
+
+    /**
+     * @brief The fair scheduler and the tenant of the run, if fair.
+     */
+    std::shared_ptr<details::FairScheduler> m_sp_fair;
+    size_t m_tenant_index;
+    std::chrono::nanoseconds m_coarsening_threshold;
+    BatchPolicy m_batch_policy;
+
+    /**
+     * @note Shared with the timers that close its batches, which may fire
+     * after the runs in the batch have returned.
+     */
+    std::shared_ptr<Batcher> m_sp_batcher;
+    details::TimingWheel* m_p_wheel;
+    std::unique_ptr<std::atomic<size_t>[]> m_pending;
+
+    /**
+     * @brief The resources held by each Step, if there is a ResourceManager.
+     */
+    std::unique_ptr<ResourceDemand[]> m_held;
+    std::atomic<size_t> m_remaining;
+    std::atomic<bool> m_failed;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::exception_ptr m_error;
+
+    /**
+     * @brief For an asynchronous run: called by the task that completes the
+     * last Step, in place of waking the caller; the control and inferred
+     * shapes are owned by the run.
+     */
+    Completion m_on_complete;
+    RunControlPtr m_sp_control;
+    std::optional<ShapeInference> m_shapes;
+
+    /**
+     * @brief The callback that aborts the run when its control stops, or
+     * zero.
+     */
+    size_t m_stop_callback_id;
+};
+
+/**
+ * @brief A Step split into chunks (see ```Step::begin_chunks()```), shared
+ * by the tasks running its chunks; the last one to finish completes it.
+ */
+struct Executor::ChunkRun
+{
+    size_t m_step_index;
+    Step* m_p_step;
+    std::vector<VarData> m_data;
+    std::atomic<size_t> m_remaining;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+/**
+ * @brief The instances of one Step collected from different runs.
+ */
+struct Executor::Batch
+{
+    struct Entry
+    {
+        std::shared_ptr<RunState> m_state;
+        size_t m_step_index;
+        std::vector<VarData> m_data;
+    };
+    std::vector<Entry> m_entries;
+};
+
+/**
+ * @brief The open batch of each batchable Step, shared by all runs of the
+ * Executor.
+ */
+struct Executor::Batcher
+{
+    std::mutex m_mutex;
+    std::unordered_map<Step*, std::shared_ptr<Batch>> m_open;
+};
+
+Executor::Executor()
+    : Executor{nullptr}
+{
+}
+
+Executor::Executor(ThreadPoolPtr pool)
+    : m_sp_pool{std::move(pool)}
+    , m_priority{TaskPriority::Latency}
+    , m_fair_scheduling{false}
+    , m_sp_fair{std::make_shared<details::FairScheduler>()}
+    , m_sp_resources{}
+    , m_sp_memory{}
+    , m_peak_predictor{}
+    , m_sp_buffers{}
+    , m_output_reuse{false}
+    , m_coarsening_threshold{default_coarsening_threshold}
+    , m_batch_policy{1u, std::chrono::microseconds(0)}
+    , m_sp_batcher{std::make_shared<Batcher>()}
+    , m_sp_wheel{std::make_shared<details::TimingWheel>()}
+{
+}
+
+Executor::~Executor()
+{
+}
+
+const ThreadPoolPtr& Executor::pool() const
+{
+    return m_sp_pool;
+}
+
+void Executor::set_priority(TaskPriority priority)
+{
+    m_priority = priority;
+}
+
+TaskPriority Executor::priority() const
+{
+    return m_priority;
+}
+
+void Executor::set_fair_scheduling(bool enabled)
+{
+    m_fair_scheduling = enabled;
+}
+
+bool Executor::fair_scheduling() const
+{
+    return m_fair_scheduling;
+}
+
+void Executor::set_tenant_weight(const std::string& tenant, double weight)
+{
+    m_sp_fair->set_weight(tenant, weight);
+}
+
+std::vector<TenantStats> Executor::tenant_stats() const
+{
+    return m_sp_fair->stats();
+}
+
+void Executor::set_resource_manager(ResourceManagerPtr resources)
+{
+    m_sp_resources = std::move(resources);
+}
+
+const ResourceManagerPtr& Executor::resource_manager() const
+{
+    return m_sp_resources;
+}
+
+void Executor::set_memory_budget(MemoryBudgetPtr budget, PeakPredictor predictor)
+{
+    m_sp_memory = std::move(budget);
+    m_peak_predictor = std::move(predictor);
+}
+
+const MemoryBudgetPtr& Executor::memory_budget() const
+{
+    return m_sp_memory;
+}
+
+size_t Executor::predict_peak(const Plan& plan, const std::vector<VarData>& slots) const
+{
+    if (m_peak_predictor)
+    {
+        return m_peak_predictor(plan, slots);
+    }
+    return stc_default_peak(plan, slots);
+}
+
+size_t Executor::stc_default_peak(const Plan& plan, const std::vector<VarData>& slots)
+{
+    ShapeInference inference(plan);
+    inference.set_inputs(slots);
+    inference.propagate();
+    size_t input_bytes = 0u;
+    // A slot whose extent depends on the data (not exact) is as unknown as
+    // one that cannot be described; counting it as zero would under-admit.
+    for (size_t slot_index : plan.global_inputs())
+    {
+        const auto& meta = inference.slot_meta(slot_index);
+        input_bytes += (meta.has_value() && meta->is_exact()) ? meta->bytes() : DataSize::bytes_of(slots.at(slot_index));
+    }
+    size_t peak = input_bytes;
+    for (size_t slot_index = 0u; slot_index < plan.slot_count(); ++slot_index)
+    {
+        if (!plan.slot_at(slot_index).m_writer.has_value())
+        {
+            continue; // a global input, or a released slot
+        }
+        const auto& meta = inference.slot_meta(slot_index);
+        peak += (meta.has_value() && meta->is_exact()) ? meta->bytes() : input_bytes;
+    }
+    return peak;
+}
+
+void Executor::set_buffer_pool(BufferPoolPtr buffers)
+{
+    m_sp_buffers = std::move(buffers);
+}
+
+const BufferPoolPtr& Executor::buffer_pool() const
+{
+    return m_sp_buffers;
+}
+
+void Executor::set_output_reuse(bool enabled)
+{
+    m_output_reuse = enabled;
+}
+
+bool Executor::output_reuse() const
+{
+    return m_output_reuse;
+}
+
+void Executor::set_coarsening_threshold(std::chrono::nanoseconds threshold)
+{
+    m_coarsening_threshold = threshold;
+}
+
+std::chrono::nanoseconds Executor::coarsening_threshold() const
+{
+    return m_coarsening_threshold;
+}
+
+void Executor::set_batch_policy(const BatchPolicy& policy)
+{
+    if (policy.m_max_batch_size == 0u)
+    {
+        throw std::invalid_argument("Executor::set_batch_policy(): maximum batch size cannot be zero.");
+    }
+    m_batch_policy = policy;
+}
+
+const BatchPolicy& Executor::batch_policy() const
+{
+    return m_batch_policy;
+}
+
+void Executor::run(const Plan& plan, std::vector<VarData>& slots) const
+{
+    this->detail_run(plan, slots, RunArgs{nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr});
+}
+
+void Executor::run(const Plan& plan, std::vector<VarData>& slots, const RoiDemand& demand) const
+{
+    this->detail_run(plan, slots, RunArgs{&demand, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr});
+}
+
+void Executor::run(const Plan& plan, std::vector<VarData>& slots, const StepTable& steps) const
+{
+    if (steps.size() != plan.step_count())
+    {
+        throw std::invalid_argument("Executor::run(): step table size does not match Plan step count.");
+    }
+    this->detail_run(plan, slots, RunArgs{nullptr, &steps, nullptr, nullptr, nullptr, nullptr, nullptr});
+}
+
+void Executor::run(const Plan& plan, std::vector<VarData>& slots, const RunControlPtr& control) const
+{
+    if (!control)
+    {
+        throw std::invalid_argument("Executor::run(): control cannot be null.");
+    }
+    if (control->deadline().has_value())
+    {
+        m_sp_wheel->schedule(control);
+    }
+    RunControl::FinishScope finish_scope(*control);
+    this->detail_run(plan, slots, RunArgs{nullptr, nullptr, control.get(), nullptr, nullptr, nullptr, nullptr});
+}
+
+void Executor::run_async(const Plan& plan, std::vector<VarData>& slots, RunControlPtr control, Completion on_complete) const
+{
+    if (!m_sp_pool)
+    {
+        throw std::logic_error("Executor::run_async(): a sequential Executor cannot run asynchronously.");
+    }
+    if (!on_complete)
+    {
+        throw std::invalid_argument("Executor::run_async(): completion cannot be empty.");
+    }
+    if (control && control->deadline().has_value())
+    {
+        m_sp_wheel->schedule(control);
+    }
+    std::shared_ptr<RunState> state;
+    try
+    {
+        const RunArgs args{nullptr, nullptr, control.get(), m_sp_resources.get(), nullptr, nullptr, nullptr};
+        this->detail_validate(plan, slots, args);
+        state = this->detail_make_state(plan, slots, args);
+        if (m_sp_buffers)
+        {
+            state->m_shapes.emplace(plan);
+            state->m_shapes->set_inputs(slots);
+            state->m_shapes->propagate();
+            state->m_args.m_p_shapes = &state->m_shapes.value();
+            state->m_args.m_p_buffers = m_sp_buffers.get();
+        }
+    }
+    catch (...)
+    {
+        if (control)
+        {
+            control->detail_finish();
+        }
+        on_complete(std::current_exception());
+        return;
+    }
+    state->m_on_complete = std::move(on_complete);
+    state->m_sp_control = std::move(control);
+    stc_start_run(state);
+}
+
+std::function<void(size_t)> Executor::inherit_context(std::function<void(size_t)> func)
+{
+    RunControl* p_control = RunControl::current();
+    ResourceManager* p_resources = tls_current_resources;
+    BufferPool* p_buffers = tls_current_buffers;
+    return [p_control, p_resources, p_buffers, func = std::move(func)](size_t index) {
+        RunControl::CurrentScope current_scope(p_control);
+        StepDepthScope depth_scope(p_resources, p_buffers);
+        func(index);
+    };
+}
+
+void Executor::detail_run(const Plan& plan, std::vector<VarData>& slots, const RunArgs& args) const
+{
+    RunArgs run_args = args;
+    if (!run_args.m_p_control)
+    {
+        // A run nested in a Step of a controlled run stops with it.
+        run_args.m_p_control = RunControl::current();
+    }
+    // A run nested in a Step shares the resources of the enclosing run.
+    run_args.m_p_resources = m_sp_resources ? m_sp_resources.get() : tls_current_resources;
+    BufferPool* p_buffers = m_sp_buffers ? m_sp_buffers.get() : tls_current_buffers;
+    this->detail_validate(plan, slots, run_args);
+    BudgetLease lease{nullptr, 0u};
+    if (m_sp_memory && tls_step_depth == 0u && !ThreadPool::current())
+    {
+        lease.m_bytes = this->predict_peak(plan, slots);
+        m_sp_memory->acquire(lease.m_bytes);
+        lease.m_p_budget = m_sp_memory.get();
+    }
+    std::optional<ShapeInference> shapes;
+    if (p_buffers && !run_args.m_p_demand)
+    {
+        shapes.emplace(plan);
+        shapes->set_inputs(slots);
+        shapes->propagate();
+        run_args.m_p_shapes = &shapes.value();
+        run_args.m_p_buffers = p_buffers;
+    }
+    std::vector<VarData> storage;
+    if (m_output_reuse)
+    {
+        // From here on, a written slot holds a value only once written by this run.
+        storage.resize(slots.size());
+        for (size_t slot_index = 0u; slot_index < slots.size(); ++slot_index)
+        {
+            VarData& slot = slots.at(slot_index);
+            if (!plan.slot_at(slot_index).m_writer.has_value())
+            {
+                continue;
+            }
+            if (BufferPool::is_reusable(slot))
+            {
+                storage.at(slot_index) = std::move(slot);
+            }
+            slot.clear();
+        }
+        run_args.m_p_storage = &storage;
+    }
+    try
+    {
+        if (m_sp_pool)
+        {
+            this->detail_run_parallel(plan, slots, run_args);
+        }
+        else
+        {
+            this->detail_run_sequential(plan, slots, run_args);
+        }
+    }
+    catch (const RunCancelled&)
+    {
+        // No Step of the run is executing any more; release its data.
+        for (auto& slot : slots)
+        {
+            slot.clear();
+        }
+        throw;
+    }
+}
+
+void Executor::detail_validate(const Plan& plan, std::vector<VarData>& slots, const RunArgs& args) const
+{
+    const RoiDemand* p_demand = args.m_p_demand;
+    if (slots.size() != plan.slot_count())
+    {
+        throw std::invalid_argument("Executor::run(): slot array size does not match Plan slot count.");
+    }
+    for (size_t slot_index : plan.global_inputs())
+    {
+        if (p_demand && p_demand->slot_demand(slot_index).is_empty())
+        {
+            continue; // not needed for the demanded regions
+        }
+        if (!slots.at(slot_index).has_value())
+        {
+            throw std::invalid_argument(
+                "Executor::run(): global input " + plan.slot_at(slot_index).m_name + " is not provided."
+            );
+        }
+    }
+}
+
+void Executor::detail_run_sequential(const Plan& plan, std::vector<VarData>& slots, const RunArgs& args) const
+{
+    RunControl* p_control = args.m_p_control;
+    RunControl::CurrentScope current_scope(p_control);
+    StepDepthScope depth_scope(args.m_p_resources, args.m_p_buffers);
+    for (size_t step_index : plan.topo_order())
+    {
+        if (p_control)
+        {
+            p_control->throw_if_stopped();
+        }
+        stc_execute_step(plan, step_index, slots, args);
+    }
+}
+
+void Executor::detail_run_parallel(const Plan& plan, std::vector<VarData>& slots, const RunArgs& args) const
+{
+    auto state = this->detail_make_state(plan, slots, args);
+    stc_start_run(state);
+    while (state->m_remaining.load() > 0u)
+    {
+        if (m_sp_pool->try_run_one())
+        {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(state->m_mutex);
+        state->m_cv.wait_for(lock, std::chrono::milliseconds(1), [&state]() {
+            return state->m_remaining.load() == 0u;
+        });
+    }
+    if (state->m_error)
+    {
+        std::rethrow_exception(state->m_error);
+    }
+}
+
+std::shared_ptr<Executor::RunState> Executor::detail_make_state(const Plan& plan, std::vector<VarData>& slots, const RunArgs& args) const
+{
+    const size_t step_count = plan.step_count();
+    auto state = std::make_shared<RunState>();
+    state->m_p_plan = &plan;
+    state->m_p_slots = &slots;
+    state->m_args = args;
+    state->m_p_pool = m_sp_pool.get();
+    // A run nested in a batch task stays in the batch lane.
+    state->m_priority = std::max(m_priority, ThreadPool::current_priority());
+    if (m_fair_scheduling)
+    {
+        state->m_sp_fair = m_sp_fair;
+        state->m_tenant_index = m_sp_fair->tenant_index(plan.scopename());
+    }
+    state->m_coarsening_threshold = m_coarsening_threshold;
+    state->m_batch_policy = m_batch_policy;
+    state->m_sp_batcher = m_sp_batcher;
+    state->m_p_wheel = m_sp_wheel.get();
+    state->m_pending = std::make_unique<std::atomic<size_t>[]>(step_count);
+    if (args.m_p_resources)
+    {
+        state->m_held = std::make_unique<ResourceDemand[]>(step_count);
+    }
+    state->m_remaining = plan.live_step_count();
+    state->m_failed = false;
+    state->m_stop_callback_id = 0u;
+    for (size_t step_index = 0u; step_index < step_count; ++step_index)
+    {
+        state->m_pending[step_index] = plan.exec_predecessor_count(step_index);
+    }
+    return state;
+}
+
+void Executor::stc_start_run(const std::shared_ptr<RunState>& state)
+{
+    const Plan& plan = *state->m_p_plan;
+    if (state->m_remaining.load() == 0u)
+    {
+        if (state->m_on_complete)
+        {
+            stc_finish_async(state);
+        }
+        return;
+    }
+    // Collected first: once the last root is submitted, the run may complete
+    // (and, if asynchronous, its Plan be released) before this returns.
+    std::vector<size_t> roots;
+    for (size_t step_index = 0u; step_index < plan.step_count(); ++step_index)
+    {
+        if (plan.is_step_alive(step_index) && plan.exec_predecessor_count(step_index) == 0u)
+        {
+            roots.push_back(step_index);
+        }
+    }
+    if (RunControl* p_control = state->m_args.m_p_control)
+    {
+        // Removed by the last Step, which waits for it if it is running.
+        state->m_stop_callback_id = p_control->detail_add_stop_callback([wp_state = std::weak_ptr<RunState>(state)]() {
+            if (auto state = wp_state.lock())
+            {
+                stc_abort_queued(state);
+            }
+        });
+    }
+    for (size_t step_index : roots)
+    {
+        stc_dispatch(state, step_index);
+    }
+}
+
+void Executor::stc_finish_async(const std::shared_ptr<RunState>& state)
+{
+    const std::exception_ptr error = state->m_error;
+    if (error)
+    {
+        try
+        {
+            std::rethrow_exception(error);
+        }
+        catch (const RunCancelled&)
+        {
+            // As for a synchronous run: a stopped run leaves no data behind.
+            for (auto& slot : *state->m_p_slots)
+            {
+                slot.clear();
+            }
+        }
+        catch (...)
+        {
+        }
+    }
+    if (state->m_sp_control)
+    {
+        state->m_sp_control->detail_finish();
+    }
+    Completion on_complete = std::move(state->m_on_complete);
+    on_complete(error);
+}
+
+void Executor::stc_submit(const std::shared_ptr<RunState>& state, std::function<void()> task)
+{
+    const TaskPriority priority = state->m_priority;
+    if (!state->m_sp_fair)
+    {
+        state->m_p_pool->submit(std::move(task), priority);
+        return;
+    }
+    // The token runs whichever queued task is fairest, in the same lane.
+    state->m_sp_fair->push(state->m_tenant_index, std::move(task), priority);
+    state->m_p_pool->submit([sp_fair = state->m_sp_fair, priority]() {
+        sp_fair->run_next(priority);
+    }, priority);
+}
+
+void Executor::stc_dispatch(const std::shared_ptr<RunState>& state, size_t step_index)
+{
+    stc_submit(state, [state, step_index]() {
+        stc_run_unit(state, step_index, false);
+    });
+}
+
+void Executor::stc_run_unit(const std::shared_ptr<RunState>& state, size_t step_index, bool executed)
+{
+    // The Steps of this scheduling unit that are ready to run.
+    std::vector<size_t> unit{step_index};
+    while (!unit.empty())
+    {
+        const size_t current = unit.back();
+        unit.pop_back();
+        if (!executed && !stc_start_step(state, current))
+        {
+            continue; // completed by the task that finishes its last chunk
+        }
+        executed = false;
+        stc_complete_step(state, current, unit);
+    }
+}
+
+bool Executor::stc_start_step(const std::shared_ptr<RunState>& state, size_t step_index)
+{
+    if (state->m_failed.load() || stc_check_stopped(state))
+    {
+        return true;
+    }
+    const Plan& plan = *state->m_p_plan;
+    const RunArgs& args = state->m_args;
+    if (args.m_p_demand)
+    {
+        try
+        {
+            RunControl::CurrentScope current_scope(args.m_p_control);
+            StepDepthScope depth_scope(args.m_p_resources, args.m_p_buffers);
+            const bool timing = state->m_coarsening_threshold.count() > 0;
+            const auto start = timing ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+            if (stc_execute_step(plan, step_index, *state->m_p_slots, args) && timing)
+            {
+                plan.record_cost(step_index, std::chrono::steady_clock::now() - start);
+            }
+        }
+        catch (...)
+        {
+            stc_record_error(state);
+        }
+        return true;
+    }
+    auto chunk_run = std::make_shared<ChunkRun>();
+    try
+    {
+        Step* p_step = stc_prepare_step(plan, step_index, *state->m_p_slots, args, chunk_run->m_data);
+        if (!p_step)
+        {
+            return true;
+        }
+        chunk_run->m_step_index = step_index;
+        chunk_run->m_p_step = p_step;
+        if (args.m_p_resources)
+        {
+            ResourceDemand demand = p_step->resource_demand(chunk_run->m_data);
+            if (!demand.is_empty())
+            {
+                // Held from admission until stc_complete_step().
+                state->m_held[step_index] = demand;
+                auto on_admitted = [state, chunk_run]() {
+                    stc_submit(state, [state, chunk_run]() {
+                        if (stc_launch_step(state, chunk_run))
+                        {
+                            stc_run_unit(state, chunk_run->m_step_index, true);
+                        }
+                    });
+                };
+                bool is_acquired = false;
+                try
+                {
+                    is_acquired = args.m_p_resources->acquire_or_wait(demand, std::move(on_admitted), state.get(), step_index);
+                }
+                catch (...)
+                {
+                    state->m_held[step_index] = ResourceDemand{0u, {}};
+                    throw;
+                }
+                if (!is_acquired)
+                {
+                    // Stopped while queuing: the stop callback may have missed it.
+                    if (stc_check_stopped(state))
+                    {
+                        stc_abort_queued(state);
+                    }
+                    return false; // launched once admitted
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        stc_record_error(state);
+        return true;
+    }
+    return stc_launch_step(state, chunk_run);
+}
+
+bool Executor::stc_launch_step(const std::shared_ptr<RunState>& state, const std::shared_ptr<ChunkRun>& chunk_run)
+{
+    if (state->m_failed.load() || stc_check_stopped(state))
+    {
+        return true; // e.g. while it was waiting for resources
+    }
+    const Plan& plan = *state->m_p_plan;
+    const size_t step_index = chunk_run->m_step_index;
+    Step* p_step = chunk_run->m_p_step;
+    const bool timing = state->m_coarsening_threshold.count() > 0;
+    try
+    {
+        RunControl::CurrentScope current_scope(state->m_args.m_p_control);
+        StepDepthScope depth_scope(state->m_args.m_p_resources, state->m_args.m_p_buffers);
+        const auto start = timing ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+        if (state->m_batch_policy.m_max_batch_size > 1u && p_step->is_batchable())
+        {
+            stc_enqueue_batch(state, step_index, p_step, std::move(chunk_run->m_data));
+            return false; // completed when its batch runs
+        }
+        const size_t chunk_count = p_step->begin_chunks(chunk_run->m_data);
+        if (chunk_count > 0u)
+        {
+            chunk_run->m_remaining = chunk_count;
+            chunk_run->m_start = start;
+            for (size_t chunk_index = 1u; chunk_index < chunk_count; ++chunk_index)
+            {
+                stc_submit(state, [state, chunk_run, chunk_index]() {
+                    if (stc_run_chunk(state, chunk_run, chunk_index))
+                    {
+                        stc_run_unit(state, chunk_run->m_step_index, true);
+                    }
+                });
+            }
+            // The first chunk runs here; whoever finishes last completes the Step.
+            return stc_run_chunk(state, chunk_run, 0u);
+        }
+        p_step->execute(chunk_run->m_data);
+        stc_scatter(plan.step_at(step_index), chunk_run->m_data, *state->m_p_slots);
+        if (timing)
+        {
+            plan.record_cost(step_index, std::chrono::steady_clock::now() - start);
+        }
+    }
+    catch (...)
+    {
+        stc_record_error(state);
+    }
+    return true;
+}
+
+bool Executor::stc_run_chunk(const std::shared_ptr<RunState>& state, const std::shared_ptr<ChunkRun>& chunk_run, size_t chunk_index)
+{
+    try
+    {
+        if (!state->m_failed.load() && !stc_check_stopped(state))
+        {
+            RunControl::CurrentScope current_scope(state->m_args.m_p_control);
+            StepDepthScope depth_scope(state->m_args.m_p_resources, state->m_args.m_p_buffers);
+            chunk_run->m_p_step->execute_chunk(chunk_run->m_data, chunk_index);
+        }
+    }
+    catch (...)
+    {
+        stc_record_error(state);
+    }
+    if (chunk_run->m_remaining.fetch_sub(1u) != 1u)
+    {
+        return false;
+    }
+    try
+    {
+        if (!state->m_failed.load())
+        {
+            const Plan& plan = *state->m_p_plan;
+            const size_t step_index = chunk_run->m_step_index;
+            chunk_run->m_p_step->end_chunks(chunk_run->m_data);
+            stc_scatter(plan.step_at(step_index), chunk_run->m_data, *state->m_p_slots);
+            if (state->m_coarsening_threshold.count() > 0)
+            {
+                plan.record_cost(step_index, std::chrono::steady_clock::now() - chunk_run->m_start);
+            }
+        }
+    }
+    catch (...)
+    {
+        stc_record_error(state);
+    }
+    return true;
+}
+
+void Executor::stc_complete_step(const std::shared_ptr<RunState>& state, size_t step_index, std::vector<size_t>& unit)
+{
+    const Plan& plan = *state->m_p_plan;
+    if (state->m_held && !state->m_held[step_index].is_empty())
+    {
+        ResourceDemand held = std::move(state->m_held[step_index]);
+        state->m_held[step_index] = ResourceDemand{0u, {}};
+        state->m_args.m_p_resources->release(held);
+    }
+    const auto threshold = state->m_coarsening_threshold;
+    const bool coarsening = threshold.count() > 0;
+    /**
+     * @note After a failure, the remaining Steps are still visited
+     * (without executing) so that the run can be accounted for; they are
+     * visited here rather than dispatched, so that a stopped run completes
+     * without waiting for the pool.
+     */
+    const bool is_failed = state->m_failed.load();
+    const size_t unit_size = unit.size();
+    for (size_t next : plan.exec_successors(step_index))
+    {
+        if (state->m_pending[next].fetch_sub(1u) == 1u)
+        {
+            const auto cost = coarsening ? plan.estimated_cost(next) : std::nullopt;
+            if (is_failed || (cost.has_value() && cost.value() < threshold))
+            {
+                unit.push_back(next);
+            }
+            else
+            {
+                stc_dispatch(state, next);
+            }
+        }
+    }
+    // Newly ready cheap Steps run in successor order.
+    std::reverse(unit.begin() + static_cast<std::ptrdiff_t>(unit_size), unit.end());
+    if (state->m_remaining.fetch_sub(1u) == 1u)
+    {
+        if (state->m_stop_callback_id != 0u)
+        {
+            state->m_args.m_p_control->detail_remove_stop_callback(state->m_stop_callback_id);
+        }
+        if (state->m_on_complete)
+        {
+            stc_finish_async(state);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(state->m_mutex);
+        state->m_cv.notify_all();
+    }
+}
+
+void Executor::stc_enqueue_batch(const std::shared_ptr<RunState>& state, size_t step_index, Step* p_step, std::vector<VarData> data)
+{
+    Batcher& batcher = *state->m_sp_batcher;
+    const BatchPolicy& policy = state->m_batch_policy;
+    std::shared_ptr<Batch> batch;
+    bool is_leader = false;
+    bool is_full = false;
+    {
+        std::lock_guard<std::mutex> lock(batcher.m_mutex);
+        auto& open = batcher.m_open[p_step];
+        if (!open)
+        {
+            open = std::make_shared<Batch>();
+            is_leader = true;
+        }
+        batch = open;
+        batch->m_entries.push_back(Batch::Entry{state, step_index, std::move(data)});
+        if (batch->m_entries.size() >= policy.m_max_batch_size)
+        {
+            batcher.m_open.erase(p_step);
+            is_full = true;
+        }
+    }
+    if (is_full)
+    {
+        stc_execute_batch(p_step, *batch);
+        return;
+    }
+    if (is_leader)
+    {
+        // No worker waits for the batch; the timer closes it unless it fills first.
+        state->m_p_wheel->schedule_at(
+            std::chrono::steady_clock::now() + policy.m_max_wait,
+            [sp_batcher = state->m_sp_batcher, p_step, wp_batch = std::weak_ptr<Batch>(batch)]() {
+                stc_close_batch(sp_batcher, p_step, wp_batch);
+            }
+        );
+    }
+    // Stopped while queuing: the stop callback may have missed it.
+    if (stc_check_stopped(state))
+    {
+        stc_abort_queued(state);
+    }
+}
+
+void Executor::stc_close_batch(const std::shared_ptr<Batcher>& sp_batcher, Step* p_step, const std::weak_ptr<Batch>& wp_batch)
+{
+    std::shared_ptr<Batch> batch = wp_batch.lock();
+    if (!batch)
+    {
+        return; // filled, and already run
+    }
+    {
+        std::lock_guard<std::mutex> lock(sp_batcher->m_mutex);
+        auto iter = sp_batcher->m_open.find(p_step);
+        if (iter == sp_batcher->m_open.end() || iter->second != batch)
+        {
+            return;
+        }
+        sp_batcher->m_open.erase(iter);
+    }
+    // Runs as a task of the first run in the batch, off the timer thread.
+    stc_submit(batch->m_entries.front().m_state, [p_step, batch]() {
+        stc_execute_batch(p_step, *batch);
+    });
+}
+
+void Executor::stc_execute_batch(Step* p_step, Batch& batch)
+{
+    // The runs in a batch are all of this Executor.
+    const RunArgs& args = batch.m_entries.front().m_state->m_args;
+    StepDepthScope depth_scope(args.m_p_resources, args.m_p_buffers);
+    std::vector<std::vector<VarData>*> arrays;
+    std::vector<Batch::Entry*> entries;
+    for (auto& entry : batch.m_entries)
+    {
+        if (!entry.m_state->m_failed.load() && !stc_check_stopped(entry.m_state))
+        {
+            arrays.push_back(&entry.m_data);
+            entries.push_back(&entry);
+        }
+    }
+    try
+    {
+        const auto start = std::chrono::steady_clock::now();
+        if (!arrays.empty())
+        {
+            p_step->execute_batch(arrays);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        for (Batch::Entry* p_entry : entries)
+        {
+            const Plan& plan = *p_entry->m_state->m_p_plan;
+            stc_scatter(plan.step_at(p_entry->m_step_index), p_entry->m_data, *p_entry->m_state->m_p_slots);
+            if (p_entry->m_state->m_coarsening_threshold.count() > 0)
+            {
+                plan.record_cost(p_entry->m_step_index, elapsed / static_cast<int>(entries.size()));
+            }
+        }
+    }
+    catch (...)
+    {
+        for (Batch::Entry* p_entry : entries)
+        {
+            stc_record_error(p_entry->m_state);
+        }
+    }
+    // Each run continues on its own.
+    for (const auto& entry : batch.m_entries)
+    {
+        const auto& state = entry.m_state;
+        const size_t step_index = entry.m_step_index;
+        stc_submit(state, [state, step_index]() {
+            stc_run_unit(state, step_index, true);
+        });
+    }
+}
+
+void Executor::stc_record_error(const std::shared_ptr<RunState>& state)
+{
+    std::lock_guard<std::mutex> lock(state->m_mutex);
+    if (!state->m_error)
+    {
+        state->m_error = std::current_exception();
+    }
+    state->m_failed = true;
+}
+
+void Executor::stc_abort_queued(const std::shared_ptr<RunState>& state)
+{
+    stc_check_stopped(state);
+    // The Steps of the run waiting for resources or for a batch; none of
+    // them has started, nor holds resources.
+    std::vector<size_t> withdrawn;
+    if (ResourceManager* p_resources = state->m_args.m_p_resources)
+    {
+        for (size_t step_index : p_resources->withdraw(state.get()))
+        {
+            state->m_held[step_index] = ResourceDemand{0u, {}};
+            withdrawn.push_back(step_index);
+        }
+    }
+    {
+        Batcher& batcher = *state->m_sp_batcher;
+        std::lock_guard<std::mutex> lock(batcher.m_mutex);
+        for (auto iter = batcher.m_open.begin(); iter != batcher.m_open.end();)
+        {
+            auto& entries = iter->second->m_entries;
+            for (auto entry_iter = entries.begin(); entry_iter != entries.end();)
+            {
+                if (entry_iter->m_state == state)
+                {
+                    withdrawn.push_back(entry_iter->m_step_index);
+                    entry_iter = entries.erase(entry_iter);
+                }
+                else
+                {
+                    ++entry_iter;
+                }
+            }
+            iter = entries.empty() ? batcher.m_open.erase(iter) : std::next(iter);
+        }
+    }
+    for (size_t step_index : withdrawn)
+    {
+        stc_run_unit(state, step_index, true);
+    }
+}
+
+bool Executor::stc_check_stopped(const std::shared_ptr<RunState>& state)
+{
+    const RunControl* p_control = state->m_args.m_p_control;
+    if (!p_control || !p_control->is_stopped())
+    {
+        return false;
+    }
+    try
+    {
+        p_control->throw_if_stopped();
+    }
+    catch (...)
+    {
+        stc_record_error(state);
+    }
+    return true;
+}
+
+Step* Executor::stc_prepare_step(const Plan& plan, size_t step_index, std::vector<VarData>& slots, const RunArgs& args, std::vector<VarData>& data)
+{
+    const RoiDemand* p_demand = args.m_p_demand;
+    if (p_demand && !p_demand->is_step_needed(step_index))
+    {
+        return nullptr;
+    }
+    const PlanStep& plan_step = plan.step_at(step_index);
+    if (!stc_inputs_produced(plan_step, slots))
+    {
+        return nullptr; // cancelled; its outputs are never produced either
+    }
+    stc_gather(plan_step, slots, data);
+    if (args.m_p_storage)
+    {
+        stc_reuse_outputs(plan_step, *args.m_p_storage, data);
+    }
+    if (args.m_p_shapes)
+    {
+        stc_preallocate(plan_step, plan, args, data);
+    }
+    Step* p_step = args.m_p_steps ? args.m_p_steps->at(step_index).get() : plan_step.m_step.get();
+    if (p_step->needs_prepare())
+    {
+        p_step->ensure_prepared(stc_input_metas(plan_step, args, data));
+    }
+    return p_step;
+}
+
+void Executor::stc_preallocate(const PlanStep& plan_step, const Plan& plan, const RunArgs& args, std::vector<VarData>& data)
+{
+    const size_t data_count = plan_step.m_slots.size();
+    for (size_t k = 0u; k < data_count; ++k)
+    {
+        if (plan_step.m_usages.at(k) != DataUsage::Write || plan_step.m_optional.at(k))
+        {
+            continue; // an untaken optional output must stay unproduced
+        }
+        if (data.at(k).has_value())
+        {
+            continue; // reused from a previous run
+        }
+        const size_t slot_index = plan_step.m_slots.at(k);
+        const auto& meta = args.m_p_shapes->slot_meta(slot_index);
+        if (meta.has_value())
+        {
+            data.at(k) = args.m_p_buffers->acquire(plan.slot_at(slot_index).m_type, meta.value());
+        }
+    }
+}
+
+void Executor::stc_reuse_outputs(const PlanStep& plan_step, std::vector<VarData>& storage, std::vector<VarData>& data)
+{
+    const size_t data_count = plan_step.m_slots.size();
+    for (size_t k = 0u; k < data_count; ++k)
+    {
+        if (plan_step.m_usages.at(k) != DataUsage::Write || plan_step.m_optional.at(k))
+        {
+            continue;
+        }
+        // Each slot has one writer, so no other task touches this entry.
+        data.at(k) = std::move(storage.at(plan_step.m_slots.at(k)));
+    }
+}
+
+std::vector<std::optional<DataMeta>> Executor::stc_input_metas(const PlanStep& plan_step, const RunArgs& args, const std::vector<VarData>& data)
+{
+    const size_t data_count = plan_step.m_slots.size();
+    std::vector<std::optional<DataMeta>> metas(data_count);
+    for (size_t k = 0u; k < data_count; ++k)
+    {
+        if (plan_step.m_usages.at(k) == DataUsage::Write)
+        {
+            continue;
+        }
+        metas.at(k) = args.m_p_shapes
+            ? args.m_p_shapes->slot_meta(plan_step.m_slots.at(k))
+            : DataMeta::of(data.at(k));
+    }
+    return metas;
+}
+
+bool Executor::stc_execute_step(const Plan& plan, size_t step_index, std::vector<VarData>& slots, const RunArgs& args)
+{
+    std::vector<VarData> data;
+    Step* p_step = stc_prepare_step(plan, step_index, slots, args, data);
+    if (!p_step)
+    {
+        return false;
+    }
+    ResourceManager* p_resources = args.m_p_resources;
+    const ResourceDemand demand = p_resources ? p_step->resource_demand(data) : ResourceDemand{0u, {}};
+    const bool is_held = !demand.is_empty();
+    if (is_held)
+    {
+        stc_acquire_blocking(*p_resources, demand, args.m_p_control);
+    }
+    try
+    {
+        const RoiDemand* p_demand = args.m_p_demand;
+        if (p_demand)
+        {
+            p_step->execute_roi(data, p_demand->make_step_roi(step_index));
+        }
+        else
+        {
+            p_step->execute(data);
+        }
+        stc_scatter(plan.step_at(step_index), data, slots);
+    }
+    catch (...)
+    {
+        if (is_held)
+        {
+            p_resources->release(demand);
+        }
+        throw;
+    }
+    if (is_held)
+    {
+        p_resources->release(demand);
+    }
+    return true;
+}
+
+void Executor::stc_acquire_blocking(ResourceManager& resources, const ResourceDemand& demand, const RunControl* p_control)
+{
+    // A worker helps the pool meanwhile; the holders may be queued behind it.
+    ThreadPool* pool = ThreadPool::current();
+    while (!resources.try_acquire(demand))
+    {
+        if (p_control)
+        {
+            p_control->throw_if_stopped();
+        }
+        if (!pool || !pool->try_run_one())
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+}
+
+bool Executor::stc_inputs_produced(const PlanStep& plan_step, const std::vector<VarData>& slots)
+{
+    /**
+     * @note All predecessors have finished and required global inputs are
+     * validated before the run, so an empty input slot can only mean that
+     * its writer did not produce it (or was itself cancelled).
+     */
+    const size_t data_count = plan_step.m_slots.size();
+    for (size_t k = 0u; k < data_count; ++k)
+    {
+        if (plan_step.m_usages.at(k) == DataUsage::Write || plan_step.m_optional.at(k))
+        {
+            continue;
+        }
+        if (!slots.at(plan_step.m_slots.at(k)).has_value())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Executor::stc_gather(const PlanStep& plan_step, std::vector<VarData>& slots, std::vector<VarData>& data)
+{
+    const size_t data_count = plan_step.m_slots.size();
+    data.clear();
+    data.resize(data_count);
+    for (size_t k = 0u; k < data_count; ++k)
+    {
+        VarData& slot = slots.at(plan_step.m_slots.at(k));
+        switch (plan_step.m_usages.at(k))
+        {
+        case DataUsage::Read:
+            data.at(k) = slot;
+            break;
+        case DataUsage::Consume:
+            data.at(k) = std::move(slot);
+            break;
+        case DataUsage::Write:
+            break;
+        }
+    }
+}
+
+void Executor::stc_scatter(const PlanStep& plan_step, std::vector<VarData>& data, std::vector<VarData>& slots)
+{
+    const size_t data_count = plan_step.m_slots.size();
+    for (size_t k = 0u; k < data_count; ++k)
+    {
+        if (plan_step.m_usages.at(k) == DataUsage::Write)
+        {
+            slots.at(plan_step.m_slots.at(k)) = std::move(data.at(k));
+        }
+    }
+    data.clear();
+}
+
+} // namespace tg::core
@@ -0,0 +1,452 @@
+#pragma once
+#include <chrono>
+#include <exception>
+#include "tg/core/fwd.hpp"
+
+namespace tg::core
+{
+
+/**
+ * @brief How a parallel Executor collects ready instances of a batchable
+ * Step from concurrent runs into one ```Step::execute_batch()``` call.
+ */
+struct BatchPolicy
+{
+    /**
+     * @brief The largest batch; a batch that reaches it runs at once.
+     * @note One disables batching.
+     */
+    size_t m_max_batch_size;
+
+    /**
+     * @brief The longest time the first instance of a batch waits for
+     * others; the batch then runs with whatever it has.
+     * @note Rounded up to the tick of the Executor's timing wheel.
+     */
+    std::chrono::microseconds m_max_wait;
+};
+
+/**
+ * @brief The share of the pool used by one tenant of a fair Executor.
+ */
+struct TenantStats
+{
+    /**
+     * @brief The tenant: the name of the Scope of the Plan.
+     */
+    std::string m_tenant;
+    double m_weight;
+
+    /**
+     * @brief The CPU time the pool's threads spent on the tenant's tasks.
+     * @note Measured per task, as thread CPU time on Linux and wall time
+     * elsewhere; a task that helps others while it waits (e.g. a nested
+     * run) is also charged for the tasks it helps.
+     */
+    std::chrono::nanoseconds m_cpu_time;
+    size_t m_task_count;
+};
+
+/**
+ * @brief Executes the Steps of a compiled Plan.
+ *
+ * @details The caller owns the slot array, which has one VarData per slot
+ * of the Plan (```Plan::slot_count()```). Global inputs must be populated
+ * before the run; global outputs are populated after the run.
+ *
+ * For each Step, the Executor gathers its data from the slots according
+ * to the binding in the Plan, executes it, then scatters its outputs back
+ * to the slots. Data read by a Step is shared (not copied); data consumed
+ * by a Step is moved out of the slot.
+ *
+ * Without a ThreadPool, the Steps are executed sequentially on the calling
+ * thread, in topological order. With a ThreadPool, each Step is submitted
+ * to the pool as soon as all of its predecessors have finished; the calling
+ * thread helps the pool until the run is complete, unless the run is
+ * asynchronous (see ```run_async()```).
+ *
+ * A Step may leave an optional output unproduced (see
+ * ```StepInfo::mark_data_as_optional()```), e.g. the untaken side of a
+ * BranchStep. Such a slot is never produced in this run: each Step that
+ * requires it (as a non-optional Read or Consume) is cancelled without being
+ * executed, which in turn leaves all of its own outputs unproduced. Hence a
+ * whole downstream subgraph is skipped at the cost of one check per Step.
+ * Unproduced slots remain empty after the run.
+ *
+ * Parallel runs coarsen tiny Steps automatically. Each executed Step is
+ * timed, and its moving average is kept in the Plan (see
+ * ```Plan::record_cost()```). When a finished Step makes successors ready,
+ * those whose estimated cost is below the coarsening threshold are not
+ * submitted to the pool; the same task runs them back-to-back, so a chain or
+ * cluster of cheap bookkeeping Steps forms one scheduling unit on one
+ * thread. Expensive successors are submitted first, so they are not held
+ * up. Steps without an estimate yet are treated as expensive.
+ *
+ * A Step may split its work into chunks (see ```Step::begin_chunks()```).
+ * A parallel run then submits the chunks to the pool as tasks of their own,
+ * so the scheduler sees the parallelism inside the Step and interleaves it
+ * with other ready Steps; the task finishing the last chunk completes the
+ * Step and releases its successors. Sequential and region-of-interest runs
+ * call ```execute()``` instead.
+ *
+ * With a batch policy (see ```set_batch_policy()```), a batchable Step
+ * (see ```Step::is_batchable()```) that becomes ready in several runs of
+ * the same Executor at about the same time, e.g. concurrent requests, is
+ * executed once for all of them, like the dynamic batching of inference
+ * servers. The first instance opens a batch, and later instances join it;
+ * no worker waits meanwhile. The batch runs on the thread that fills it,
+ * or as a pool task once the maximum wait expires (closed by the timing
+ * wheel of the Executor). Each run then continues with its successors as
+ * usual. If the batch call throws, all runs in the batch fail. What a
+ * batch saves beyond scheduling depends on the Step: only what its
+ * ```execute_batch()``` shares across the batch.
+ *
+ * The tasks of a parallel run go to the lane of the pool given by the
+ * priority of the Executor (see TaskPriority), so that runs of a
+ * latency-critical Executor overtake those of a batch Executor sharing the
+ * same pool.
+ *
+ * With fair scheduling (see ```set_fair_scheduling()```), an Executor
+ * shared by runs of the Plans of many Scopes (tenants) applies weighted
+ * fair queuing across them: a ready Step is queued with its tenant, and
+ * each pool task runs the queued Step of the tenant that received the
+ * least CPU time per unit of weight. One tenant's huge fan-out then
+ * cannot monopolize the workers. The CPU time of each tenant is
+ * reported by ```tenant_stats()```.
+ *
+ * With a ResourceManager (see ```set_resource_manager()```), a Step that
+ * declares a resource demand (see ```Step::resource_demand()```) is
+ * admitted only once the demand fits, and holds it until it completes. In
+ * a parallel run, a Step that does not fit waits in the ResourceManager
+ * without holding a worker, and is submitted when admitted; sequential
+ * and region-of-interest runs wait in place (a worker helps the pool
+ * meanwhile). Runs nested in a Step (e.g. MapStep, LoopStep) by an
+ * Executor with no ResourceManager of its own use that of the enclosing
+ * run, and so do their Steps; a Step holding resources should not nest
+ * Steps that demand the same ones.
+ *
+ * With a memory budget (see ```set_memory_budget()```), a run started from
+ * outside the pool first waits until its predicted peak memory fits in
+ * the budget (see MemoryBudget), and returns it when it ends. Runs nested
+ * in a Step, or started from pool tasks, are not admitted separately; the
+ * Runtime admits its requests before queueing them.
+ *
+ * With a buffer pool (see ```set_buffer_pool()```), each run first infers
+ * the shapes of its slots (see ShapeInference). Before a Step executes,
+ * each of its outputs whose shape is inferred exactly, and whose type is
+ * registered with the BufferPool, is placed in its data item already
+ * allocated, from buffers reused across runs. A Step that writes into that
+ * storage (e.g. through ```tg::opencv::output_mat()```) then allocates
+ * nothing; a Step that replaces the value is unaffected. Optional outputs,
+ * and region-of-interest runs, are not preallocated. A reused buffer holds
+ * stale contents; Steps must write all of it. As with the ResourceManager,
+ * a nested run uses the buffer pool of the enclosing run if its Executor
+ * has none.
+ *
+ * With output reuse (see ```set_output_reuse()```), a run given the slot
+ * array of a previous run of the same Plan (e.g. by LoopStep, once per
+ * iteration) reuses the values left in the slots written by Steps. The run
+ * first takes them out of the slots, so that a slot holds a value only
+ * once written by this run, and a Step that is not executed leaves no
+ * stale value behind. The value taken from a slot is placed in the data
+ * item of the Step writing it, as a preallocated buffer is, provided that
+ * nothing else refers to it or its storage (see
+ * ```BufferPool::is_reusable()```); otherwise it is dropped.
+ *
+ * Before executing a Step that needs it (see ```Step::needs_prepare()```),
+ * the Executor makes sure the Step is prepared for the metadata of its
+ * inputs (see ```Step::ensure_prepared()```): the inferred shapes if the
+ * run preallocates, otherwise those described from the input values. The
+ * setup then happens once per input shape, not once per execution; an
+ * execution on the shape of the previous one only compares metadata.
+ *
+ * A run may be given a RunControl, to cancel it or give it a deadline.
+ * Deadlines are tracked by a timing wheel owned by the Executor. Once the
+ * run is stopped, no further Step, chunk or batch entry of it starts; the
+ * Steps already executing finish, then the slots of the run are cleared
+ * and RunCancelled is thrown. Runs nested in a Step inherit the RunControl
+ * of the enclosing run (see ```RunControl::current()```).
+ */
+class Executor
+{
+public:
+    /**
+     * @brief Creates a sequential Executor.
+     */
+    Executor();
+
+    /**
+     * @brief Creates an Executor that runs Steps on the given pool.
+     * @note A null pool creates a sequential Executor.
+     */
+    explicit Executor(ThreadPoolPtr pool);
+
+    ~Executor();
+
+public:
+    /**
+     * @brief Returns the pool, or null for a sequential Executor.
+     */
+    const ThreadPoolPtr& pool() const;
+
+    /**
+     * @brief Sets the pool lane of the tasks of parallel runs; the default
+     * is ```TaskPriority::Latency```.
+     * @note A run nested in a batch task uses the batch lane regardless.
+     */
+    void set_priority(TaskPriority priority);
+    TaskPriority priority() const;
+
+    /**
+     * @brief Enables weighted fair queuing across the Scopes of the Plans
+     * run by this Executor; off by default.
+     * @note Must not be called during a run.
+     */
+    void set_fair_scheduling(bool enabled);
+    bool fair_scheduling() const;
+
+    /**
+     * @brief Sets the weight of a tenant (the name of a Scope); tenants
+     * default to a weight of one.
+     * @exception std::invalid_argument if the weight is not positive.
+     */
+    void set_tenant_weight(const std::string& tenant, double weight);
+
+    /**
+     * @brief The CPU time and task count of each tenant seen so far by fair
+     * scheduling.
+     * @note A task is accounted for after it returns, which may be just
+     * after the run it completed has returned.
+     */
+    std::vector<TenantStats> tenant_stats() const;
+
+    /**
+     * @brief Sets the ResourceManager that admits the Steps declaring a
+     * resource demand; null (the default) admits all Steps at once.
+     * @note Must not be called during a run.
+     */
+    void set_resource_manager(ResourceManagerPtr resources);
+    const ResourceManagerPtr& resource_manager() const;
+
+    /**
+     * @brief Predicts the peak memory of a run of the Plan on the given
+     * slots, with the global inputs populated.
+     */
+    using PeakPredictor = std::function<size_t(const Plan& plan, const std::vector<VarData>& slots)>;
+
+    /**
+     * @brief Sets the memory budget that admits new runs; null (the
+     * default) starts every run at once.
+     * @param predictor Predicts the peak memory of a run; null uses
+     * ```predict_peak()```'s default.
+     * @note Must not be called during a run.
+     */
+    void set_memory_budget(MemoryBudgetPtr budget, PeakPredictor predictor = nullptr);
+    const MemoryBudgetPtr& memory_budget() const;
+
+    /**
+     * @brief The predicted peak memory of a run, by the predictor if any.
+     *
+     * @details The default sums the bytes of all slots whose shape is
+     * inferred (see ShapeInference). A global input that cannot be described
+     * counts its DataSize; any other unknown slot, including one whose
+     * extent depends on the data (not exact), is assumed to be as large as
+     * all global inputs together.
+     */
+    size_t predict_peak(const Plan& plan, const std::vector<VarData>& slots) const;
+
+    /**
+     * @brief Sets the pool that preallocates the outputs of Steps whose
+     * shape is inferred; null (the default) leaves outputs to the Steps.
+     * @note Must not be called during a run.
+     */
+    void set_buffer_pool(BufferPoolPtr buffers);
+    const BufferPoolPtr& buffer_pool() const;
+
+    /**
+     * @brief Enables the reuse, as output storage, of the values that the
+     * slots written by Steps hold when a synchronous run starts; off by
+     * default.
+     * @note Must not be called during a run.
+     */
+    void set_output_reuse(bool enabled);
+    bool output_reuse() const;
+
+    /**
+     * @brief Sets the estimated cost below which a ready Step runs on the
+     * thread that made it ready instead of being submitted to the pool.
+     * @note Zero disables coarsening (and timing). The default is
+     * ```default_coarsening_threshold```.
+     */
+    void set_coarsening_threshold(std::chrono::nanoseconds threshold);
+    std::chrono::nanoseconds coarsening_threshold() const;
+
+    static constexpr std::chrono::nanoseconds default_coarsening_threshold{20000};
+
+    /**
+     * @brief Sets the batch policy; the default has a maximum batch size of
+     * one, i.e. no batching.
+     * @note Must not be called during a run.
+     */
+    void set_batch_policy(const BatchPolicy& policy);
+    const BatchPolicy& batch_policy() const;
+
+    /**
+     * @brief Executes all Steps of the Plan.
+     * @exception std::invalid_argument if the slot array has the wrong size,
+     * or if a global input is missing.
+     * @exception Rethrows the first exception thrown by a Step; the Steps
+     * depending on the failed Step are not executed.
+     */
+    void run(const Plan& plan, std::vector<VarData>& slots) const;
+
+    /**
+     * @brief Executes only the Steps needed for the propagated demand, and
+     * each of them only for its required region.
+     */
+    void run(const Plan& plan, std::vector<VarData>& slots, const RoiDemand& demand) const;
+
+    /**
+     * @brief Executes all Steps of the Plan, using the given Step objects
+     * in place of those of the Plan, by step index.
+     *
+     * @details This lets a caller pin one version of each Step for the whole
+     * run, while other runs of the same Plan use other versions (see
+     * StreamPipeline). Each replacement must have the same data as the Step
+     * it replaces.
+     *
+     * @exception std::invalid_argument if the table has the wrong size.
+     */
+    void run(const Plan& plan, std::vector<VarData>& slots, const StepTable& steps) const;
+
+    /**
+     * @brief Executes all Steps of the Plan under the given RunControl.
+     * @exception RunCancelled if the run was stopped before all of its Steps
+     * started; all slots are then cleared, as soon as the Steps already
+     * executing have returned.
+     * @note The control is marked finished when the run returns or throws,
+     * unless it was stopped.
+     */
+    void run(const Plan& plan, std::vector<VarData>& slots, const RunControlPtr& control) const;
+
+    /**
+     * @brief Receives the outcome of an asynchronous run: null on success,
+     * otherwise the exception a synchronous run would have thrown.
+     */
+    using Completion = std::function<void(std::exception_ptr error)>;
+
+    /**
+     * @brief Starts a run of all Steps of the Plan on the pool, and returns
+     * without waiting for it.
+     *
+     * @details No thread blocks on the run, so a burst of runs takes no
+     * worker and no stack while they wait: the task that completes the last
+     * Step calls ```on_complete```. Invalid slots are reported through it
+     * as well, before this returns. As with ```run()```, a stopped run
+     * clears its slots and reports RunCancelled; the control, if any, is
+     * marked finished before the callback.
+     *
+     * The run is not admitted against the memory budget; the caller admits
+     * it (see Runtime).
+     *
+     * @param control Optional; cancels the run or gives it a deadline.
+     * @note The Plan, the slots and the Executor must outlive the run; they
+     * may be released from ```on_complete```.
+     * @exception std::logic_error for a sequential Executor.
+     */
+    void run_async(const Plan& plan, std::vector<VarData>& slots, RunControlPtr control, Completion on_complete) const;
+
+    /**
+     * @brief Wraps a function that runs nested Plans so that, wherever it
+     * is called (e.g. on other workers by ```ThreadPool::parallel_for()```),
+     * those runs inherit the RunControl, ResourceManager and BufferPool of
+     * the Step executing on the calling thread, as runs nested in the Step
+     * itself do.
+     */
+    static std::function<void(size_t)> inherit_context(std::function<void(size_t)> func);
+
+private:
+    struct RunState;
+    struct ChunkRun;
+    struct Batch;
+    struct Batcher;
+
+    /**
+     * @brief The inputs of one run, other than the Plan and slots.
+     */
+    struct RunArgs
+    {
+        const RoiDemand* m_p_demand;
+        const StepTable* m_p_steps;
+        RunControl* m_p_control;
+        ResourceManager* m_p_resources;
+
+        /**
+         * @brief The inferred slot shapes and the pool that preallocates
+         * outputs from them, if preallocating.
+         */
+        const ShapeInference* m_p_shapes;
+        BufferPool* m_p_buffers;
+
+        /**
+         * @brief The values taken out of the written slots at the start of
+         * the run, by slot index, if reusing outputs.
+         */
+        std::vector<VarData>* m_p_storage;
+    };
+
+private:
+    void detail_run(const Plan& plan, std::vector<VarData>& slots, const RunArgs& args) const;
+    void detail_validate(const Plan& plan, std::vector<VarData>& slots, const RunArgs& args) const;
+    void detail_run_sequential(const Plan& plan, std::vector<VarData>& slots, const RunArgs& args) const;
+    void detail_run_parallel(const Plan& plan, std::vector<VarData>& slots, const RunArgs& args) const;
+    std::shared_ptr<RunState> detail_make_state(const Plan& plan, std::vector<VarData>& slots, const RunArgs& args) const;
+    static void stc_start_run(const std::shared_ptr<RunState>& state);
+    static void stc_finish_async(const std::shared_ptr<RunState>& state);
+    static void stc_submit(const std::shared_ptr<RunState>& state, std::function<void()> task);
+    static void stc_dispatch(const std::shared_ptr<RunState>& state, size_t step_index);
+    static void stc_run_unit(const std::shared_ptr<RunState>& state, size_t step_index, bool executed);
+    static bool stc_start_step(const std::shared_ptr<RunState>& state, size_t step_index);
+    static bool stc_launch_step(const std::shared_ptr<RunState>& state, const std::shared_ptr<ChunkRun>& chunk_run);
+    static bool stc_run_chunk(const std::shared_ptr<RunState>& state, const std::shared_ptr<ChunkRun>& chunk_run, size_t chunk_index);
+    static void stc_complete_step(const std::shared_ptr<RunState>& state, size_t step_index, std::vector<size_t>& unit);
+    static void stc_enqueue_batch(const std::shared_ptr<RunState>& state, size_t step_index, Step* p_step, std::vector<VarData> data);
+    static void stc_close_batch(const std::shared_ptr<Batcher>& sp_batcher, Step* p_step, const std::weak_ptr<Batch>& wp_batch);
+    static void stc_execute_batch(Step* p_step, Batch& batch);
+    static void stc_abort_queued(const std::shared_ptr<RunState>& state);
+    static void stc_record_error(const std::shared_ptr<RunState>& state);
+    static bool stc_check_stopped(const std::shared_ptr<RunState>& state);
+    static Step* stc_prepare_step(const Plan& plan, size_t step_index, std::vector<VarData>& slots, const RunArgs& args, std::vector<VarData>& data);
+    static void stc_preallocate(const PlanStep& plan_step, const Plan& plan, const RunArgs& args, std::vector<VarData>& data);
+    static void stc_reuse_outputs(const PlanStep& plan_step, std::vector<VarData>& storage, std::vector<VarData>& data);
+    static std::vector<std::optional<DataMeta>> stc_input_metas(const PlanStep& plan_step, const RunArgs& args, const std::vector<VarData>& data);
+    static bool stc_execute_step(const Plan& plan, size_t step_index, std::vector<VarData>& slots, const RunArgs& args);
+    static size_t stc_default_peak(const Plan& plan, const std::vector<VarData>& slots);
+    static void stc_acquire_blocking(ResourceManager& resources, const ResourceDemand& demand, const RunControl* p_control);
+    static bool stc_inputs_produced(const PlanStep& plan_step, const std::vector<VarData>& slots);
+    static void stc_gather(const PlanStep& plan_step, std::vector<VarData>& slots, std::vector<VarData>& data);
+    static void stc_scatter(const PlanStep& plan_step, std::vector<VarData>& data, std::vector<VarData>& slots);
+
+private:
+    Executor(const Executor&) = delete;
+    Executor(Executor&&) = delete;
+    Executor& operator=(const Executor&) = delete;
+    Executor& operator=(Executor&&) = delete;
+
+private:
+    ThreadPoolPtr m_sp_pool;
+    TaskPriority m_priority;
+    bool m_fair_scheduling;
+    std::shared_ptr<details::FairScheduler> m_sp_fair;
+    ResourceManagerPtr m_sp_resources;
+    MemoryBudgetPtr m_sp_memory;
+    PeakPredictor m_peak_predictor;
+    BufferPoolPtr m_sp_buffers;
+    bool m_output_reuse;
+    std::chrono::nanoseconds m_coarsening_threshold;
+    BatchPolicy m_batch_policy;
+    std::shared_ptr<Batcher> m_sp_batcher;
+    std::shared_ptr<details::TimingWheel> m_sp_wheel;
+};
+
+} // namespace tg::core
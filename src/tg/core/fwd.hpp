@@ -18,6 +18,7 @@
 #include "tg/data/specialized/opaque_ptr_key.hpp"
 #include "tg/core/core_enums.hpp"
 #include "tg/core/core_exceptions.hpp"
+#include "tg/core/roi.hpp"
 
 namespace tg::core
 {
@@ -29,6 +30,12 @@ class Step;
 using StepPtr = std::shared_ptr<Step>;
 using StepWPtr = std::weak_ptr<Step>;
 
+/**
+ * @brief Step objects by step index of a Plan.
+ */
+using StepTable = std::vector<StepPtr>;
+using StepTablePtr = std::shared_ptr<const StepTable>;
+
 class StepInfo;
 using StepInfoPtr = std::shared_ptr<StepInfo>;
 
@@ -41,6 +48,42 @@ class ScopeInfo;
 using ScopeInfoPtr = std::shared_ptr<ScopeInfo>;
 using ScopeInfoWPtr = std::weak_ptr<ScopeInfo>;
 
+struct PlanSlot;
+struct PlanStep;
+class Plan;
+using PlanPtr = std::shared_ptr<Plan>;
+
+class ScopeStep;
+using ScopeStepPtr = std::shared_ptr<ScopeStep>;
+
+class RoiDemand;
+class ShapeInference;
+struct DataMeta;
+class Executor;
+
+struct ResourceDemand;
+class ResourceManager;
+using ResourceManagerPtr = std::shared_ptr<ResourceManager>;
+
+class MemoryBudget;
+using MemoryBudgetPtr = std::shared_ptr<MemoryBudget>;
+
+class BufferPool;
+using BufferPoolPtr = std::shared_ptr<BufferPool>;
+
+class RunControl;
+using RunControlPtr = std::shared_ptr<RunControl>;
+using RunControlWPtr = std::weak_ptr<RunControl>;
+
+class Runtime;
+using RuntimePtr = std::shared_ptr<Runtime>;
+
+class ThreadPool;
+using ThreadPoolPtr = std::shared_ptr<ThreadPool>;
+class ScratchArena;
+
 namespace details { class ScopeStepIter; }
+namespace details { class TimingWheel; }
+namespace details { class FairScheduler; }
 
 } // namespace tg::core
@@ -0,0 +1,163 @@
+#include "tg/core/loop_step.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/core/plan.hpp"
+
+namespace tg::core
+{
+
+LoopStep::LoopStep(std::string_view shortname, PlanPtr body_plan, std::string_view stop_name, size_t max_iterations)
+    : Step{}
+    , m_body_plan{std::move(body_plan)}
+    , m_stop_slot{}
+    , m_max_iterations{max_iterations}
+    , m_inputs{}
+    , m_carries{}
+    , m_outputs{}
+{
+    if (!m_body_plan)
+    {
+        throw std::invalid_argument("LoopStep::LoopStep(): body plan cannot be null.");
+    }
+    if (m_max_iterations == 0u)
+    {
+        throw std::invalid_argument("LoopStep::LoopStep(): max iterations must be positive.");
+    }
+    m_stop_slot = this->detail_find_slot("LoopStep::LoopStep()", stop_name);
+    const PlanSlot& stop_slot = m_body_plan->slot_at(m_stop_slot);
+    if (!stop_slot.m_writer.has_value() || stop_slot.m_type != std::type_index(typeid(bool)))
+    {
+        throw std::invalid_argument(
+            "LoopStep::LoopStep(): stop predicate " + std::string(stop_name) + " must be a bool written by the body."
+        );
+    }
+    this->info().set_shortname(shortname);
+    this->info().set_step_type<LoopStep>();
+}
+
+LoopStep::~LoopStep()
+{
+}
+
+void LoopStep::bind_input(std::string_view input_name, std::string_view body_slot_name)
+{
+    const size_t slot_index = this->detail_find_slot("LoopStep::bind_input()", body_slot_name);
+    const PlanSlot& slot = m_body_plan->slot_at(slot_index);
+    if (slot.m_writer.has_value())
+    {
+        throw std::invalid_argument(
+            "LoopStep::bind_input(): data " + slot.m_name + " is not a global input of the body."
+        );
+    }
+    auto& info = this->info();
+    auto existing = info.find_data(input_name);
+    if (existing.has_value())
+    {
+        // One input may initialize several body slots.
+        const DataInfoTuple data_info = info.get_data_info(existing.value());
+        if (data_info.m_usage != DataUsage::Read || data_info.m_type != slot.m_type)
+        {
+            throw std::invalid_argument(
+                "LoopStep::bind_input(): input " + std::string(input_name) + " is already bound with a different type."
+            );
+        }
+        m_inputs.emplace_back(existing.value(), slot_index);
+        return;
+    }
+    const size_t local_index = info.data_count();
+    info.add_data(input_name, DataUsage::Read, slot.m_type);
+    m_inputs.emplace_back(local_index, slot_index);
+}
+
+void LoopStep::carry(std::string_view from_slot_name, std::string_view to_slot_name)
+{
+    const size_t from_index = this->detail_find_slot("LoopStep::carry()", from_slot_name);
+    const size_t to_index = this->detail_find_slot("LoopStep::carry()", to_slot_name);
+    const PlanSlot& from_slot = m_body_plan->slot_at(from_index);
+    const PlanSlot& to_slot = m_body_plan->slot_at(to_index);
+    if (!from_slot.m_writer.has_value() || from_slot.m_consumer.has_value())
+    {
+        throw std::invalid_argument(
+            "LoopStep::carry(): data " + from_slot.m_name + " must be written and not consumed by the body."
+        );
+    }
+    if (to_slot.m_writer.has_value())
+    {
+        throw std::invalid_argument(
+            "LoopStep::carry(): data " + to_slot.m_name + " is not a global input of the body."
+        );
+    }
+    if (from_slot.m_type != to_slot.m_type)
+    {
+        throw std::invalid_argument(
+            "LoopStep::carry(): data " + from_slot.m_name + " and " + to_slot.m_name + " have different types."
+        );
+    }
+    m_carries.emplace_back(from_index, to_index);
+}
+
+void LoopStep::bind_output(std::string_view body_slot_name, std::string_view output_name)
+{
+    const size_t slot_index = this->detail_find_slot("LoopStep::bind_output()", body_slot_name);
+    const size_t local_index = this->info().data_count();
+    this->info().add_data(output_name, DataUsage::Write, m_body_plan->slot_at(slot_index).m_type);
+    m_outputs.emplace_back(slot_index, local_index);
+}
+
+const Plan& LoopStep::body_plan() const
+{
+    return *m_body_plan;
+}
+
+void LoopStep::execute(std::vector<VarData>& data)
+{
+    this->pre_execute_validation(data);
+    std::vector<VarData> body_slots(m_body_plan->slot_count());
+    for (const auto& [local_index, slot_index] : m_inputs)
+    {
+        body_slots.at(slot_index) = data.at(local_index);
+    }
+    Executor body_executor;
+    /**
+     * @note The written slots keep their values between iterations; each run
+     * takes them out before any Step executes, and hands them to the Steps
+     * writing the slots as storage. A Step not executed in an iteration
+     * therefore cannot leave a stale value from the previous one.
+     */
+    body_executor.set_output_reuse(true);
+    for (size_t iteration = 0u; iteration < m_max_iterations; ++iteration)
+    {
+        if (iteration > 0u)
+        {
+            // Swapped rather than moved: the source keeps the value replaced, as storage for its writer.
+            for (const auto& [from_index, to_index] : m_carries)
+            {
+                std::swap(body_slots.at(to_index), body_slots.at(from_index));
+            }
+        }
+        body_executor.run(*m_body_plan, body_slots);
+        const VarData& stop = body_slots.at(m_stop_slot);
+        if (stop.has_value() && stop.as<bool>())
+        {
+            break;
+        }
+    }
+    for (const auto& [slot_index, local_index] : m_outputs)
+    {
+        data.at(local_index) = std::move(body_slots.at(slot_index));
+    }
+    this->post_execute_validation(data);
+}
+
+size_t LoopStep::detail_find_slot(const char* func_name, std::string_view name) const
+{
+    auto slot_opt = m_body_plan->find_slot(name);
+    if (!slot_opt.has_value())
+    {
+        throw std::invalid_argument(
+            std::string(func_name) + ": data " + std::string(name) + " not found in body plan."
+        );
+    }
+    return slot_opt.value();
+}
+
+} // namespace tg::core
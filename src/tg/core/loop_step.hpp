@@ -0,0 +1,106 @@
+#pragma once
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+
+namespace tg::core
+{
+
+/**
+ * @brief A Step that re-executes a compiled subgraph (the body Plan) until a
+ * predicate computed by the body says stop.
+ *
+ * @details The data of the body is held in one slot array, allocated once
+ * per execution of the LoopStep and reused by every iteration; the body
+ * Plan is never recompiled. The values written by the body are reused as
+ * well: a Step that writes into its output storage (e.g. through
+ * ```tg::opencv::output_mat()```) writes into the buffer of the previous
+ * iteration (see ```Executor::set_output_reuse()```).
+ *
+ * - A bound input initializes a global input of the body before the first
+ *   iteration. If it is not the target of a carry, it is loop-invariant
+ *   and must only be read (not consumed) by the body.
+ * - A carry moves the value of a slot written by the body into a global
+ *   input of the body, between two iterations (loop-carried data).
+ * - The stop predicate is a bool slot written by the body; the loop ends
+ *   after the first iteration in which it is true, or after the maximum
+ *   number of iterations.
+ * - A bound output takes the value of a body slot after the last iteration.
+ *
+ * The body runs sequentially on the thread executing the LoopStep.
+ *
+ * @note Inputs, carries and outputs are declared before the Step is added
+ * to a Scope.
+ */
+class LoopStep
+    : public Step
+{
+public:
+    /**
+     * @param shortname The name of the Step.
+     * @param body_plan The compiled subgraph run on each iteration.
+     * @param stop_name The name of the bool slot written by the body.
+     * @param max_iterations The iteration limit; must be positive.
+     * @exception std::invalid_argument if the body Plan is null, the stop
+     * slot is not a bool written by the body, or the limit is zero.
+     */
+    LoopStep(std::string_view shortname, PlanPtr body_plan, std::string_view stop_name, size_t max_iterations);
+    ~LoopStep() override;
+
+    using Step::info;
+
+    /**
+     * @brief Adds an input that initializes a global input of the body.
+     * @note Binding the same input to several body slots is allowed.
+     * @exception std::invalid_argument if the body has no such global input,
+     * or if the input is already bound with a different type.
+     */
+    void bind_input(std::string_view input_name, std::string_view body_slot_name);
+
+    /**
+     * @brief Declares loop-carried data: after each iteration that does not
+     * stop, the value of ```from_slot_name``` moves to ```to_slot_name```.
+     * @exception std::invalid_argument if ```from_slot_name``` is not
+     * written by the body, ```to_slot_name``` is not a global input of the
+     * body, or their types differ.
+     */
+    void carry(std::string_view from_slot_name, std::string_view to_slot_name);
+
+    /**
+     * @brief Adds an output that takes the value of a body slot after the
+     * last iteration.
+     * @exception std::invalid_argument if the body has no such slot.
+     */
+    void bind_output(std::string_view body_slot_name, std::string_view output_name);
+
+    /**
+     * @brief The compiled subgraph run on each iteration.
+     */
+    const Plan& body_plan() const;
+
+    void execute(std::vector<VarData>& data) override;
+
+private:
+    size_t detail_find_slot(const char* func_name, std::string_view name) const;
+
+private:
+    PlanPtr m_body_plan;
+    size_t m_stop_slot;
+    size_t m_max_iterations;
+
+    /**
+     * @brief Pairs of (local data index, body slot index).
+     */
+    std::vector<std::pair<size_t, size_t>> m_inputs;
+
+    /**
+     * @brief Pairs of (from body slot index, to body slot index).
+     */
+    std::vector<std::pair<size_t, size_t>> m_carries;
+
+    /**
+     * @brief Pairs of (body slot index, local data index).
+     */
+    std::vector<std::pair<size_t, size_t>> m_outputs;
+};
+
+} // namespace tg::core
@@ -0,0 +1,90 @@
+#include "tg/core/map_step.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/thread_pool.hpp"
+
+namespace tg::core
+{
+
+MapStep::MapStep(std::string_view shortname, PlanPtr item_plan, ItemCountFunc count_func, ItemBindFunc bind_func)
+    : Step{}
+    , m_item_plan{std::move(item_plan)}
+    , m_count_func{std::move(count_func)}
+    , m_bind_func{std::move(bind_func)}
+    , m_collects{}
+    , m_item_executor{}
+{
+    if (!m_item_plan)
+    {
+        throw std::invalid_argument("MapStep::MapStep(): item plan cannot be null.");
+    }
+    if (!m_count_func || !m_bind_func)
+    {
+        throw std::invalid_argument("MapStep::MapStep(): item functions cannot be empty.");
+    }
+    this->info().set_shortname(shortname);
+    this->info().set_step_type<MapStep>();
+}
+
+MapStep::~MapStep()
+{
+}
+
+void MapStep::collect(std::string_view item_slot_name, std::string_view output_name)
+{
+    auto slot_opt = m_item_plan->find_slot(item_slot_name);
+    if (!slot_opt.has_value())
+    {
+        throw std::invalid_argument(
+            "MapStep::collect(): data " + std::string(item_slot_name) + " not found in item plan."
+        );
+    }
+    const size_t local_index = this->info().data_count();
+    this->info().add_data<Items>(output_name, DataUsage::Write);
+    m_collects.emplace_back(slot_opt.value(), local_index);
+}
+
+const Plan& MapStep::item_plan() const
+{
+    return *m_item_plan;
+}
+
+void MapStep::execute(std::vector<VarData>& data)
+{
+    this->pre_execute_validation(data);
+    const size_t item_count = m_count_func(data);
+    std::vector<Items> collected(m_collects.size(), Items(item_count));
+    const std::vector<VarData>& inputs = data;
+    ThreadPool* pool = ThreadPool::current();
+    if (pool)
+    {
+        // The items inherit the control and resources of this run on any worker.
+        pool->parallel_for(item_count, Executor::inherit_context([&](size_t item_index) {
+            this->detail_run_item(item_index, inputs, collected);
+        }));
+    }
+    else
+    {
+        for (size_t item_index = 0u; item_index < item_count; ++item_index)
+        {
+            this->detail_run_item(item_index, inputs, collected);
+        }
+    }
+    for (size_t c = 0u; c < m_collects.size(); ++c)
+    {
+        data.at(m_collects.at(c).second).emplace<Items>(std::move(collected.at(c)));
+    }
+    this->post_execute_validation(data);
+}
+
+void MapStep::detail_run_item(size_t item_index, const std::vector<VarData>& data, std::vector<Items>& collected) const
+{
+    std::vector<VarData> item_slots(m_item_plan->slot_count());
+    m_bind_func(item_index, data, item_slots);
+    m_item_executor.run(*m_item_plan, item_slots);
+    for (size_t c = 0u; c < m_collects.size(); ++c)
+    {
+        collected.at(c).at(item_index) = std::move(item_slots.at(m_collects.at(c).first));
+    }
+}
+
+} // namespace tg::core
@@ -0,0 +1,83 @@
+#pragma once
+#include "tg/core/executor.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+
+namespace tg::core
+{
+
+/**
+ * @brief A Step that maps a subgraph over a collection whose size is only
+ * known at run time (dynamic fan-out).
+ *
+ * @details The subgraph is given as a compiled item Plan. At execution, the
+ * item count function reads the inputs of the MapStep (e.g. the ```stats```
+ * of ConnCompStep) and returns the number of items. For each item, a fresh
+ * slot array of the item Plan is populated by the item bind function,
+ * typically with zero-copy views (e.g. ```cv::Mat``` ROIs) of the inputs,
+ * and the item Plan is run.
+ *
+ * The items are run in parallel on the ThreadPool the MapStep is executed
+ * on (see ```ThreadPool::current()```), alongside other ready Steps; each
+ * item runs its Plan sequentially, on one Executor shared by all items.
+ * Without a pool, the items run in order. On any worker, the item runs
+ * inherit the RunControl, ResourceManager and BufferPool of the run of the
+ * MapStep (see ```Executor::inherit_context()```).
+ *
+ * Each collected output is an ```Items``` vector with one entry per item,
+ * holding the value of a named slot of the item Plan.
+ *
+ * @note Inputs are declared on ```info()``` with ```DataUsage::Read```, and
+ * outputs with ```collect()```, both before the Step is added to a Scope.
+ */
+class MapStep
+    : public Step
+{
+public:
+    using Items = std::vector<VarData>;
+    using ItemCountFunc = std::function<size_t(const std::vector<VarData>& data)>;
+    using ItemBindFunc = std::function<void(
+        size_t item_index,
+        const std::vector<VarData>& data,
+        std::vector<VarData>& item_slots)>;
+
+public:
+    MapStep(std::string_view shortname, PlanPtr item_plan, ItemCountFunc count_func, ItemBindFunc bind_func);
+    ~MapStep() override;
+
+    using Step::info;
+
+    /**
+     * @brief Adds an output of type ```Items``` which collects the value of
+     * the given slot of the item Plan, for each item.
+     * @exception std::invalid_argument if the item Plan has no such slot.
+     */
+    void collect(std::string_view item_slot_name, std::string_view output_name);
+
+    /**
+     * @brief The compiled subgraph run for each item.
+     */
+    const Plan& item_plan() const;
+
+    void execute(std::vector<VarData>& data) override;
+
+private:
+    void detail_run_item(size_t item_index, const std::vector<VarData>& data, std::vector<Items>& collected) const;
+
+private:
+    PlanPtr m_item_plan;
+    ItemCountFunc m_count_func;
+    ItemBindFunc m_bind_func;
+
+    /**
+     * @brief Pairs of (item Plan slot index, local data index).
+     */
+    std::vector<std::pair<size_t, size_t>> m_collects;
+
+    /**
+     * @brief Sequential; runs the item Plan of every item.
+     */
+    Executor m_item_executor;
+};
+
+} // namespace tg::core
@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include "tg/core/memory_budget.hpp"
+
+namespace tg::core
+{
+
+namespace //(unnamed)
+{
+
+/**
+ * @brief cgroup v1 reports "no limit" as a huge page-aligned number.
+ */
+constexpr size_t cgroup_v1_unlimited = static_cast<size_t>(1u) << 62u;
+
+std::optional<std::string> read_first_token(const std::string& path)
+{
+    std::ifstream file(path);
+    std::string token;
+    if (!file || !(file >> token))
+    {
+        return std::nullopt;
+    }
+    return token;
+}
+
+std::optional<size_t> parse_bytes(const std::string& token)
+{
+    if (token.empty() || token.find_first_not_of("0123456789") != std::string::npos)
+    {
+        return std::nullopt; // e.g. "max"
+    }
+    try
+    {
+        return static_cast<size_t>(std::stoull(token));
+    }
+    catch (const std::out_of_range&)
+    {
+        return std::nullopt;
+    }
+}
+
+/**
+ * @brief The cgroup of the process in ```/proc/self/cgroup``` (lines of
+ * ```hierarchy-ID:controller-list:path```): in the v1 hierarchy of the
+ * given controller, or in the v2 hierarchy if the controller is empty.
+ * @returns The path without trailing slash (empty for the root), or
+ * nullopt if not listed.
+ */
+std::optional<std::string> read_cgroup_path(const std::string& proc_cgroup, const std::string& controller)
+{
+    std::ifstream file(proc_cgroup);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        const size_t first = line.find(':');
+        const size_t second = (first == std::string::npos) ? std::string::npos : line.find(':', first + 1u);
+        if (second == std::string::npos)
+        {
+            continue;
+        }
+        const std::string controllers = line.substr(first + 1u, second - first - 1u);
+        bool is_match = false;
+        if (controller.empty())
+        {
+            is_match = (line.compare(0u, first, "0") == 0) && controllers.empty();
+        }
+        else
+        {
+            std::istringstream list(controllers);
+            std::string name;
+            while (!is_match && std::getline(list, name, ','))
+            {
+                is_match = (name == controller);
+            }
+        }
+        if (is_match)
+        {
+            std::string path = line.substr(second + 1u);
+            while (!path.empty() && path.back() == '/')
+            {
+                path.pop_back();
+            }
+            return path;
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief The lowest limit in the given file of the cgroup at ```path```
+ * under ```root```, and of its ancestors: a cgroup is also bound by the
+ * limits of its ancestors.
+ * @param no_limit Values from this on mean no limit.
+ * @param is_found Set if any of the files exists.
+ */
+std::optional<size_t> read_lowest_limit(const std::string& root, std::string path, const std::string& filename, size_t no_limit, bool& is_found)
+{
+    std::optional<size_t> lowest;
+    while (true)
+    {
+        if (auto token = read_first_token(root + path + "/" + filename))
+        {
+            is_found = true;
+            auto bytes = parse_bytes(token.value());
+            if (bytes.has_value() && bytes.value() < no_limit && (!lowest.has_value() || bytes.value() < lowest.value()))
+            {
+                lowest = bytes;
+            }
+        }
+        if (path.empty())
+        {
+            break;
+        }
+        path.erase(path.rfind('/'));
+    }
+    return lowest;
+}
+
+} // namespace(unnamed)
+
+MemoryBudget::MemoryBudget(size_t budget_bytes)
+    : m_mutex{}
+    , m_cv{}
+    , m_budget{budget_bytes}
+    , m_in_use{0u}
+    , m_waiters{}
+{
+}
+
+MemoryBudget::~MemoryBudget()
+{
+}
+
+MemoryBudgetPtr MemoryBudget::from_environment(double fraction, size_t fallback_bytes)
+{
+    if (!(fraction > 0.0 && fraction <= 1.0))
+    {
+        throw std::invalid_argument("MemoryBudget::from_environment(): fraction must be in (0, 1].");
+    }
+    const auto limit = read_cgroup_limit();
+    const size_t budget = limit.has_value()
+        ? static_cast<size_t>(static_cast<double>(limit.value()) * fraction)
+        : fallback_bytes;
+    return std::make_shared<MemoryBudget>(budget);
+}
+
+std::optional<size_t> MemoryBudget::read_cgroup_limit(const std::string& root, const std::string& proc_cgroup)
+{
+    // A process not listed (e.g. no /proc) is taken to be in the root cgroup.
+    bool is_found = false;
+    const std::string v2_path = read_cgroup_path(proc_cgroup, "").value_or("");
+    auto limit = read_lowest_limit(root, v2_path, "memory.max", unlimited, is_found);
+    if (is_found)
+    {
+        return limit;
+    }
+    const std::string v1_path = read_cgroup_path(proc_cgroup, "memory").value_or("");
+    return read_lowest_limit(root + "/memory", v1_path, "memory.limit_in_bytes", cgroup_v1_unlimited, is_found);
+}
+
+size_t MemoryBudget::budget() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_budget;
+}
+
+void MemoryBudget::set_budget(size_t budget_bytes)
+{
+    std::vector<Callback> admitted;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_budget = budget_bytes;
+        admitted = this->detail_admit_waiters();
+    }
+    this->detail_run_callbacks(std::move(admitted));
+}
+
+size_t MemoryBudget::in_use() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_in_use;
+}
+
+size_t MemoryBudget::waiting_count() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_waiters.size();
+}
+
+void MemoryBudget::acquire(size_t bytes)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_waiters.empty() && this->detail_fits(bytes))
+    {
+        m_in_use += bytes;
+        return;
+    }
+    auto waiter = std::make_shared<Waiter>(Waiter{bytes, nullptr, false});
+    m_waiters.push_back(waiter);
+    m_cv.wait(lock, [&waiter]() {
+        return waiter->m_is_admitted;
+    });
+}
+
+bool MemoryBudget::acquire_or_wait(size_t bytes, Callback on_admitted)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_waiters.empty() && this->detail_fits(bytes))
+    {
+        m_in_use += bytes;
+        return true;
+    }
+    m_waiters.push_back(std::make_shared<Waiter>(Waiter{bytes, std::move(on_admitted), false}));
+    return false;
+}
+
+void MemoryBudget::release(size_t bytes)
+{
+    std::vector<Callback> admitted;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_in_use -= std::min(bytes, m_in_use);
+        admitted = this->detail_admit_waiters();
+    }
+    this->detail_run_callbacks(std::move(admitted));
+}
+
+bool MemoryBudget::detail_fits(size_t bytes) const
+{
+    // An oversized run goes alone rather than never.
+    return m_in_use == 0u || bytes <= m_budget - std::min(m_budget, m_in_use);
+}
+
+std::vector<MemoryBudget::Callback> MemoryBudget::detail_admit_waiters()
+{
+    std::vector<Callback> admitted;
+    bool is_blocked_admitted = false;
+    // Strictly in order, so that large runs are not overtaken forever.
+    while (!m_waiters.empty() && this->detail_fits(m_waiters.front()->m_bytes))
+    {
+        auto waiter = std::move(m_waiters.front());
+        m_waiters.pop_front();
+        m_in_use += waiter->m_bytes;
+        waiter->m_is_admitted = true;
+        if (waiter->m_on_admitted)
+        {
+            admitted.push_back(std::move(waiter->m_on_admitted));
+        }
+        else
+        {
+            is_blocked_admitted = true;
+        }
+    }
+    if (is_blocked_admitted)
+    {
+        m_cv.notify_all();
+    }
+    return admitted;
+}
+
+void MemoryBudget::detail_run_callbacks(std::vector<Callback> callbacks)
+{
+    for (auto& on_admitted : callbacks)
+    {
+        on_admitted();
+    }
+}
+
+} // namespace tg::core
@@ -0,0 +1,108 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include "tg/core/fwd.hpp"
+
+namespace tg::core
+{
+
+/**
+ * @brief A process-wide memory budget that admits runs by their predicted
+ * peak memory.
+ *
+ * @details Runs are admitted in arrival order: a run starts once its
+ * predicted bytes fit in what the runs in flight leave of the budget, and
+ * no earlier run is still waiting; so a burst of large inputs is queued
+ * instead of being started at once. A run predicted to exceed the whole
+ * budget is admitted alone, once nothing else is in flight.
+ *
+ * The budget is either configured, or derived from the cgroup memory limit
+ * of the process (see ```from_environment()```).
+ *
+ * @note Thread-safe; may be shared by several Executors and Runtimes.
+ */
+class MemoryBudget
+{
+public:
+    using Callback = std::function<void()>;
+    static constexpr size_t unlimited = ~static_cast<size_t>(0u);
+
+public:
+    explicit MemoryBudget(size_t budget_bytes);
+    ~MemoryBudget();
+
+    /**
+     * @brief Creates a budget of a fraction of the cgroup memory limit, or
+     * of ```fallback_bytes``` if there is none.
+     * @param fraction The share of the limit given to runs; the rest is
+     * headroom for everything else in the process.
+     */
+    static MemoryBudgetPtr from_environment(double fraction, size_t fallback_bytes);
+
+    /**
+     * @brief Reads the memory limit of the cgroup of the process:
+     * ```memory.max``` (v2), else ```memory/memory.limit_in_bytes``` (v1),
+     * under the given root.
+     *
+     * @details The cgroup of the process is looked up in ```proc_cgroup```;
+     * the limit is the lowest of that cgroup and its ancestors. A process
+     * not listed there is taken to be in the root cgroup.
+     *
+     * @returns The limit, or nullopt if there is none or it is unlimited.
+     */
+    static std::optional<size_t> read_cgroup_limit(const std::string& root = "/sys/fs/cgroup", const std::string& proc_cgroup = "/proc/self/cgroup");
+
+public:
+    size_t budget() const;
+    void set_budget(size_t budget_bytes);
+    size_t in_use() const;
+    size_t waiting_count() const;
+
+    /**
+     * @brief Blocks until the bytes are admitted.
+     */
+    void acquire(size_t bytes);
+
+    /**
+     * @brief Admits the bytes now if possible; otherwise queues them, and
+     * calls ```on_admitted``` once they have been admitted.
+     * @returns True if admitted now; the callback is then not called.
+     * @note The callback runs on the thread that releases the budget, and
+     * should only hand the work over (e.g. submit a task).
+     */
+    bool acquire_or_wait(size_t bytes, Callback on_admitted);
+
+    void release(size_t bytes);
+
+private:
+    struct Waiter
+    {
+        size_t m_bytes;
+
+        /**
+         * @brief Null for a blocked ```acquire()```, which is woken instead.
+         */
+        Callback m_on_admitted;
+        bool m_is_admitted;
+    };
+
+private:
+    bool detail_fits(size_t bytes) const;
+    std::vector<Callback> detail_admit_waiters();
+    void detail_run_callbacks(std::vector<Callback> callbacks);
+
+private:
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget(MemoryBudget&&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(MemoryBudget&&) = delete;
+
+private:
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    size_t m_budget;
+    size_t m_in_use;
+    std::deque<std::shared_ptr<Waiter>> m_waiters;
+};
+
+} // namespace tg::core
@@ -0,0 +1,796 @@
+#include <algorithm>
+#include <iterator>
+#include "tg/core/plan.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/details/binding_resolver.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/data_info_tuple.hpp"
+
+namespace tg::core
+{
+
+PlanSlot::PlanSlot(std::string name, std::type_index type)
+    : m_name(std::move(name))
+    , m_type(type)
+    , m_aliases{}
+    , m_writer{}
+    , m_readers{}
+    , m_consumer{}
+{}
+
+PlanStep::PlanStep(StepPtr step)
+    : m_step(std::move(step))
+    , m_slots{}
+    , m_usages{}
+    , m_optional{}
+    , m_successors{}
+    , m_predecessors{}
+    , m_predecessor_count{0u}
+    , m_reduced_successors{}
+    , m_reduced_predecessor_count{0u}
+{}
+
+Plan::Plan(const Scope& scope)
+    : m_scopename{scope.scopename()}
+    , m_steps{}
+    , m_slots{}
+    , m_slot_by_name{}
+    , m_topo_order{}
+    , m_topo_pos{}
+    , m_free_slots{}
+    , m_live_step_count{0u}
+    , m_is_reduced{false}
+    , m_step_costs{}
+{
+    if (!scope.is_frozen())
+    {
+        throw std::invalid_argument("Plan::Plan(): Scope must be frozen before compiling.");
+    }
+    details::BindingResolver resolver(scope);
+    const auto& bindings = resolver.bindings();
+    for (const auto& binding : bindings)
+    {
+        m_steps.emplace_back(binding.m_step);
+        m_step_costs.emplace_back(-1);
+        for (const auto& data_info : binding.m_data_infos)
+        {
+            if (m_slot_by_name.find(data_info.m_shortname) == m_slot_by_name.end())
+            {
+                m_slot_by_name.emplace(data_info.m_shortname, m_slots.size());
+                m_slots.emplace_back(data_info.m_shortname, data_info.m_type);
+            }
+        }
+    }
+    for (const auto& [name, representative] : resolver.aliases())
+    {
+        const size_t slot_index = m_slot_by_name.at(representative);
+        m_slot_by_name.emplace(name, slot_index);
+        m_slots.at(slot_index).m_aliases.push_back(name);
+    }
+    for (size_t step_index = 0u; step_index < m_steps.size(); ++step_index)
+    {
+        this->detail_bind(step_index, bindings.at(step_index).m_data_infos);
+    }
+    m_live_step_count = m_steps.size();
+    this->detail_link();
+    this->detail_sort();
+    this->reduce_edges();
+}
+
+Plan::~Plan()
+{
+}
+
+const std::string& Plan::scopename() const
+{
+    return m_scopename;
+}
+
+size_t Plan::step_count() const
+{
+    return m_steps.size();
+}
+
+size_t Plan::live_step_count() const
+{
+    return m_live_step_count;
+}
+
+bool Plan::is_step_alive(size_t step_index) const
+{
+    return static_cast<bool>(m_steps.at(step_index).m_step);
+}
+
+size_t Plan::slot_count() const
+{
+    return m_slots.size();
+}
+
+const PlanStep& Plan::step_at(size_t step_index) const
+{
+    return m_steps.at(step_index);
+}
+
+const PlanSlot& Plan::slot_at(size_t slot_index) const
+{
+    return m_slots.at(slot_index);
+}
+
+std::optional<size_t> Plan::find_slot(std::string_view name) const
+{
+    auto iter = m_slot_by_name.find(std::string(name));
+    if (iter == m_slot_by_name.end())
+    {
+        return std::nullopt;
+    }
+    return iter->second;
+}
+
+const std::vector<size_t>& Plan::topo_order() const
+{
+    return m_topo_order;
+}
+
+std::vector<size_t> Plan::global_inputs() const
+{
+    std::vector<size_t> result;
+    for (size_t slot_index = 0u; slot_index < m_slots.size(); ++slot_index)
+    {
+        const auto& slot = m_slots.at(slot_index);
+        if (!slot.m_writer.has_value() && (!slot.m_readers.empty() || slot.m_consumer.has_value()))
+        {
+            result.push_back(slot_index);
+        }
+    }
+    return result;
+}
+
+std::vector<size_t> Plan::global_outputs() const
+{
+    std::vector<size_t> result;
+    for (size_t slot_index = 0u; slot_index < m_slots.size(); ++slot_index)
+    {
+        const auto& slot = m_slots.at(slot_index);
+        if (slot.m_writer.has_value() && !slot.m_consumer.has_value())
+        {
+            result.push_back(slot_index);
+        }
+    }
+    return result;
+}
+
+bool Plan::is_reduced() const
+{
+    return m_is_reduced;
+}
+
+const std::vector<size_t>& Plan::exec_successors(size_t step_index) const
+{
+    const PlanStep& plan_step = m_steps.at(step_index);
+    return m_is_reduced ? plan_step.m_reduced_successors : plan_step.m_successors;
+}
+
+size_t Plan::exec_predecessor_count(size_t step_index) const
+{
+    const PlanStep& plan_step = m_steps.at(step_index);
+    return m_is_reduced ? plan_step.m_reduced_predecessor_count : plan_step.m_predecessor_count;
+}
+
+void Plan::reduce_edges()
+{
+    const size_t step_count = m_steps.size();
+    std::vector<size_t> marks(step_count, 0u);
+    size_t epoch = 0u;
+    std::vector<size_t> by_pos;
+    std::vector<size_t> stack;
+    for (auto& plan_step : m_steps)
+    {
+        plan_step.m_reduced_successors.clear();
+        plan_step.m_reduced_predecessor_count = 0u;
+    }
+    for (size_t from : m_topo_order)
+    {
+        PlanStep& plan_step = m_steps.at(from);
+        if (plan_step.m_successors.size() < 2u)
+        {
+            plan_step.m_reduced_successors = plan_step.m_successors;
+            continue;
+        }
+        by_pos = plan_step.m_successors;
+        std::sort(by_pos.begin(), by_pos.end(), [this](size_t lhs, size_t rhs) {
+            return m_topo_pos.at(lhs) < m_topo_pos.at(rhs);
+        });
+        const size_t limit = m_topo_pos.at(by_pos.back());
+        ++epoch;
+        /**
+         * @note A successor reachable through another successor comes later
+         * in the topological order, so visiting them by position finds it
+         * already marked. Nothing beyond the last successor can matter.
+         */
+        for (size_t to : by_pos)
+        {
+            if (marks.at(to) == epoch)
+            {
+                continue;
+            }
+            plan_step.m_reduced_successors.push_back(to);
+            stack.push_back(to);
+            while (!stack.empty())
+            {
+                const size_t visit = stack.back();
+                stack.pop_back();
+                for (size_t next : m_steps.at(visit).m_successors)
+                {
+                    if (marks.at(next) != epoch && m_topo_pos.at(next) <= limit)
+                    {
+                        marks.at(next) = epoch;
+                        stack.push_back(next);
+                    }
+                }
+            }
+        }
+        std::sort(plan_step.m_reduced_successors.begin(), plan_step.m_reduced_successors.end());
+    }
+    for (const auto& plan_step : m_steps)
+    {
+        for (size_t to : plan_step.m_reduced_successors)
+        {
+            ++m_steps.at(to).m_reduced_predecessor_count;
+        }
+    }
+    m_is_reduced = true;
+}
+
+void Plan::record_cost(size_t step_index, std::chrono::nanoseconds elapsed) const
+{
+    /**
+     * @note Concurrent runs may overwrite each other's update; the average
+     * is only a scheduling hint, so relaxed accesses are enough.
+     */
+    auto& cost = m_step_costs.at(step_index);
+    const int64_t sample = static_cast<int64_t>(elapsed.count());
+    const int64_t old = cost.load(std::memory_order_relaxed);
+    cost.store((old < 0) ? sample : (old * 3 + sample) / 4, std::memory_order_relaxed);
+}
+
+std::optional<std::chrono::nanoseconds> Plan::estimated_cost(size_t step_index) const
+{
+    const int64_t cost = m_step_costs.at(step_index).load(std::memory_order_relaxed);
+    if (cost < 0)
+    {
+        return std::nullopt;
+    }
+    return std::chrono::nanoseconds(cost);
+}
+
+size_t Plan::add_step(StepPtr step)
+{
+    if (!step)
+    {
+        throw std::invalid_argument("Plan::add_step(): step cannot be null.");
+    }
+    std::vector<DataInfoTuple> data_infos;
+    step->info().get_data_infos(data_infos);
+    const size_t step_index = m_steps.size();
+    const bool was_reduced = m_is_reduced;
+    // Check everything before the first change.
+    std::vector<size_t> existing_slots;
+    for (const auto& data_info : data_infos)
+    {
+        auto iter = m_slot_by_name.find(data_info.m_shortname);
+        if (iter != m_slot_by_name.end())
+        {
+            this->detail_check_item(step_index, iter->second, data_info);
+            existing_slots.push_back(iter->second);
+        }
+    }
+    std::sort(existing_slots.begin(), existing_slots.end());
+    if (std::adjacent_find(existing_slots.begin(), existing_slots.end()) != existing_slots.end())
+    {
+        throw std::runtime_error(
+            "Plan::add_step(): " + step->info().shortname() + ": two data items alias the same slot."
+        );
+    }
+    PlanStep& plan_step = m_steps.emplace_back(std::move(step));
+    m_step_costs.emplace_back(-1);
+    for (const auto& data_info : data_infos)
+    {
+        const size_t slot_index = this->detail_acquire_slot(data_info.m_shortname, data_info.m_type);
+        this->detail_attach(step_index, slot_index, data_info.m_usage);
+        plan_step.m_slots.push_back(slot_index);
+        plan_step.m_usages.push_back(data_info.m_usage);
+        plan_step.m_optional.push_back(data_info.m_optional);
+    }
+    ++m_live_step_count;
+    this->detail_relink(step_index);
+    // Start right after the last predecessor, so that reordering is rarely needed.
+    size_t pos = 0u;
+    for (size_t from : m_steps.at(step_index).m_predecessors)
+    {
+        pos = std::max(pos, m_topo_pos.at(from) + 1u);
+    }
+    m_topo_pos.push_back(pos);
+    m_topo_order.insert(m_topo_order.begin() + static_cast<std::ptrdiff_t>(pos), step_index);
+    for (size_t later = pos + 1u; later < m_topo_order.size(); ++later)
+    {
+        m_topo_pos.at(m_topo_order.at(later)) = later;
+    }
+    if (!this->detail_reorder(step_index))
+    {
+        const std::string step_name = m_steps.at(step_index).m_step->info().shortname();
+        this->remove_step(step_index);
+        m_steps.pop_back();
+        m_step_costs.pop_back();
+        m_topo_pos.pop_back();
+        // The reduced edges of the other Steps were never touched.
+        m_is_reduced = was_reduced;
+        throw std::runtime_error("Plan::add_step(): " + step_name + ": Step would close a cycle.");
+    }
+    return step_index;
+}
+
+void Plan::remove_step(size_t step_index)
+{
+    if (step_index >= m_steps.size() || !m_steps.at(step_index).m_step)
+    {
+        throw std::out_of_range("Plan::remove_step(): no such step.");
+    }
+    PlanStep& plan_step = m_steps.at(step_index);
+    const std::vector<size_t> slots = std::move(plan_step.m_slots);
+    const std::vector<DataUsage> usages = std::move(plan_step.m_usages);
+    plan_step.m_slots.clear();
+    plan_step.m_usages.clear();
+    plan_step.m_optional.clear();
+    for (size_t k = 0u; k < slots.size(); ++k)
+    {
+        this->detail_detach(step_index, slots.at(k), usages.at(k));
+    }
+    this->detail_relink(step_index);
+    for (size_t slot_index : slots)
+    {
+        this->detail_release_slot_if_unused(slot_index);
+    }
+    plan_step.m_step.reset();
+    --m_live_step_count;
+    const size_t pos = m_topo_pos.at(step_index);
+    m_topo_order.erase(m_topo_order.begin() + static_cast<std::ptrdiff_t>(pos));
+    for (size_t later = pos; later < m_topo_order.size(); ++later)
+    {
+        m_topo_pos.at(m_topo_order.at(later)) = later;
+    }
+}
+
+void Plan::rewire(size_t step_index, std::string_view data_shortname, std::string_view slot_name)
+{
+    if (step_index >= m_steps.size() || !m_steps.at(step_index).m_step)
+    {
+        throw std::out_of_range("Plan::rewire(): no such step.");
+    }
+    PlanStep& plan_step = m_steps.at(step_index);
+    const StepInfo& step_info = plan_step.m_step->info();
+    auto local_opt = step_info.find_data(data_shortname);
+    if (!local_opt.has_value())
+    {
+        throw std::invalid_argument(
+            "Plan::rewire(): " + step_info.shortname() + ": Data " + std::string(data_shortname) + " not found."
+        );
+    }
+    const size_t k = local_opt.value();
+    const DataInfoTuple data_info = step_info.get_data_info(k);
+    const size_t old_slot = plan_step.m_slots.at(k);
+    const std::string name(slot_name);
+    auto iter = m_slot_by_name.find(name);
+    if (iter != m_slot_by_name.end())
+    {
+        if (iter->second == old_slot)
+        {
+            return;
+        }
+        for (size_t j = 0u; j < plan_step.m_slots.size(); ++j)
+        {
+            if (j != k && plan_step.m_slots.at(j) == iter->second)
+            {
+                throw std::runtime_error(
+                    "Plan::rewire(): " + step_info.shortname() + ": two data items alias the same slot."
+                );
+            }
+        }
+        this->detail_check_item(step_index, iter->second, data_info);
+    }
+    const bool was_reduced = m_is_reduced;
+    const size_t new_slot = this->detail_acquire_slot(name, data_info.m_type);
+    this->detail_attach(step_index, new_slot, data_info.m_usage);
+    this->detail_detach(step_index, old_slot, data_info.m_usage);
+    plan_step.m_slots.at(k) = new_slot;
+    this->detail_relink(step_index);
+    if (!this->detail_reorder(step_index))
+    {
+        // Restore; the previous order is still valid for the old binding.
+        this->detail_attach(step_index, old_slot, data_info.m_usage);
+        this->detail_detach(step_index, new_slot, data_info.m_usage);
+        plan_step.m_slots.at(k) = old_slot;
+        this->detail_relink(step_index);
+        this->detail_reorder(step_index);
+        this->detail_release_slot_if_unused(new_slot);
+        m_is_reduced = was_reduced;
+        throw std::runtime_error(
+            "Plan::rewire(): " + step_info.shortname() + ": Data " + data_info.m_shortname +
+            " bound to " + name + " would close a cycle."
+        );
+    }
+    this->detail_release_slot_if_unused(old_slot);
+}
+
+void Plan::detail_bind(size_t step_index, const std::vector<DataInfoTuple>& data_infos)
+{
+    PlanStep& plan_step = m_steps.at(step_index);
+    for (const auto& data_info : data_infos)
+    {
+        const size_t slot_index = m_slot_by_name.at(data_info.m_shortname);
+        this->detail_check_item(step_index, slot_index, data_info);
+        this->detail_attach(step_index, slot_index, data_info.m_usage);
+        plan_step.m_slots.push_back(slot_index);
+        plan_step.m_usages.push_back(data_info.m_usage);
+        plan_step.m_optional.push_back(data_info.m_optional);
+    }
+}
+
+void Plan::detail_check_item(size_t step_index, size_t slot_index, const DataInfoTuple& data_info) const
+{
+    const PlanSlot& slot = m_slots.at(slot_index);
+    const std::string& step_name = m_steps.size() > step_index && m_steps.at(step_index).m_step
+        ? m_steps.at(step_index).m_step->info().shortname()
+        : m_scopename;
+    if (slot.m_type != data_info.m_type)
+    {
+        throw std::runtime_error(
+            "Plan::detail_bind(): " + step_name + ": Data " + data_info.m_shortname +
+            " has type mismatch. Expected: " + std::string(slot.m_type.name()) +
+            ", Actual: " + std::string(data_info.m_type.name())
+        );
+    }
+    if (data_info.m_usage == DataUsage::Write && slot.m_writer.has_value())
+    {
+        throw std::runtime_error(
+            "Plan::detail_bind(): " + step_name + ": Data " + data_info.m_shortname +
+            " already has a writer."
+        );
+    }
+    if (data_info.m_usage == DataUsage::Consume && slot.m_consumer.has_value())
+    {
+        throw std::runtime_error(
+            "Plan::detail_bind(): " + step_name + ": Data " + data_info.m_shortname +
+            " already has a consumer."
+        );
+    }
+}
+
+void Plan::detail_attach(size_t step_index, size_t slot_index, DataUsage usage)
+{
+    PlanSlot& slot = m_slots.at(slot_index);
+    switch (usage)
+    {
+    case DataUsage::Read:
+        slot.m_readers.push_back(step_index);
+        break;
+    case DataUsage::Write:
+        slot.m_writer = step_index;
+        break;
+    case DataUsage::Consume:
+        slot.m_consumer = step_index;
+        break;
+    }
+}
+
+void Plan::detail_detach(size_t step_index, size_t slot_index, DataUsage usage)
+{
+    PlanSlot& slot = m_slots.at(slot_index);
+    switch (usage)
+    {
+    case DataUsage::Read:
+        slot.m_readers.erase(std::find(slot.m_readers.begin(), slot.m_readers.end(), step_index));
+        break;
+    case DataUsage::Write:
+        slot.m_writer.reset();
+        break;
+    case DataUsage::Consume:
+        slot.m_consumer.reset();
+        break;
+    }
+}
+
+size_t Plan::detail_acquire_slot(const std::string& name, std::type_index type)
+{
+    auto iter = m_slot_by_name.find(name);
+    if (iter != m_slot_by_name.end())
+    {
+        return iter->second;
+    }
+    size_t slot_index;
+    if (!m_free_slots.empty())
+    {
+        slot_index = m_free_slots.back();
+        m_free_slots.pop_back();
+        m_slots.at(slot_index) = PlanSlot(name, type);
+    }
+    else
+    {
+        slot_index = m_slots.size();
+        m_slots.emplace_back(name, type);
+    }
+    m_slots.at(slot_index).m_aliases.push_back(name);
+    m_slot_by_name.emplace(name, slot_index);
+    return slot_index;
+}
+
+void Plan::detail_release_slot_if_unused(size_t slot_index)
+{
+    PlanSlot& slot = m_slots.at(slot_index);
+    if (slot.m_writer.has_value() || slot.m_consumer.has_value() || !slot.m_readers.empty())
+    {
+        return;
+    }
+    for (const auto& alias : slot.m_aliases)
+    {
+        m_slot_by_name.erase(alias);
+    }
+    slot.m_aliases.clear();
+    m_free_slots.push_back(slot_index);
+}
+
+void Plan::detail_relink(size_t step_index)
+{
+    m_is_reduced = false;
+    /**
+     * @note Edges are derived from slots, so a change in the binding of one
+     * Step only changes the edges incident to it.
+     */
+    PlanStep& plan_step = m_steps.at(step_index);
+    std::vector<size_t> succ;
+    std::vector<size_t> pred;
+    for (size_t k = 0u; k < plan_step.m_slots.size(); ++k)
+    {
+        const PlanSlot& slot = m_slots.at(plan_step.m_slots.at(k));
+        switch (plan_step.m_usages.at(k))
+        {
+        case DataUsage::Write:
+            succ.insert(succ.end(), slot.m_readers.begin(), slot.m_readers.end());
+            if (slot.m_consumer.has_value())
+            {
+                succ.push_back(slot.m_consumer.value());
+            }
+            break;
+        case DataUsage::Read:
+            if (slot.m_writer.has_value())
+            {
+                pred.push_back(slot.m_writer.value());
+            }
+            if (slot.m_consumer.has_value())
+            {
+                succ.push_back(slot.m_consumer.value());
+            }
+            break;
+        case DataUsage::Consume:
+            if (slot.m_writer.has_value())
+            {
+                pred.push_back(slot.m_writer.value());
+            }
+            pred.insert(pred.end(), slot.m_readers.begin(), slot.m_readers.end());
+            break;
+        }
+    }
+    auto normalize = [step_index](std::vector<size_t>& values) {
+        values.erase(std::remove(values.begin(), values.end(), step_index), values.end());
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+    };
+    normalize(succ);
+    normalize(pred);
+    auto insert_sorted = [](std::vector<size_t>& values, size_t value) {
+        values.insert(std::lower_bound(values.begin(), values.end(), value), value);
+    };
+    auto erase_sorted = [](std::vector<size_t>& values, size_t value) {
+        values.erase(std::lower_bound(values.begin(), values.end(), value));
+    };
+    std::vector<size_t> diff;
+    // Successors: update the predecessors of the other end.
+    diff.clear();
+    std::set_difference(plan_step.m_successors.begin(), plan_step.m_successors.end(), succ.begin(), succ.end(), std::back_inserter(diff));
+    for (size_t to : diff)
+    {
+        erase_sorted(m_steps.at(to).m_predecessors, step_index);
+        --m_steps.at(to).m_predecessor_count;
+    }
+    diff.clear();
+    std::set_difference(succ.begin(), succ.end(), plan_step.m_successors.begin(), plan_step.m_successors.end(), std::back_inserter(diff));
+    for (size_t to : diff)
+    {
+        insert_sorted(m_steps.at(to).m_predecessors, step_index);
+        ++m_steps.at(to).m_predecessor_count;
+    }
+    // Predecessors: update the successors of the other end.
+    diff.clear();
+    std::set_difference(plan_step.m_predecessors.begin(), plan_step.m_predecessors.end(), pred.begin(), pred.end(), std::back_inserter(diff));
+    for (size_t from : diff)
+    {
+        erase_sorted(m_steps.at(from).m_successors, step_index);
+    }
+    diff.clear();
+    std::set_difference(pred.begin(), pred.end(), plan_step.m_predecessors.begin(), plan_step.m_predecessors.end(), std::back_inserter(diff));
+    for (size_t from : diff)
+    {
+        insert_sorted(m_steps.at(from).m_successors, step_index);
+    }
+    plan_step.m_successors = std::move(succ);
+    plan_step.m_predecessors = std::move(pred);
+    plan_step.m_predecessor_count = plan_step.m_predecessors.size();
+}
+
+bool Plan::detail_reorder(size_t step_index)
+{
+    /**
+     * @note Apart from the edges incident to the edited Step, the order is
+     * valid. Hence only the range of positions from its first successor to
+     * its last predecessor can be out of order, and no edge enters or leaves
+     * that range in the wrong direction; Kahn's algorithm is run on the
+     * range alone, keeping the existing relative order where possible.
+     */
+    const PlanStep& plan_step = m_steps.at(step_index);
+    const size_t pos = m_topo_pos.at(step_index);
+    size_t lo = pos;
+    size_t hi = pos;
+    for (size_t from : plan_step.m_predecessors)
+    {
+        hi = std::max(hi, m_topo_pos.at(from));
+    }
+    for (size_t to : plan_step.m_successors)
+    {
+        lo = std::min(lo, m_topo_pos.at(to));
+    }
+    if (lo == pos && hi == pos)
+    {
+        return true;
+    }
+    lo = std::min(lo, pos);
+    hi = std::max(hi, pos);
+    auto in_range = [&](size_t other) {
+        const size_t other_pos = m_topo_pos.at(other);
+        return other_pos >= lo && other_pos <= hi;
+    };
+    const size_t range_size = hi - lo + 1u;
+    std::vector<size_t> pending(range_size, 0u);
+    for (size_t offset = 0u; offset < range_size; ++offset)
+    {
+        for (size_t from : m_steps.at(m_topo_order.at(lo + offset)).m_predecessors)
+        {
+            pending.at(offset) += in_range(from) ? 1u : 0u;
+        }
+    }
+    std::vector<size_t> order;
+    order.reserve(range_size);
+    std::vector<size_t> ready;
+    for (size_t offset = 0u; offset < range_size; ++offset)
+    {
+        if (pending.at(offset) == 0u)
+        {
+            ready.push_back(offset);
+        }
+    }
+    std::make_heap(ready.begin(), ready.end(), std::greater<size_t>{});
+    while (!ready.empty())
+    {
+        // Smallest old position first, to keep the existing relative order.
+        std::pop_heap(ready.begin(), ready.end(), std::greater<size_t>{});
+        const size_t offset = ready.back();
+        ready.pop_back();
+        const size_t from = m_topo_order.at(lo + offset);
+        order.push_back(from);
+        for (size_t to : m_steps.at(from).m_successors)
+        {
+            if (in_range(to))
+            {
+                const size_t to_offset = m_topo_pos.at(to) - lo;
+                if (--pending.at(to_offset) == 0u)
+                {
+                    ready.push_back(to_offset);
+                    std::push_heap(ready.begin(), ready.end(), std::greater<size_t>{});
+                }
+            }
+        }
+    }
+    if (order.size() != range_size)
+    {
+        return false;
+    }
+    for (size_t offset = 0u; offset < range_size; ++offset)
+    {
+        m_topo_order.at(lo + offset) = order.at(offset);
+        m_topo_pos.at(order.at(offset)) = lo + offset;
+    }
+    return true;
+}
+
+void Plan::detail_link()
+{
+    auto add_edge = [this](size_t from, size_t to) {
+        if (from != to)
+        {
+            m_steps.at(from).m_successors.push_back(to);
+        }
+    };
+    for (const auto& slot : m_slots)
+    {
+        if (slot.m_writer.has_value())
+        {
+            const size_t writer = slot.m_writer.value();
+            for (size_t reader : slot.m_readers)
+            {
+                add_edge(writer, reader);
+            }
+            if (slot.m_consumer.has_value())
+            {
+                add_edge(writer, slot.m_consumer.value());
+            }
+        }
+        if (slot.m_consumer.has_value())
+        {
+            for (size_t reader : slot.m_readers)
+            {
+                add_edge(reader, slot.m_consumer.value());
+            }
+        }
+    }
+    for (size_t from = 0u; from < m_steps.size(); ++from)
+    {
+        auto& succ = m_steps.at(from).m_successors;
+        std::sort(succ.begin(), succ.end());
+        succ.erase(std::unique(succ.begin(), succ.end()), succ.end());
+        for (size_t to : succ)
+        {
+            // Visited in increasing order of "from", hence sorted.
+            m_steps.at(to).m_predecessors.push_back(from);
+            ++m_steps.at(to).m_predecessor_count;
+        }
+    }
+}
+
+void Plan::detail_sort()
+{
+    // Kahn's algorithm.
+    const size_t step_count = m_steps.size();
+    std::vector<size_t> pending(step_count);
+    for (size_t step_index = 0u; step_index < step_count; ++step_index)
+    {
+        pending.at(step_index) = m_steps.at(step_index).m_predecessor_count;
+        if (pending.at(step_index) == 0u)
+        {
+            m_topo_order.push_back(step_index);
+        }
+    }
+    for (size_t visit = 0u; visit < m_topo_order.size(); ++visit)
+    {
+        const size_t from = m_topo_order.at(visit);
+        for (size_t to : m_steps.at(from).m_successors)
+        {
+            if (--pending.at(to) == 0u)
+            {
+                m_topo_order.push_back(to);
+            }
+        }
+    }
+    if (m_topo_order.size() != step_count)
+    {
+        throw std::runtime_error(
+            "Plan::detail_sort(): " + m_scopename +
+            ": Step dependencies contain a cycle."
+        );
+    }
+    m_topo_pos.assign(step_count, 0u);
+    for (size_t pos = 0u; pos < step_count; ++pos)
+    {
+        m_topo_pos.at(m_topo_order.at(pos)) = pos;
+    }
+}
+
+} // namespace tg::core
@@ -0,0 +1,297 @@
+#pragma once
+#include <chrono>
+#include <deque>
+#include "tg/core/fwd.hpp"
+
+namespace tg::core
+{
+
+/**
+ * @brief A data slot in the compiled Plan.
+ *
+ * @details Data items of different Steps in the same Scope that share the
+ * same short name, or whose names are connected by wires (see
+ * ```Scope::wire()```), are unified into one slot. At most one Step can
+ * write to a slot; a slot without a writer is a global input.
+ */
+struct PlanSlot
+{
+public:
+    /**
+     * @brief The representative name of the slot: its first wired name,
+     * if any, otherwise the name shared by its data items.
+     */
+    std::string m_name;
+    std::type_index m_type;
+
+    /**
+     * @brief All names unified into the slot, including ```m_name```.
+     */
+    std::vector<std::string> m_aliases;
+
+    std::optional<size_t> m_writer;
+    std::vector<size_t> m_readers;
+    std::optional<size_t> m_consumer;
+
+public:
+    PlanSlot(std::string name, std::type_index type);
+};
+
+/**
+ * @brief A Step in the compiled Plan, together with the binding of its
+ * data items to slots and its dependency edges.
+ */
+struct PlanStep
+{
+public:
+    StepPtr m_step;
+
+    /**
+     * @brief Maps the local data index of the Step to the slot index.
+     */
+    std::vector<size_t> m_slots;
+
+    /**
+     * @brief The usage of each data item, by local data index.
+     */
+    std::vector<DataUsage> m_usages;
+
+    /**
+     * @brief Whether each data item is optional, by local data index.
+     */
+    std::vector<bool> m_optional;
+
+    /**
+     * @brief Indices of Steps that can only start after this Step finished.
+     * @note Sorted and without duplicates.
+     */
+    std::vector<size_t> m_successors;
+
+    /**
+     * @brief Indices of Steps this Step waits for.
+     * @note Sorted and without duplicates.
+     */
+    std::vector<size_t> m_predecessors;
+
+    /**
+     * @brief Number of distinct Steps this Step waits for.
+     */
+    size_t m_predecessor_count;
+
+    /**
+     * @brief The successors that remain after transitive reduction: an edge
+     * is dropped when its target is also reached through another successor.
+     * @note Sorted and without duplicates; valid only while
+     * ```Plan::is_reduced()```.
+     */
+    std::vector<size_t> m_reduced_successors;
+
+    /**
+     * @brief Number of Steps this Step waits for after transitive reduction.
+     */
+    size_t m_reduced_predecessor_count;
+
+public:
+    explicit PlanStep(StepPtr step);
+};
+
+/**
+ * @brief The compiled form of a frozen Scope, ready for execution.
+ *
+ * @details The Plan unifies the data names of the Scope into equivalence
+ * classes (same name, or connected by wires), assigns each class to one
+ * slot, binds the data items of each Step to these slots, and derives the
+ * dependency edges between Steps:
+ * - the writer of a slot precedes all of its readers and its consumer;
+ * - all readers of a slot precede its consumer.
+ *
+ * A ScopeStep in ```ScopeStepMode::Inline``` is not itself a Step of the
+ * Plan; its inner Steps are bound in its place (see ScopeStep).
+ *
+ * The Executor only needs the transitive reduction of these edges: an
+ * ordering already implied by a longer path costs an atomic decrement per
+ * run but adds nothing. The reduction is computed at compile time; see
+ * ```reduce_edges()```.
+ *
+ * The Plan is shared by all executions. It can be edited in place with
+ * ```add_step()```, ```remove_step()``` and ```rewire()```: each edit
+ * re-binds only the data items of the edited Step, re-derives only its
+ * incident edges, and restores the topological order only within the
+ * range of positions spanned by those edges. Slots that lose all of their
+ * Steps are released and reused by later edits, so the slot array stays
+ * compact. A removed Step leaves a tombstone (a null ```m_step```); Step
+ * indices are stable.
+ *
+ * @note Edits must not overlap with executions of the Plan.
+ */
+class Plan
+{
+public:
+    /**
+     * @brief Compiles the Plan from a Scope.
+     * @exception std::invalid_argument if the Scope is not frozen.
+     * @exception std::runtime_error if the data of the Steps cannot be
+     * unified (type mismatch, multiple writers or consumers), or if the
+     * dependencies contain a cycle.
+     */
+    explicit Plan(const Scope& scope);
+    ~Plan();
+
+public:
+    /**
+     * @brief The name of the Scope the Plan was compiled from.
+     */
+    const std::string& scopename() const;
+
+    /**
+     * @brief The number of Step indices, including removed Steps.
+     */
+    size_t step_count() const;
+    size_t live_step_count() const;
+    bool is_step_alive(size_t step_index) const;
+    size_t slot_count() const;
+    const PlanStep& step_at(size_t step_index) const;
+    const PlanSlot& slot_at(size_t slot_index) const;
+
+    /**
+     * @brief Finds the slot index by data name, or by any of its aliases.
+     */
+    std::optional<size_t> find_slot(std::string_view name) const;
+
+    /**
+     * @brief Step indices sorted such that each Step comes after all of
+     * its predecessors.
+     */
+    const std::vector<size_t>& topo_order() const;
+
+    /**
+     * @brief Slots that no Step writes to; these must be provided by the
+     * caller before execution.
+     */
+    std::vector<size_t> global_inputs() const;
+
+    /**
+     * @brief Slots that are written but not consumed; these remain
+     * available after execution.
+     */
+    std::vector<size_t> global_outputs() const;
+
+    /**
+     * @brief Whether the reduced edges are up to date with the full edges.
+     */
+    bool is_reduced() const;
+
+    /**
+     * @brief The successors to signal when a Step finishes: the reduced
+     * edges if up to date, otherwise the full edges.
+     */
+    const std::vector<size_t>& exec_successors(size_t step_index) const;
+
+    /**
+     * @brief The number of signals a Step waits for, matching
+     * ```exec_successors()```.
+     */
+    size_t exec_predecessor_count(size_t step_index) const;
+
+    /**
+     * @brief Recomputes the transitive reduction of the dependency edges.
+     *
+     * @details For each Step with several successors, visited in
+     * topological order, a search from its successors (bounded by the
+     * position of the last one) marks the successors reachable by a longer
+     * path; their direct edges are dropped. The full edges are kept for
+     * editing and validation.
+     *
+     * @note Called by the constructor. Edits leave the reduction stale, and
+     * execution falls back to the full edges until this is called again;
+     * call it once after a batch of edits.
+     */
+    void reduce_edges();
+
+    /**
+     * @brief Records one measured execution time of a Step into its moving
+     * average.
+     * @note Called by the Executor; safe to call concurrently.
+     */
+    void record_cost(size_t step_index, std::chrono::nanoseconds elapsed) const;
+
+    /**
+     * @brief The moving average of the execution time of a Step, or nullopt
+     * if it has not been measured yet.
+     */
+    std::optional<std::chrono::nanoseconds> estimated_cost(size_t step_index) const;
+
+public:
+    /**
+     * @brief Adds a Step, bound to slots by the data names of its StepInfo
+     * (a name may be any alias of an existing slot; a new name gets a new
+     * slot).
+     * @returns The index of the new Step.
+     * @exception std::runtime_error on type mismatch, multiple writers or
+     * consumers, or if the Step would close a cycle; the Plan is unchanged.
+     * @note A ScopeStep added this way runs as a macro task.
+     */
+    size_t add_step(StepPtr step);
+
+    /**
+     * @brief Removes a Step; slots left without any Step are released.
+     * @exception std::out_of_range if there is no such Step.
+     */
+    void remove_step(size_t step_index);
+
+    /**
+     * @brief Binds one data item of a Step to another slot.
+     * @param step_index The Step.
+     * @param data_shortname The short name of the data item in the StepInfo.
+     * @param slot_name The name (or alias) of the slot; a new name gets a
+     * new slot.
+     * @exception std::runtime_error on type mismatch, multiple writers or
+     * consumers, if another data item of the Step is bound to the slot, or
+     * if the edit would close a cycle; the Plan is unchanged.
+     */
+    void rewire(size_t step_index, std::string_view data_shortname, std::string_view slot_name);
+
+private:
+    void detail_check_item(size_t step_index, size_t slot_index, const DataInfoTuple& data_info) const;
+    void detail_attach(size_t step_index, size_t slot_index, DataUsage usage);
+    void detail_detach(size_t step_index, size_t slot_index, DataUsage usage);
+    size_t detail_acquire_slot(const std::string& name, std::type_index type);
+    void detail_release_slot_if_unused(size_t slot_index);
+    void detail_relink(size_t step_index);
+    bool detail_reorder(size_t step_index);
+
+private:
+    void detail_bind(size_t step_index, const std::vector<DataInfoTuple>& data_infos);
+    void detail_link();
+    void detail_sort();
+
+private:
+    Plan(const Plan&) = delete;
+    Plan(Plan&&) = delete;
+    Plan& operator=(const Plan&) = delete;
+    Plan& operator=(Plan&&) = delete;
+
+private:
+    std::string m_scopename;
+    std::vector<PlanStep> m_steps;
+    std::vector<PlanSlot> m_slots;
+    std::unordered_map<std::string, size_t> m_slot_by_name;
+    std::vector<size_t> m_topo_order;
+
+    /**
+     * @brief Position of each live Step in the topological order.
+     */
+    std::vector<size_t> m_topo_pos;
+    std::vector<size_t> m_free_slots;
+    size_t m_live_step_count;
+    bool m_is_reduced;
+
+    /**
+     * @brief Moving average of the execution time of each Step, in
+     * nanoseconds, or -1 if unknown.
+     * @note A deque, so that it can grow with ```add_step()```.
+     */
+    mutable std::deque<std::atomic<int64_t>> m_step_costs;
+};
+
+} // namespace tg::core
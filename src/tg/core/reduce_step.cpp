@@ -0,0 +1,79 @@
+#include <algorithm>
+#include "tg/core/reduce_step.hpp"
+#include "tg/core/thread_pool.hpp"
+
+namespace tg::core
+{
+
+ReduceStep::ReduceStep(std::string_view shortname, std::string_view items_name, VarData identity, CombineFunc combine)
+    : Step{}
+    , m_identity{std::move(identity)}
+    , m_combine{std::move(combine)}
+{
+    this->info().set_shortname(shortname);
+    this->info().set_step_type<ReduceStep>();
+    this->info().add_data<Items>(items_name, DataUsage::Read);
+}
+
+ReduceStep::~ReduceStep()
+{
+}
+
+void ReduceStep::execute(std::vector<VarData>& data)
+{
+    this->pre_execute_validation(data);
+    const Items& items = data.at(0).as<Items>();
+    const size_t item_count = items.size();
+    ThreadPool* pool = ThreadPool::current();
+    if (item_count == 0u)
+    {
+        /**
+         * @note The identity value is shared by all runs; downstream Steps
+         * must not modify it in place.
+         */
+        data.at(1) = m_identity;
+    }
+    else if (!pool || item_count < 2u)
+    {
+        data.at(1) = this->detail_reduce_range(items, 0u, item_count);
+    }
+    else
+    {
+        // Leaf level: contiguous chunks, reduced concurrently.
+        const size_t chunk_count = std::min(item_count, pool->thread_count() * 4u);
+        std::vector<VarData> partials(chunk_count);
+        pool->parallel_for(chunk_count, [&](size_t chunk) {
+            const size_t begin = item_count * chunk / chunk_count;
+            const size_t end = item_count * (chunk + 1u) / chunk_count;
+            partials.at(chunk) = this->detail_reduce_range(items, begin, end);
+        });
+        // Upper levels: adjacent pairs, each level in parallel.
+        while (partials.size() > 1u)
+        {
+            const size_t pair_count = partials.size() / 2u;
+            std::vector<VarData> next(pair_count + (partials.size() % 2u));
+            pool->parallel_for(pair_count, [&](size_t pair) {
+                next.at(pair) = m_combine(partials.at(2u * pair), partials.at(2u * pair + 1u));
+            });
+            if (partials.size() % 2u)
+            {
+                next.back() = std::move(partials.back());
+            }
+            partials = std::move(next);
+        }
+        data.at(1) = std::move(partials.front());
+    }
+    this->post_execute_validation(data);
+}
+
+VarData ReduceStep::detail_reduce_range(const Items& items, size_t begin, size_t end) const
+{
+    VarData accum = items.at(begin);
+    for (size_t index = begin + 1u; index < end; ++index)
+    {
+        accum = m_combine(accum, items.at(index));
+    }
+    return accum;
+}
+
+} // namespace tg::core
@@ -0,0 +1,77 @@
+#pragma once
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+
+namespace tg::core
+{
+
+/**
+ * @brief A Step that merges a runtime-sized collection of partial results
+ * into one result with an associative combiner (dynamic fan-in).
+ *
+ * @details The input is an ```Items``` vector, typically collected by a
+ * MapStep. The reduction runs as a parallel tree on the ThreadPool the Step
+ * is executed on (see ```ThreadPool::current()```): the items are split into
+ * contiguous chunks reduced concurrently, then the partial results are
+ * combined pairwise, level by level, with each level in parallel.
+ *
+ * The combiner must be associative; it need not be commutative, since the
+ * left-to-right order of the items is preserved. An empty collection
+ * reduces to the identity value.
+ *
+ * @note Use ```create<T>()``` to construct.
+ */
+class ReduceStep
+    : public Step
+{
+public:
+    using Items = std::vector<VarData>;
+    using CombineFunc = std::function<VarData(const VarData& lhs, const VarData& rhs)>;
+
+public:
+    /**
+     * @brief Creates a ReduceStep with a typed combiner.
+     * @param shortname The name of the Step.
+     * @param items_name The name of the input ```Items``` data.
+     * @param result_name The name of the output data of type T.
+     * @param identity The result for an empty collection.
+     * @param combine The associative combiner.
+     */
+    template <typename T>
+    static std::shared_ptr<ReduceStep> create(
+        std::string_view shortname,
+        std::string_view items_name,
+        std::string_view result_name,
+        T identity,
+        std::function<T(const T&, const T&)> combine)
+    {
+        if (!combine)
+        {
+            throw std::invalid_argument("ReduceStep::create(): combiner cannot be empty.");
+        }
+        CombineFunc erased = [combine](const VarData& lhs, const VarData& rhs) -> VarData {
+            return std::make_shared<T>(combine(lhs.as<T>(), rhs.as<T>()));
+        };
+        VarData erased_identity = std::make_shared<T>(std::move(identity));
+        auto step = std::shared_ptr<ReduceStep>(new ReduceStep(
+            shortname, items_name, std::move(erased_identity), std::move(erased)
+        ));
+        step->info().add_data<T>(result_name, DataUsage::Write);
+        return step;
+    }
+
+    ~ReduceStep() override;
+
+    using Step::info;
+    void execute(std::vector<VarData>& data) override;
+
+private:
+    ReduceStep(std::string_view shortname, std::string_view items_name, VarData identity, CombineFunc combine);
+    VarData detail_reduce_range(const Items& items, size_t begin, size_t end) const;
+
+private:
+    VarData m_identity;
+    CombineFunc m_combine;
+};
+
+} // namespace tg::core
@@ -0,0 +1,246 @@
+#include <algorithm>
+#include "tg/core/resource_manager.hpp"
+
+namespace tg::core
+{
+
+bool ResourceDemand::is_empty() const
+{
+    if (m_scratch_bytes > 0u)
+    {
+        return false;
+    }
+    for (const auto& [name, count] : m_tokens)
+    {
+        if (count > 0u)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+ResourceManager::ResourceManager()
+    : m_mutex{}
+    , m_scratch_budget{unlimited}
+    , m_scratch_in_use{0u}
+    , m_tokens{}
+    , m_waiters{}
+{
+}
+
+ResourceManager::~ResourceManager()
+{
+}
+
+void ResourceManager::set_scratch_budget(size_t bytes)
+{
+    std::vector<Callback> admitted;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& waiter : m_waiters)
+        {
+            if (waiter.m_demand.m_scratch_bytes > bytes)
+            {
+                throw std::invalid_argument("ResourceManager::set_scratch_budget(): a queued demand exceeds the new budget.");
+            }
+        }
+        m_scratch_budget = bytes;
+        admitted = this->detail_admit_waiters();
+    }
+    for (auto& on_admitted : admitted)
+    {
+        on_admitted();
+    }
+}
+
+size_t ResourceManager::scratch_budget() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_scratch_budget;
+}
+
+size_t ResourceManager::scratch_in_use() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_scratch_in_use;
+}
+
+void ResourceManager::set_token_count(const std::string& name, size_t count)
+{
+    std::vector<Callback> admitted;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& waiter : m_waiters)
+        {
+            for (const auto& [token_name, token_count] : waiter.m_demand.m_tokens)
+            {
+                if (token_name == name && token_count > count)
+                {
+                    throw std::invalid_argument("ResourceManager::set_token_count(): a queued demand for " + name + " exceeds the new count.");
+                }
+            }
+        }
+        m_tokens.try_emplace(name, TokenPool{unlimited, 0u}).first->second.m_count = count;
+        admitted = this->detail_admit_waiters();
+    }
+    for (auto& on_admitted : admitted)
+    {
+        on_admitted();
+    }
+}
+
+size_t ResourceManager::tokens_in_use(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto iter = m_tokens.find(name);
+    return (iter != m_tokens.end()) ? iter->second.m_in_use : 0u;
+}
+
+size_t ResourceManager::waiting_count() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_waiters.size();
+}
+
+bool ResourceManager::try_acquire(const ResourceDemand& demand)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    this->detail_check_capacity(demand);
+    // Queued demands go first, as in detail_admit_waiters().
+    if (!m_waiters.empty() || !this->detail_fits(demand))
+    {
+        return false;
+    }
+    this->detail_take(demand);
+    return true;
+}
+
+bool ResourceManager::acquire_or_wait(const ResourceDemand& demand, Callback on_admitted, const void* p_owner, size_t key)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    this->detail_check_capacity(demand);
+    if (m_waiters.empty() && this->detail_fits(demand))
+    {
+        this->detail_take(demand);
+        return true;
+    }
+    m_waiters.push_back(Waiter{demand, std::move(on_admitted), p_owner, key});
+    return false;
+}
+
+std::vector<size_t> ResourceManager::withdraw(const void* p_owner)
+{
+    if (!p_owner)
+    {
+        throw std::invalid_argument("ResourceManager::withdraw(): owner cannot be null.");
+    }
+    std::vector<size_t> keys;
+    std::vector<Callback> dropped;
+    std::vector<Callback> admitted;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto iter = m_waiters.begin(); iter != m_waiters.end();)
+        {
+            if (iter->m_p_owner == p_owner)
+            {
+                keys.push_back(iter->m_key);
+                dropped.push_back(std::move(iter->m_on_admitted));
+                iter = m_waiters.erase(iter);
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+        // A removed demand may have been the one holding the queue back.
+        admitted = this->detail_admit_waiters();
+    }
+    // Destroyed outside the lock; they may own what the caller releases next.
+    dropped.clear();
+    for (auto& on_admitted : admitted)
+    {
+        on_admitted();
+    }
+    return keys;
+}
+
+void ResourceManager::release(const ResourceDemand& demand)
+{
+    std::vector<Callback> admitted;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_scratch_in_use -= demand.m_scratch_bytes;
+        for (const auto& [name, count] : demand.m_tokens)
+        {
+            auto iter = m_tokens.find(name);
+            if (iter != m_tokens.end())
+            {
+                iter->second.m_in_use -= count;
+            }
+        }
+        admitted = this->detail_admit_waiters();
+    }
+    for (auto& on_admitted : admitted)
+    {
+        on_admitted();
+    }
+}
+
+void ResourceManager::detail_check_capacity(const ResourceDemand& demand) const
+{
+    if (demand.m_scratch_bytes > m_scratch_budget)
+    {
+        throw std::invalid_argument("ResourceManager::acquire(): scratch demand exceeds the budget.");
+    }
+    for (const auto& [name, count] : demand.m_tokens)
+    {
+        auto iter = m_tokens.find(name);
+        if (iter != m_tokens.end() && count > iter->second.m_count)
+        {
+            throw std::invalid_argument("ResourceManager::acquire(): demand for " + name + " exceeds its count.");
+        }
+    }
+}
+
+bool ResourceManager::detail_fits(const ResourceDemand& demand) const
+{
+    if (demand.m_scratch_bytes > m_scratch_budget - std::min(m_scratch_budget, m_scratch_in_use))
+    {
+        return false;
+    }
+    for (const auto& [name, count] : demand.m_tokens)
+    {
+        auto iter = m_tokens.find(name);
+        if (iter != m_tokens.end() && count > iter->second.m_count - std::min(iter->second.m_count, iter->second.m_in_use))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ResourceManager::detail_take(const ResourceDemand& demand)
+{
+    m_scratch_in_use += demand.m_scratch_bytes;
+    for (const auto& [name, count] : demand.m_tokens)
+    {
+        // Tracked even if not limited yet, so that a later limit sees them.
+        m_tokens.try_emplace(name, TokenPool{unlimited, 0u}).first->second.m_in_use += count;
+    }
+}
+
+std::vector<ResourceManager::Callback> ResourceManager::detail_admit_waiters()
+{
+    std::vector<Callback> admitted;
+    // Strictly in arrival order; the first demand that does not fit stops the rest.
+    while (!m_waiters.empty() && this->detail_fits(m_waiters.front().m_demand))
+    {
+        this->detail_take(m_waiters.front().m_demand);
+        admitted.push_back(std::move(m_waiters.front().m_on_admitted));
+        m_waiters.pop_front();
+    }
+    return admitted;
+}
+
+} // namespace tg::core
@@ -0,0 +1,146 @@
+#pragma once
+#include <deque>
+#include "tg/core/fwd.hpp"
+
+namespace tg::core
+{
+
+/**
+ * @brief The resources a Step holds while it executes (see
+ * ```Step::resource_demand()```).
+ */
+struct ResourceDemand
+{
+    /**
+     * @brief Bytes of scratch memory, counted against the scratch budget.
+     */
+    size_t m_scratch_bytes;
+
+    /**
+     * @brief Named tokens and how many of each, e.g. ```{"ccl-slot", 1}```.
+     */
+    std::vector<std::pair<std::string, size_t>> m_tokens;
+
+public:
+    bool is_empty() const;
+};
+
+/**
+ * @brief Tracks the resources available to the Steps of one or more
+ * Executors: a scratch memory budget, and counted named tokens.
+ *
+ * @details An Executor with a ResourceManager (see
+ * ```Executor::set_resource_manager()```) admits a Step only once its
+ * demand fits; until then, the Step waits in a queue without holding a
+ * worker, while other ready Steps keep running. Thus a few memory-heavy
+ * Step types can be limited without lowering the parallelism of the rest.
+ *
+ * Waiting demands are admitted strictly in arrival order whenever
+ * resources are released, as MemoryBudget admits runs: a demand that does
+ * not fit yet holds back those queued after it, so that a large demand is
+ * never starved by a stream of small ones. For the same reason, a new
+ * demand is not acquired at once while others are queued. A token name
+ * that was never configured is not limited; the scratch budget is
+ * unlimited by default.
+ *
+ * @note Thread-safe; may be shared by several Executors.
+ */
+class ResourceManager
+{
+public:
+    using Callback = std::function<void()>;
+    static constexpr size_t unlimited = ~static_cast<size_t>(0u);
+
+public:
+    ResourceManager();
+    ~ResourceManager();
+
+public:
+    /**
+     * @brief Sets the scratch budget; lowering it below the bytes in use
+     * delays new demands until enough are released.
+     * @exception std::invalid_argument if a queued demand would no longer
+     * fit at all; the budget is then unchanged.
+     */
+    void set_scratch_budget(size_t bytes);
+    size_t scratch_budget() const;
+    size_t scratch_in_use() const;
+
+    /**
+     * @brief Limits the named token to the given count.
+     * @exception std::invalid_argument if a queued demand would no longer
+     * fit at all; the count is then unchanged.
+     */
+    void set_token_count(const std::string& name, size_t count);
+    size_t tokens_in_use(const std::string& name) const;
+
+    /**
+     * @brief The number of demands queued by ```acquire_or_wait()```.
+     */
+    size_t waiting_count() const;
+
+public:
+    /**
+     * @brief Acquires the demand if it fits now and no other demand is
+     * queued.
+     * @exception std::invalid_argument if the demand can never fit.
+     */
+    bool try_acquire(const ResourceDemand& demand);
+
+    /**
+     * @brief Acquires the demand if it fits now; otherwise queues it, and
+     * calls ```on_admitted``` once it has been acquired on its behalf.
+     * @returns True if acquired now; the callback is then not called.
+     * @exception std::invalid_argument if the demand can never fit.
+     * @param p_owner, key Identify the waiter to ```withdraw()```.
+     * @note The callback runs on the thread that releases the resources,
+     * and should only hand the work over (e.g. submit a task).
+     */
+    bool acquire_or_wait(const ResourceDemand& demand, Callback on_admitted, const void* p_owner = nullptr, size_t key = 0u);
+
+    /**
+     * @brief Removes the queued demands of the owner, e.g. of a stopped
+     * run; their callbacks are dropped without being called. The demands
+     * they held back are then admitted if they fit, as on a release.
+     * @returns The keys of the removed demands, in arrival order.
+     */
+    std::vector<size_t> withdraw(const void* p_owner);
+
+    void release(const ResourceDemand& demand);
+
+private:
+    struct TokenPool
+    {
+        size_t m_count;
+        size_t m_in_use;
+    };
+
+    struct Waiter
+    {
+        ResourceDemand m_demand;
+        Callback m_on_admitted;
+        const void* m_p_owner;
+        size_t m_key;
+    };
+
+private:
+    void detail_check_capacity(const ResourceDemand& demand) const;
+    bool detail_fits(const ResourceDemand& demand) const;
+    void detail_take(const ResourceDemand& demand);
+    std::vector<Callback> detail_admit_waiters();
+
+private:
+    ResourceManager(const ResourceManager&) = delete;
+    ResourceManager(ResourceManager&&) = delete;
+    ResourceManager& operator=(const ResourceManager&) = delete;
+    ResourceManager& operator=(ResourceManager&&) = delete;
+
+private:
+    mutable std::mutex m_mutex;
+    size_t m_scratch_budget;
+    size_t m_scratch_in_use;
+    std::unordered_map<std::string, TokenPool> m_tokens;
+    std::deque<Waiter> m_waiters;
+};
+
+} // namespace tg::core
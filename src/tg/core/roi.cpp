@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <utility>
+#include "tg/core/roi.hpp"
+
+namespace tg::core
+{
+
+RoiRect::RoiRect()
+    : m_x(0)
+    , m_y(0)
+    , m_width(0)
+    , m_height(0)
+{}
+
+RoiRect::RoiRect(int x, int y, int width, int height)
+    : m_x(x)
+    , m_y(y)
+    , m_width(width)
+    , m_height(height)
+{}
+
+RoiRect RoiRect::full()
+{
+    return RoiRect{0, 0, INT_MAX, INT_MAX};
+}
+
+bool RoiRect::is_full() const
+{
+    return *this == RoiRect::full();
+}
+
+bool RoiRect::is_empty() const
+{
+    return m_width <= 0 || m_height <= 0;
+}
+
+bool RoiRect::operator==(const RoiRect& other) const
+{
+    return m_x == other.m_x &&
+        m_y == other.m_y &&
+        m_width == other.m_width &&
+        m_height == other.m_height;
+}
+
+bool RoiRect::operator!=(const RoiRect& other) const
+{
+    return !(*this == other);
+}
+
+RoiRect RoiRect::unite(const RoiRect& other) const
+{
+    if (this->is_full() || other.is_full())
+    {
+        return RoiRect::full();
+    }
+    if (other.is_empty())
+    {
+        return *this;
+    }
+    if (this->is_empty())
+    {
+        return other;
+    }
+    // Computed in 64-bit to avoid overflow near INT_MAX.
+    const long long x0 = std::min(m_x, other.m_x);
+    const long long y0 = std::min(m_y, other.m_y);
+    const long long x1 = std::max(
+        static_cast<long long>(m_x) + m_width,
+        static_cast<long long>(other.m_x) + other.m_width);
+    const long long y1 = std::max(
+        static_cast<long long>(m_y) + m_height,
+        static_cast<long long>(other.m_y) + other.m_height);
+    return RoiRect{
+        static_cast<int>(x0),
+        static_cast<int>(y0),
+        static_cast<int>(std::min<long long>(INT_MAX, x1 - x0)),
+        static_cast<int>(std::min<long long>(INT_MAX, y1 - y0))
+    };
+}
+
+RoiRect RoiRect::intersect(const RoiRect& other) const
+{
+    if (this->is_empty() || other.is_empty())
+    {
+        return RoiRect{};
+    }
+    const long long x0 = std::max(m_x, other.m_x);
+    const long long y0 = std::max(m_y, other.m_y);
+    const long long x1 = std::min(
+        static_cast<long long>(m_x) + m_width,
+        static_cast<long long>(other.m_x) + other.m_width);
+    const long long y1 = std::min(
+        static_cast<long long>(m_y) + m_height,
+        static_cast<long long>(other.m_y) + other.m_height);
+    if (x1 <= x0 || y1 <= y0)
+    {
+        return RoiRect{};
+    }
+    return RoiRect{
+        static_cast<int>(x0),
+        static_cast<int>(y0),
+        static_cast<int>(std::min<long long>(INT_MAX, x1 - x0)),
+        static_cast<int>(std::min<long long>(INT_MAX, y1 - y0))
+    };
+}
+
+RoiRect RoiRect::grow(int margin_x, int margin_y) const
+{
+    if (this->is_full() || this->is_empty())
+    {
+        return *this;
+    }
+    const long long x0 = std::max<long long>(0, static_cast<long long>(m_x) - margin_x);
+    const long long y0 = std::max<long long>(0, static_cast<long long>(m_y) - margin_y);
+    const long long x1 = static_cast<long long>(m_x) + m_width + margin_x;
+    const long long y1 = static_cast<long long>(m_y) + m_height + margin_y;
+    return RoiRect{
+        static_cast<int>(x0),
+        static_cast<int>(y0),
+        static_cast<int>(std::min<long long>(INT_MAX, x1 - x0)),
+        static_cast<int>(std::min<long long>(INT_MAX, y1 - y0))
+    };
+}
+
+RoiHalo::RoiHalo()
+    : m_x(0)
+    , m_y(0)
+    , m_whole(true)
+{}
+
+RoiHalo::RoiHalo(int x, int y)
+    : m_x(x)
+    , m_y(y)
+    , m_whole(false)
+{}
+
+RoiHalo RoiHalo::whole()
+{
+    return RoiHalo{};
+}
+
+bool RoiHalo::is_whole() const
+{
+    return m_whole;
+}
+
+StepRoi::StepRoi()
+    : m_output(RoiRect::full())
+    , m_data_rects{}
+{}
+
+StepRoi::StepRoi(RoiRect output, std::vector<RoiRect> data_rects)
+    : m_output(output)
+    , m_data_rects(std::move(data_rects))
+{}
+
+} // namespace tg::core
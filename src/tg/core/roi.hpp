@@ -0,0 +1,111 @@
+#pragma once
+#include <climits>
+#include <cstddef>
+#include <vector>
+
+namespace tg::core
+{
+
+/**
+ * @brief An axis-aligned rectangle in the global (image) coordinates
+ * of the task graph, used for region-of-interest demand propagation.
+ *
+ * @details The core library does not depend on OpenCV, therefore this
+ * is a plain value type. A rectangle with non-positive width or height
+ * is empty. The special value returned by ```full()``` stands for the
+ * whole extent of the data, which is not known until execution.
+ */
+struct RoiRect
+{
+public:
+    int m_x;
+    int m_y;
+    int m_width;
+    int m_height;
+
+public:
+    RoiRect();
+    RoiRect(int x, int y, int width, int height);
+
+    /**
+     * @brief The rectangle that stands for the whole extent of the data.
+     * @note Its origin is (0, 0).
+     */
+    static RoiRect full();
+
+    bool is_full() const;
+    bool is_empty() const;
+    bool operator==(const RoiRect& other) const;
+    bool operator!=(const RoiRect& other) const;
+
+    /**
+     * @brief Returns the bounding box of both rectangles.
+     * @note Empty rectangles are ignored; the full rectangle absorbs all.
+     */
+    RoiRect unite(const RoiRect& other) const;
+
+    /**
+     * @brief Returns the overlapping part of both rectangles, or an
+     * empty rectangle if they do not overlap.
+     */
+    RoiRect intersect(const RoiRect& other) const;
+
+    /**
+     * @brief Grows the rectangle by the given margins on each side, then
+     * clips the origin so that it does not become negative.
+     * @note The full rectangle stays full; an empty rectangle stays empty.
+     */
+    RoiRect grow(int margin_x, int margin_y) const;
+};
+
+/**
+ * @brief The neighborhood that a Step reads around each output pixel.
+ *
+ * @details A Step whose output at (x, y) depends only on its inputs within
+ * ```[x - m_x, x + m_x] * [y - m_y, y + m_y]``` declares that halo, and
+ * is then able to compute any sub-rectangle of its output.
+ *
+ * The default halo is "whole", which means the Step needs the whole
+ * extent of its inputs (e.g. connected components, global statistics),
+ * and always computes the whole extent of its outputs.
+ */
+struct RoiHalo
+{
+public:
+    int m_x;
+    int m_y;
+    bool m_whole;
+
+public:
+    /**
+     * @brief Default constructs a whole-input halo.
+     */
+    RoiHalo();
+    RoiHalo(int x, int y);
+
+    static RoiHalo whole();
+    bool is_whole() const;
+};
+
+/**
+ * @brief The region-of-interest information given to a Step for one
+ * execution.
+ *
+ * @details ```m_output``` is the region the Step is required to produce,
+ * in global coordinates. ```m_data_rects``` has one entry per data item
+ * of the Step (same order as StepInfo), giving the global region covered
+ * by the buffer of that data item. Only the origin of these rectangles is
+ * meaningful for inputs; their actual extent is that of the buffer.
+ */
+struct StepRoi
+{
+public:
+    RoiRect m_output;
+    std::vector<RoiRect> m_data_rects;
+
+public:
+    StepRoi();
+    StepRoi(RoiRect output, std::vector<RoiRect> data_rects);
+};
+
+} // namespace tg::core
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include "tg/core/roi_demand.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/step.hpp"
+
+namespace tg::core
+{
+
+RoiDemand::RoiDemand(const Plan& plan)
+    : m_plan(plan)
+    , m_requests(plan.slot_count())
+    , m_slot_demand(plan.slot_count())
+    , m_slot_coverage(plan.slot_count(), RoiRect::full())
+    , m_step_output(plan.step_count(), RoiRect::full())
+    , m_step_needed(plan.step_count(), true)
+{
+}
+
+RoiDemand::~RoiDemand()
+{
+}
+
+void RoiDemand::request(size_t slot_index, const RoiRect& rect)
+{
+    if (slot_index >= m_requests.size())
+    {
+        throw std::invalid_argument("RoiDemand::request(): slot index out of bounds.");
+    }
+    RoiRect& ref_request = m_requests.at(slot_index);
+    ref_request = ref_request.unite(rect);
+}
+
+void RoiDemand::request(std::string_view name, const RoiRect& rect)
+{
+    auto slot_opt = m_plan.find_slot(name);
+    if (!slot_opt.has_value())
+    {
+        throw std::invalid_argument(
+            "RoiDemand::request(): data " + std::string(name) + " not found in Plan."
+        );
+    }
+    this->request(slot_opt.value(), rect);
+}
+
+void RoiDemand::propagate()
+{
+    m_slot_demand = m_requests;
+    std::fill(m_slot_coverage.begin(), m_slot_coverage.end(), RoiRect::full());
+    const auto& order = m_plan.topo_order();
+    for (auto iter = order.rbegin(); iter != order.rend(); ++iter)
+    {
+        const size_t step_index = *iter;
+        const PlanStep& plan_step = m_plan.step_at(step_index);
+        const size_t data_count = plan_step.m_slots.size();
+        RoiRect output{};
+        for (size_t k = 0u; k < data_count; ++k)
+        {
+            if (plan_step.m_usages.at(k) == DataUsage::Write)
+            {
+                output = output.unite(m_slot_demand.at(plan_step.m_slots.at(k)));
+            }
+        }
+        if (output.is_empty())
+        {
+            m_step_needed.at(step_index) = false;
+            m_step_output.at(step_index) = RoiRect{};
+            continue;
+        }
+        m_step_needed.at(step_index) = true;
+        const RoiHalo halo = plan_step.m_step->roi_halo();
+        RoiRect input{};
+        if (halo.is_whole())
+        {
+            output = RoiRect::full();
+            input = RoiRect::full();
+        }
+        else
+        {
+            input = output.grow(halo.m_x, halo.m_y);
+        }
+        m_step_output.at(step_index) = output;
+        for (size_t k = 0u; k < data_count; ++k)
+        {
+            const size_t slot_index = plan_step.m_slots.at(k);
+            if (plan_step.m_usages.at(k) == DataUsage::Write)
+            {
+                m_slot_coverage.at(slot_index) = output;
+            }
+            else
+            {
+                RoiRect& ref_demand = m_slot_demand.at(slot_index);
+                ref_demand = ref_demand.unite(input);
+            }
+        }
+    }
+}
+
+bool RoiDemand::is_step_needed(size_t step_index) const
+{
+    return m_step_needed.at(step_index);
+}
+
+const RoiRect& RoiDemand::step_output_rect(size_t step_index) const
+{
+    return m_step_output.at(step_index);
+}
+
+const RoiRect& RoiDemand::slot_demand(size_t slot_index) const
+{
+    return m_slot_demand.at(slot_index);
+}
+
+const RoiRect& RoiDemand::slot_coverage(size_t slot_index) const
+{
+    return m_slot_coverage.at(slot_index);
+}
+
+StepRoi RoiDemand::make_step_roi(size_t step_index) const
+{
+    const PlanStep& plan_step = m_plan.step_at(step_index);
+    std::vector<RoiRect> data_rects;
+    data_rects.reserve(plan_step.m_slots.size());
+    for (size_t slot_index : plan_step.m_slots)
+    {
+        data_rects.push_back(m_slot_coverage.at(slot_index));
+    }
+    return StepRoi{m_step_output.at(step_index), std::move(data_rects)};
+}
+
+} // namespace tg::core
@@ -0,0 +1,82 @@
+#pragma once
+#include "tg/core/fwd.hpp"
+
+namespace tg::core
+{
+
+/**
+ * @brief Region-of-interest demand, propagated backward through a Plan.
+ *
+ * @details The caller requests regions on some slots (typically global
+ * outputs), then calls ```propagate()```. Visiting the Steps in reverse
+ * topological order, the region required from each Step is the union of
+ * the regions demanded on the slots it writes; the region it requires from
+ * its inputs is that region grown by the Step's ```roi_halo()```.
+ *
+ * Steps whose outputs are not demanded at all are not needed, and are
+ * skipped by the Executor. Steps with a whole halo turn the demand on
+ * their inputs into whole demand, and always produce whole outputs.
+ *
+ * @note The RoiDemand refers to the Plan, which must outlive it.
+ */
+class RoiDemand
+{
+public:
+    explicit RoiDemand(const Plan& plan);
+    ~RoiDemand();
+
+public:
+    /**
+     * @brief Requests a region on a slot. Repeated requests are united.
+     * @exception std::invalid_argument if the slot index is out of bounds.
+     */
+    void request(size_t slot_index, const RoiRect& rect);
+
+    /**
+     * @brief Requests a region on a slot, by data name.
+     * @exception std::invalid_argument if the name is not found in the Plan.
+     */
+    void request(std::string_view name, const RoiRect& rect);
+
+    /**
+     * @brief Propagates the requested regions backward through the Plan.
+     * @note Can be called again after more requests are added.
+     */
+    void propagate();
+
+    /**
+     * @brief Whether the Step has to be executed at all.
+     */
+    bool is_step_needed(size_t step_index) const;
+
+    /**
+     * @brief The region that the Step produces on all its outputs.
+     */
+    const RoiRect& step_output_rect(size_t step_index) const;
+
+    /**
+     * @brief The region demanded from the slot by its readers and requests.
+     */
+    const RoiRect& slot_demand(size_t slot_index) const;
+
+    /**
+     * @brief The region covered by the buffer of the slot during execution.
+     * This is the output region of its writer, or whole for global inputs.
+     */
+    const RoiRect& slot_coverage(size_t slot_index) const;
+
+    /**
+     * @brief Makes the region-of-interest information to be given to the Step.
+     */
+    StepRoi make_step_roi(size_t step_index) const;
+
+private:
+    const Plan& m_plan;
+    std::vector<RoiRect> m_requests;
+    std::vector<RoiRect> m_slot_demand;
+    std::vector<RoiRect> m_slot_coverage;
+    std::vector<RoiRect> m_step_output;
+    std::vector<bool> m_step_needed;
+};
+
+} // namespace tg::core
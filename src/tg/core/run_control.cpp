@@ -0,0 +1,169 @@
+#include <algorithm>
+#include "tg/core/run_control.hpp"
+
+namespace tg::core
+{
+
+namespace //(unnamed)
+{
+
+thread_local RunControl* tls_current_control = nullptr;
+
+} // namespace(unnamed)
+
+RunControl::RunControl()
+    : m_status{RunStatus::Active}
+    , m_deadline{}
+    , m_callback_mutex{}
+    , m_callback_cv{}
+    , m_callbacks{}
+    , m_next_callback_id{1u}
+    , m_running_callback_id{0u}
+    , m_running_thread{}
+{
+}
+
+RunControlPtr RunControl::with_timeout(Clock::duration timeout)
+{
+    auto control = std::make_shared<RunControl>();
+    control->set_deadline(Clock::now() + timeout);
+    return control;
+}
+
+RunControl::~RunControl()
+{
+}
+
+void RunControl::set_deadline(Clock::time_point deadline)
+{
+    m_deadline = deadline;
+}
+
+std::optional<RunControl::Clock::time_point> RunControl::deadline() const
+{
+    return m_deadline;
+}
+
+void RunControl::cancel()
+{
+    this->detail_stop(RunStatus::Cancelled);
+}
+
+void RunControl::expire()
+{
+    this->detail_stop(RunStatus::DeadlineExceeded);
+}
+
+bool RunControl::is_stopped() const
+{
+    const RunStatus status = m_status.load();
+    return status == RunStatus::Cancelled || status == RunStatus::DeadlineExceeded;
+}
+
+void RunControl::throw_if_stopped() const
+{
+    switch (m_status.load())
+    {
+    case RunStatus::Cancelled:
+        throw RunCancelled("RunControl::throw_if_stopped(): run cancelled.");
+    case RunStatus::DeadlineExceeded:
+        throw RunCancelled("RunControl::throw_if_stopped(): deadline exceeded.");
+    default:
+        break;
+    }
+}
+
+RunStatus RunControl::status() const
+{
+    return m_status.load();
+}
+
+void RunControl::detail_finish()
+{
+    RunStatus expect = RunStatus::Active;
+    m_status.compare_exchange_strong(expect, RunStatus::Finished);
+}
+
+size_t RunControl::detail_add_stop_callback(std::function<void()> callback)
+{
+    std::lock_guard<std::mutex> lock(m_callback_mutex);
+    // Checked under the lock, which detail_stop() takes after the status changes.
+    if (this->is_stopped())
+    {
+        return 0u;
+    }
+    const size_t callback_id = m_next_callback_id++;
+    m_callbacks.emplace_back(callback_id, std::move(callback));
+    return callback_id;
+}
+
+void RunControl::detail_remove_stop_callback(size_t callback_id)
+{
+    std::unique_lock<std::mutex> lock(m_callback_mutex);
+    auto iter = std::find_if(m_callbacks.begin(), m_callbacks.end(), [callback_id](const auto& entry) {
+        return entry.first == callback_id;
+    });
+    if (iter != m_callbacks.end())
+    {
+        m_callbacks.erase(iter);
+        return;
+    }
+    // A callback may unregister itself; any other caller waits for it.
+    if (m_running_thread != std::this_thread::get_id())
+    {
+        m_callback_cv.wait(lock, [this, callback_id]() {
+            return m_running_callback_id != callback_id;
+        });
+    }
+}
+
+void RunControl::detail_stop(RunStatus status)
+{
+    RunStatus expect = RunStatus::Active;
+    if (!m_status.compare_exchange_strong(expect, status))
+    {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(m_callback_mutex);
+    m_running_thread = std::this_thread::get_id();
+    while (!m_callbacks.empty())
+    {
+        auto [callback_id, callback] = std::move(m_callbacks.back());
+        m_callbacks.pop_back();
+        m_running_callback_id = callback_id;
+        lock.unlock();
+        callback();
+        lock.lock();
+        m_running_callback_id = 0u;
+        m_callback_cv.notify_all();
+    }
+    m_running_thread = std::thread::id{};
+}
+
+RunControl* RunControl::current()
+{
+    return tls_current_control;
+}
+
+RunControl::CurrentScope::CurrentScope(RunControl* p_control)
+    : m_p_previous{tls_current_control}
+{
+    tls_current_control = p_control;
+}
+
+RunControl::CurrentScope::~CurrentScope()
+{
+    tls_current_control = m_p_previous;
+}
+
+RunControl::FinishScope::FinishScope(RunControl& control)
+    : m_control{control}
+{
+}
+
+RunControl::FinishScope::~FinishScope()
+{
+    m_control.detail_finish();
+}
+
+} // namespace tg::core
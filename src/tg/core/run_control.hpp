@@ -0,0 +1,150 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+#include "tg/core/fwd.hpp"
+
+namespace tg::core
+{
+
+/**
+ * @brief Lets the caller of a run cancel it, or give it a deadline.
+ *
+ * @details Pass the RunControl to ```Executor::run()```. Cancellation is
+ * cooperative: once the control is cancelled (by ```cancel()```, or by the
+ * Executor's timing wheel when the deadline passes), the Executor stops
+ * starting Steps of the run, waits only for the Steps already executing,
+ * clears the slots of the run, and throws RunCancelled.
+ *
+ * Stopping does not wait to be noticed: the thread that stops the control
+ * withdraws the Steps of the run still queued for resources or for a batch,
+ * so that a run with no Step executing is released, and its caller woken,
+ * on that thread.
+ *
+ * A long-running Step can poll ```RunControl::current()``` to stop early.
+ * Executor runs nested in a Step (e.g. MapStep, LoopStep) inherit the
+ * RunControl of the enclosing run.
+ *
+ * @note One RunControl per run; it is thread-safe.
+ */
+class RunControl
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+public:
+    RunControl();
+
+    /**
+     * @brief Creates a RunControl whose deadline is ```timeout``` from now.
+     */
+    static RunControlPtr with_timeout(Clock::duration timeout);
+
+    ~RunControl();
+
+public:
+    /**
+     * @brief Sets the deadline; call before the run starts.
+     */
+    void set_deadline(Clock::time_point deadline);
+    std::optional<Clock::time_point> deadline() const;
+
+    /**
+     * @brief Cancels the run; has no effect if already stopped.
+     */
+    void cancel();
+
+    /**
+     * @brief Marks the run as past its deadline; called by the timing wheel.
+     */
+    void expire();
+
+    /**
+     * @brief Whether the run was cancelled or is past its deadline.
+     */
+    bool is_stopped() const;
+
+    /**
+     * @brief Throws RunCancelled if the run is stopped; lets a Step abandon
+     * its work at a convenient point.
+     */
+    void throw_if_stopped() const;
+    RunStatus status() const;
+
+    /**
+     * @brief The RunControl of the run whose Step is executing on the
+     * calling thread, or null.
+     */
+    static RunControl* current();
+
+private:
+    friend class Executor;
+
+    /**
+     * @brief Marks the run as completed, unless it was stopped.
+     */
+    void detail_finish();
+
+    /**
+     * @brief Registers a callback to be called, once, on the thread that
+     * stops the control.
+     * @returns Its id, or zero (not registered) if already stopped.
+     */
+    size_t detail_add_stop_callback(std::function<void()> callback);
+
+    /**
+     * @brief Unregisters the callback; if it is being called on another
+     * thread, waits for it to return.
+     */
+    void detail_remove_stop_callback(size_t callback_id);
+
+    void detail_stop(RunStatus status);
+
+    /**
+     * @brief Makes ```current()``` return the given control on this thread
+     * while in scope.
+     */
+    class CurrentScope
+    {
+    public:
+        explicit CurrentScope(RunControl* p_control);
+        ~CurrentScope();
+    private:
+        RunControl* m_p_previous;
+    };
+
+    /**
+     * @brief Marks the run as completed when leaving the scope, whether the
+     * run returns or throws.
+     */
+    class FinishScope
+    {
+    public:
+        explicit FinishScope(RunControl& control);
+        ~FinishScope();
+    private:
+        RunControl& m_control;
+    };
+
+private:
+    RunControl(const RunControl&) = delete;
+    RunControl(RunControl&&) = delete;
+    RunControl& operator=(const RunControl&) = delete;
+    RunControl& operator=(RunControl&&) = delete;
+
+private:
+    std::atomic<RunStatus> m_status;
+    std::optional<Clock::time_point> m_deadline;
+
+    /**
+     * @brief The stop callbacks, and the one being called, if any.
+     */
+    std::mutex m_callback_mutex;
+    std::condition_variable m_callback_cv;
+    std::vector<std::pair<size_t, std::function<void()>>> m_callbacks;
+    size_t m_next_callback_id;
+    size_t m_running_callback_id;
+    std::thread::id m_running_thread;
+};
+
+} // namespace tg::core
@@ -0,0 +1,203 @@
+#include <algorithm>
+#include "tg/core/runtime.hpp"
+#include "tg/core/memory_budget.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/thread_pool.hpp"
+
+namespace tg::core
+{
+
+namespace //(unnamed)
+{
+
+ThreadPoolPtr make_pool_if_null(ThreadPoolPtr pool)
+{
+    return pool ? std::move(pool) : std::make_shared<ThreadPool>();
+}
+
+} // namespace(unnamed)
+
+Runtime::Runtime(const Scope& scope, ThreadPoolPtr pool)
+    : Runtime{std::make_shared<Plan>(scope), std::move(pool)}
+{
+}
+
+Runtime::Runtime(PlanPtr plan, ThreadPoolPtr pool)
+    : m_sp_plan{std::move(plan)}
+    , m_executor{make_pool_if_null(std::move(pool))}
+    , m_output_slots{}
+    , m_mutex{}
+    , m_idle_cv{}
+    , m_free_arenas{}
+    , m_arena_count{0u}
+    , m_in_flight{0u}
+    , m_peak_in_flight{0u}
+{
+    if (!m_sp_plan)
+    {
+        throw std::invalid_argument("Runtime::Runtime(): plan cannot be null.");
+    }
+    m_output_slots = m_sp_plan->global_outputs();
+}
+
+Runtime::~Runtime()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle_cv.wait(lock, [this]() {
+        return m_in_flight == 0u;
+    });
+}
+
+const Plan& Runtime::plan() const
+{
+    return *m_sp_plan;
+}
+
+Executor& Runtime::executor()
+{
+    return m_executor;
+}
+
+std::future<Runtime::NamedData> Runtime::submit(NamedData inputs, RunControlPtr control)
+{
+    const Plan& plan = *m_sp_plan;
+    // Check the names before taking an arena, so that a bad request has no effect.
+    std::vector<std::pair<size_t, VarData>> bound;
+    bound.reserve(inputs.size());
+    for (auto& [name, value] : inputs)
+    {
+        auto slot_opt = plan.find_slot(name);
+        if (!slot_opt.has_value() || plan.slot_at(slot_opt.value()).m_writer.has_value())
+        {
+            throw std::invalid_argument("Runtime::submit(): " + name + " is not a global input.");
+        }
+        bound.emplace_back(slot_opt.value(), std::move(value));
+    }
+    auto request = std::make_shared<Request>();
+    request->m_arena = this->detail_acquire_arena();
+    std::future<NamedData> future = request->m_promise.get_future();
+    bool is_admitted = false;
+    try
+    {
+        for (auto& [slot_index, value] : bound)
+        {
+            request->m_arena.at(slot_index) = std::move(value);
+        }
+        request->m_control = std::move(control);
+        request->m_budget = m_executor.memory_budget();
+        request->m_peak_bytes = request->m_budget ? m_executor.predict_peak(plan, request->m_arena) : 0u;
+        ThreadPool* pool = m_executor.pool().get();
+        const TaskPriority priority = m_executor.priority();
+        // A request that does not fit the budget yet waits without a task; once
+        // admitted, it is started from a task rather than on the releasing thread.
+        auto on_admitted = [this, request, pool, priority]() {
+            pool->submit([this, request]() { this->detail_start(request); }, priority);
+        };
+        if (request->m_budget && !request->m_budget->acquire_or_wait(request->m_peak_bytes, std::move(on_admitted)))
+        {
+            return future;
+        }
+        is_admitted = true;
+        this->detail_start(request);
+    }
+    catch (...)
+    {
+        // Nothing was started; give back what the request took, or the Runtime never becomes idle.
+        if (is_admitted && request->m_budget)
+        {
+            request->m_budget->release(request->m_peak_bytes);
+        }
+        this->detail_release_arena(std::move(request->m_arena));
+        throw;
+    }
+    return future;
+}
+
+size_t Runtime::in_flight() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_in_flight;
+}
+
+size_t Runtime::arena_count() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_arena_count;
+}
+
+size_t Runtime::peak_in_flight() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_peak_in_flight;
+}
+
+void Runtime::detail_start(const std::shared_ptr<Request>& request)
+{
+    m_executor.run_async(*m_sp_plan, request->m_arena, request->m_control, [this, request](std::exception_ptr error) {
+        this->detail_complete(*request, error);
+    });
+}
+
+void Runtime::detail_complete(Request& request, std::exception_ptr error)
+{
+    NamedData outputs;
+    if (!error)
+    {
+        for (size_t slot_index : m_output_slots)
+        {
+            if (request.m_arena.at(slot_index).has_value())
+            {
+                outputs.emplace(m_sp_plan->slot_at(slot_index).m_name, std::move(request.m_arena.at(slot_index)));
+            }
+        }
+    }
+    if (request.m_budget)
+    {
+        request.m_budget->release(request.m_peak_bytes);
+    }
+    this->detail_release_arena(std::move(request.m_arena));
+    /**
+     * @note Completed after the release, so that a ready future implies
+     * a recycled arena; from here on, the Runtime may be gone.
+     */
+    if (error)
+    {
+        request.m_promise.set_exception(error);
+    }
+    else
+    {
+        request.m_promise.set_value(std::move(outputs));
+    }
+}
+
+std::vector<VarData> Runtime::detail_acquire_arena()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_peak_in_flight = std::max(m_peak_in_flight, ++m_in_flight);
+    if (!m_free_arenas.empty())
+    {
+        std::vector<VarData> arena = std::move(m_free_arenas.back());
+        m_free_arenas.pop_back();
+        return arena;
+    }
+    ++m_arena_count;
+    return std::vector<VarData>(m_sp_plan->slot_count());
+}
+
+void Runtime::detail_release_arena(std::vector<VarData> arena)
+{
+    // Release the data outside the lock; the vector itself is kept.
+    for (auto& slot : arena)
+    {
+        slot.clear();
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_free_arenas.push_back(std::move(arena));
+    if (--m_in_flight == 0u)
+    {
+        m_idle_cv.notify_all();
+    }
+}
+
+} // namespace tg::core
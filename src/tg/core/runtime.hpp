@@ -0,0 +1,136 @@
+#pragma once
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include "tg/core/fwd.hpp"
+#include "tg/core/executor.hpp"
+
+namespace tg::core
+{
+
+/**
+ * @brief An embedded serving runtime: owns a compiled Plan and a parallel
+ * Executor, and serves concurrent requests, each a run of the Plan.
+ *
+ * @details ```submit()``` takes the global inputs of one request by name,
+ * and returns at once with a future of the global outputs by name. The run
+ * is asynchronous (see ```Executor::run_async()```): no worker waits for
+ * it, and the task that completes its last Step fulfils the future. The
+ * Executor runs the Steps of concurrent requests side by side on the same
+ * workers, in the order they become ready.
+ *
+ * Each request runs in a slot arena (one VarData per slot of the Plan).
+ * Arenas are recycled: after a request, its arena is cleared (releasing
+ * the data, keeping the allocation) and reused by a later request; hence
+ * the number of arenas follows the peak number of requests in flight.
+ *
+ * With a memory budget on the Executor (see
+ * ```Executor::set_memory_budget()```), each request is admitted by its
+ * predicted peak memory before it is queued on the pool; a burst of large
+ * requests waits in the budget's queue, in order, instead of running at
+ * once. The arena of a waiting request already holds its inputs.
+ *
+ * Serving interactive and bulk traffic on one pool takes two Runtimes
+ * sharing it, the bulk one with ```executor().set_priority()``` set to
+ * ```TaskPriority::Batch```.
+ *
+ * A request that fails (missing input, exception in a Step) delivers the
+ * exception through its future; so does a request stopped by its
+ * RunControl, with RunCancelled. A deadline counts from when the control
+ * was created (see ```RunControl::with_timeout()```), so time spent queued
+ * counts against it.
+ *
+ * @note The destructor waits for the requests in flight.
+ */
+class Runtime
+{
+public:
+    using NamedData = std::unordered_map<std::string, VarData>;
+
+public:
+    /**
+     * @brief Compiles the Scope.
+     * @param pool The pool to run on; null creates a pool with one worker
+     * per hardware thread.
+     */
+    Runtime(const Scope& scope, ThreadPoolPtr pool);
+
+    /**
+     * @brief Serves an already compiled Plan.
+     */
+    Runtime(PlanPtr plan, ThreadPoolPtr pool);
+
+    ~Runtime();
+
+public:
+    const Plan& plan() const;
+
+    /**
+     * @brief The Executor, e.g. to set its batch policy before serving.
+     */
+    Executor& executor();
+
+    /**
+     * @brief Submits one request.
+     * @param inputs The global inputs by name (or alias).
+     * @param control Optional; cancels the request or gives it a deadline.
+     * @returns The future of the global outputs, by slot name.
+     * @exception std::invalid_argument if an input name is not a global
+     * input of the Plan; a missing input is reported through the future.
+     */
+    std::future<NamedData> submit(NamedData inputs, RunControlPtr control = nullptr);
+
+    /**
+     * @brief The number of requests submitted and not yet completed.
+     */
+    size_t in_flight() const;
+
+    /**
+     * @brief The number of slot arenas allocated so far.
+     */
+    size_t arena_count() const;
+
+    /**
+     * @brief The largest number of requests in flight at once so far; no
+     * more arenas than this are ever allocated.
+     */
+    size_t peak_in_flight() const;
+
+private:
+    /**
+     * @brief One submitted request, from its admission to its completion.
+     */
+    struct Request
+    {
+        std::vector<VarData> m_arena;
+        RunControlPtr m_control;
+        std::promise<NamedData> m_promise;
+        MemoryBudgetPtr m_budget;
+        size_t m_peak_bytes;
+    };
+
+private:
+    std::vector<VarData> detail_acquire_arena();
+    void detail_release_arena(std::vector<VarData> arena);
+    void detail_start(const std::shared_ptr<Request>& request);
+    void detail_complete(Request& request, std::exception_ptr error);
+
+private:
+    Runtime(const Runtime&) = delete;
+    Runtime(Runtime&&) = delete;
+    Runtime& operator=(const Runtime&) = delete;
+    Runtime& operator=(Runtime&&) = delete;
+
+private:
+    PlanPtr m_sp_plan;
+    Executor m_executor;
+    std::vector<size_t> m_output_slots;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_idle_cv;
+    std::vector<std::vector<VarData>> m_free_arenas;
+    size_t m_arena_count;
+    size_t m_in_flight;
+    size_t m_peak_in_flight;
+};
+
+} // namespace tg::core
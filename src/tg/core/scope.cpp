@@ -13,6 +13,7 @@ Scope::Scope(std::string_view scopename)
     : m_scopename{scopename}
     , m_sp_scopeinfo{/*(defer initialized in ctor)*/}
     , m_steps{}
+    , m_wires{}
     , m_owner_token{}
     , m_frozen{false}
 {
@@ -110,6 +111,24 @@ StepPtr Scope::step_at(size_t index) const
     return m_steps.at(index);
 }
 
+void Scope::wire(std::string_view lhs, std::string_view rhs)
+{
+    if (m_frozen)
+    {
+        throw std::runtime_error("Scope::wire(): cannot add wire to a frozen Scope.");
+    }
+    if (lhs.empty() || rhs.empty())
+    {
+        throw std::invalid_argument("Scope::wire(): data name cannot be empty.");
+    }
+    m_wires.emplace_back(std::string(lhs), std::string(rhs));
+}
+
+const std::vector<std::pair<std::string, std::string>>& Scope::wires() const
+{
+    return m_wires;
+}
+
 void Scope::freeze()
 {
     if (m_frozen)
@@ -91,6 +91,25 @@ public:
      */
     StepPtr step_at(size_t index) const;
 
+    /**
+     * @brief Connects two data names, so that they refer to the same data.
+     *
+     * @details Wires are resolved when the Scope is compiled into a Plan:
+     * all names connected by wires, directly or transitively, are unified
+     * into one slot, so no forwarding Step is needed between them. A name
+     * that no Step uses (a receptacle) simply collapses onto the data it is
+     * wired to.
+     *
+     * @note The unified data must still have at most one writer and one
+     * consumer, and a single type; this is checked by the Plan.
+     */
+    void wire(std::string_view lhs, std::string_view rhs);
+
+    /**
+     * @brief Gets all wires, as pairs of data names.
+     */
+    const std::vector<std::pair<std::string, std::string>>& wires() const;
+
     /**
      * @brief Freezes the NameScope as well as all Step objects added to it.
      */
@@ -112,6 +131,7 @@ private:
     const std::string m_scopename;
     ScopeInfoPtr m_sp_scopeinfo;
     std::vector<StepPtr> m_steps;
+    std::vector<std::pair<std::string, std::string>> m_wires;
     size_t m_owner_token;
     bool m_frozen;
 };
@@ -0,0 +1,150 @@
+#include "tg/core/scope_step.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/scope.hpp"
+
+namespace tg::core
+{
+
+ScopeStep::ScopeStep(std::string_view shortname, const Scope& inner, ScopeStepMode mode)
+    : Step{}
+    , m_inner_plan{std::make_shared<Plan>(inner)}
+    , m_mode{mode}
+    , m_nested_steps{}
+    , m_local_by_slot(m_inner_plan->slot_count())
+{
+    this->info().set_shortname(shortname);
+    this->info().set_step_type<ScopeStep>();
+    for (const auto& step : inner.get_steps())
+    {
+        try
+        {
+            step->info().on_nested_in_scope_step();
+        }
+        catch (const std::invalid_argument&)
+        {
+            for (const auto& nested : m_nested_steps)
+            {
+                nested->info().on_released_from_scope_step();
+            }
+            throw std::invalid_argument(
+                "ScopeStep::ScopeStep(): the Steps of Scope " + inner.scopename() + " are already nested in another ScopeStep."
+            );
+        }
+        m_nested_steps.push_back(step);
+    }
+}
+
+ScopeStep::~ScopeStep()
+{
+    for (const auto& step : m_nested_steps)
+    {
+        step->info().on_released_from_scope_step();
+    }
+}
+
+void ScopeStep::bind_input(std::string_view input_name, std::string_view inner_slot_name)
+{
+    const size_t slot_index = this->detail_bind("ScopeStep::bind_input()", inner_slot_name);
+    const PlanSlot& slot = m_inner_plan->slot_at(slot_index);
+    if (slot.m_writer.has_value())
+    {
+        throw std::invalid_argument(
+            "ScopeStep::bind_input(): data " + slot.m_name + " is not a global input of the inner plan."
+        );
+    }
+    const DataUsage usage = slot.m_consumer.has_value() ? DataUsage::Consume : DataUsage::Read;
+    const size_t local_index = this->info().data_count();
+    this->info().add_data(input_name, usage, slot.m_type);
+    m_local_by_slot.at(slot_index) = local_index;
+}
+
+void ScopeStep::bind_output(std::string_view inner_slot_name, std::string_view output_name)
+{
+    const size_t slot_index = this->detail_bind("ScopeStep::bind_output()", inner_slot_name);
+    const PlanSlot& slot = m_inner_plan->slot_at(slot_index);
+    if (!slot.m_writer.has_value() || slot.m_consumer.has_value())
+    {
+        throw std::invalid_argument(
+            "ScopeStep::bind_output(): data " + slot.m_name + " must be written and not consumed by the inner plan."
+        );
+    }
+    const size_t local_index = this->info().data_count();
+    this->info().add_data(output_name, DataUsage::Write, slot.m_type);
+    m_local_by_slot.at(slot_index) = local_index;
+}
+
+ScopeStepMode ScopeStep::mode() const
+{
+    return m_mode;
+}
+
+const Plan& ScopeStep::inner_plan() const
+{
+    return *m_inner_plan;
+}
+
+bool ScopeStep::is_bound(size_t inner_slot_index) const
+{
+    return m_local_by_slot.at(inner_slot_index).has_value();
+}
+
+std::string ScopeStep::outer_name(size_t inner_slot_index)
+{
+    const auto& local_opt = m_local_by_slot.at(inner_slot_index);
+    if (local_opt.has_value())
+    {
+        return this->info().get_data_info(local_opt.value()).m_shortname;
+    }
+    return this->private_name(inner_slot_index);
+}
+
+std::string ScopeStep::private_name(size_t inner_slot_index)
+{
+    return this->info().shortname() + "/" + m_inner_plan->slot_at(inner_slot_index).m_name;
+}
+
+void ScopeStep::execute(std::vector<VarData>& data)
+{
+    this->pre_execute_validation(data);
+    std::vector<VarData> inner_slots(m_inner_plan->slot_count());
+    for (size_t slot_index = 0u; slot_index < inner_slots.size(); ++slot_index)
+    {
+        const auto& local_opt = m_local_by_slot.at(slot_index);
+        if (local_opt.has_value() && !m_inner_plan->slot_at(slot_index).m_writer.has_value())
+        {
+            inner_slots.at(slot_index) = std::move(data.at(local_opt.value()));
+        }
+    }
+    Executor inner_executor;
+    inner_executor.run(*m_inner_plan, inner_slots);
+    for (size_t slot_index = 0u; slot_index < inner_slots.size(); ++slot_index)
+    {
+        const auto& local_opt = m_local_by_slot.at(slot_index);
+        if (local_opt.has_value() && m_inner_plan->slot_at(slot_index).m_writer.has_value())
+        {
+            data.at(local_opt.value()) = std::move(inner_slots.at(slot_index));
+        }
+    }
+    this->post_execute_validation(data);
+}
+
+size_t ScopeStep::detail_bind(const char* func_name, std::string_view inner_slot_name)
+{
+    auto slot_opt = m_inner_plan->find_slot(inner_slot_name);
+    if (!slot_opt.has_value())
+    {
+        throw std::invalid_argument(
+            std::string(func_name) + ": data " + std::string(inner_slot_name) + " not found in inner plan."
+        );
+    }
+    if (m_local_by_slot.at(slot_opt.value()).has_value())
+    {
+        throw std::invalid_argument(
+            std::string(func_name) + ": data " + std::string(inner_slot_name) + " is already bound."
+        );
+    }
+    return slot_opt.value();
+}
+
+} // namespace tg::core
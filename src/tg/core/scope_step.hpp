@@ -0,0 +1,105 @@
+#pragma once
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+
+namespace tg::core
+{
+
+/**
+ * @brief A Step that makes a nested Scope usable as a single node of its
+ * parent Scope, with its inputs and outputs mapped onto the parent's data.
+ *
+ * @details The nested Scope is compiled into an inner Plan at construction.
+ * The inputs of the ScopeStep initialize global inputs of the inner Plan;
+ * its outputs take the values of inner slots.
+ *
+ * - In ```ScopeStepMode::Inline```, the parent Plan flattens the inner
+ *   Steps into itself under private data names
+ *   ```<shortname>/<inner name>```, and wires each bound name onto the
+ *   mapped parent data, so no data is forwarded at the boundary. The
+ *   private names can also be wired from the parent Scope directly. The
+ *   inner Steps are then scheduled individually, which exposes their
+ *   parallelism.
+ * - In ```ScopeStepMode::Macro```, the ScopeStep is scheduled as one task
+ *   that runs the inner Plan sequentially with its own sub-Executor, which
+ *   is cheaper for tiny subgraphs.
+ *
+ * An input is consumed (rather than read) by the ScopeStep if the inner
+ * Plan consumes the mapped slot.
+ *
+ * The ScopeStep takes the Steps of the nested Scope as its own until it is
+ * destroyed: nesting one Scope in two ScopeSteps (in either mode) would
+ * run the same Step objects at two places, so the second one is rejected.
+ * Build one nested Scope per ScopeStep instead.
+ *
+ * @note Inputs and outputs are bound before the Step is added to a Scope.
+ */
+class ScopeStep
+    : public Step
+{
+public:
+    /**
+     * @exception std::invalid_argument if the nested Scope is not frozen,
+     * or if its Steps are nested in another ScopeStep.
+     * @exception std::runtime_error if the nested Scope cannot be compiled.
+     */
+    ScopeStep(std::string_view shortname, const Scope& inner, ScopeStepMode mode);
+    ~ScopeStep() override;
+
+    using Step::info;
+
+    /**
+     * @brief Maps parent data onto a global input of the inner Plan.
+     * @exception std::invalid_argument if the inner Plan has no such global
+     * input, or if it is already bound.
+     */
+    void bind_input(std::string_view input_name, std::string_view inner_slot_name);
+
+    /**
+     * @brief Maps an inner slot, written and not consumed by the inner Plan,
+     * onto parent data.
+     * @exception std::invalid_argument if the inner Plan has no such slot,
+     * or if it is already bound.
+     */
+    void bind_output(std::string_view inner_slot_name, std::string_view output_name);
+
+    ScopeStepMode mode() const;
+    const Plan& inner_plan() const;
+
+    /**
+     * @brief Whether an inner slot is mapped onto parent data.
+     */
+    bool is_bound(size_t inner_slot_index) const;
+
+    /**
+     * @brief The name of the parent data an inner slot is mapped to; for an
+     * unbound slot, its private name.
+     */
+    std::string outer_name(size_t inner_slot_index);
+
+    /**
+     * @brief The private name ```<shortname>/<inner name>``` of an inner slot.
+     */
+    std::string private_name(size_t inner_slot_index);
+
+    void execute(std::vector<VarData>& data) override;
+
+private:
+    size_t detail_bind(const char* func_name, std::string_view inner_slot_name);
+
+private:
+    PlanPtr m_inner_plan;
+    ScopeStepMode m_mode;
+
+    /**
+     * @brief The Steps of the nested Scope, released on destruction.
+     */
+    std::vector<StepPtr> m_nested_steps;
+
+    /**
+     * @brief The local data index each inner slot is bound to, if any.
+     */
+    std::vector<std::optional<size_t>> m_local_by_slot;
+};
+
+} // namespace tg::core
@@ -0,0 +1,133 @@
+#include <algorithm>
+#include "tg/core/scratch_arena.hpp"
+#include "tg/core/thread_pool.hpp"
+
+namespace tg::core
+{
+
+namespace //(unnamed)
+{
+
+size_t align_offset(const unsigned char* p_base, size_t used, size_t alignment)
+{
+    const auto address = reinterpret_cast<std::uintptr_t>(p_base) + used;
+    const auto aligned = (address + (alignment - 1u)) & ~static_cast<std::uintptr_t>(alignment - 1u);
+    return used + static_cast<size_t>(aligned - address);
+}
+
+} // namespace(unnamed)
+
+ScratchArena::Lease::Lease(ScratchArena& arena, void* p_data, size_t size, size_t block_index, size_t mark)
+    : m_arena(arena)
+    , m_p_data{p_data}
+    , m_size{size}
+    , m_block_index{block_index}
+    , m_mark{mark}
+{
+}
+
+ScratchArena::Lease::~Lease()
+{
+    m_arena.detail_release(m_block_index, m_mark);
+}
+
+void* ScratchArena::Lease::data() const
+{
+    return m_p_data;
+}
+
+size_t ScratchArena::Lease::size() const
+{
+    return m_size;
+}
+
+ScratchArena::ScratchArena()
+    : m_blocks{}
+    , m_lease_count{0u}
+    , m_capacity{0u}
+    , m_grow_count{0u}
+{
+}
+
+ScratchArena::~ScratchArena()
+{
+}
+
+ScratchArena& ScratchArena::local()
+{
+    ScratchArena* p_worker_arena = ThreadPool::current_scratch();
+    if (p_worker_arena)
+    {
+        return *p_worker_arena;
+    }
+    thread_local ScratchArena tls_arena;
+    return tls_arena;
+}
+
+ScratchArena::Lease ScratchArena::acquire(size_t bytes, size_t alignment)
+{
+    if (alignment == 0u || (alignment & (alignment - 1u)) != 0u)
+    {
+        throw std::invalid_argument("ScratchArena::acquire(): alignment must be a power of two.");
+    }
+    size_t offset = 0u;
+    if (!m_blocks.empty())
+    {
+        const Block& block = m_blocks.back();
+        offset = align_offset(block.m_bytes.get(), block.m_used, alignment);
+    }
+    if (m_blocks.empty() || offset + bytes > m_blocks.back().m_size)
+    {
+        const size_t request = bytes + alignment;
+        this->detail_add_block(std::max({initial_capacity, m_capacity.load(), request}));
+        offset = align_offset(m_blocks.back().m_bytes.get(), 0u, alignment);
+    }
+    const size_t block_index = m_blocks.size() - 1u;
+    Block& block = m_blocks.back();
+    const size_t mark = block.m_used;
+    block.m_used = offset + bytes;
+    ++m_lease_count;
+    return Lease{*this, block.m_bytes.get() + offset, bytes, block_index, mark};
+}
+
+size_t ScratchArena::capacity() const
+{
+    return m_capacity.load();
+}
+
+size_t ScratchArena::in_use() const
+{
+    size_t used = 0u;
+    for (const Block& block : m_blocks)
+    {
+        used += block.m_used;
+    }
+    return used;
+}
+
+size_t ScratchArena::grow_count() const
+{
+    return m_grow_count.load();
+}
+
+void ScratchArena::detail_add_block(size_t size)
+{
+    m_blocks.push_back(Block{std::unique_ptr<unsigned char[]>(new unsigned char[size]), size, 0u});
+    m_capacity += size;
+    ++m_grow_count;
+}
+
+void ScratchArena::detail_release(size_t block_index, size_t mark)
+{
+    m_blocks.at(block_index).m_used = mark;
+    if (--m_lease_count != 0u || m_blocks.size() < 2u)
+    {
+        return;
+    }
+    // Idle: merge the blocks into one of the whole capacity.
+    const size_t total = m_capacity.load();
+    m_blocks.clear();
+    m_blocks.push_back(Block{std::unique_ptr<unsigned char[]>(new unsigned char[total]), total, 0u});
+}
+
+} // namespace tg::core
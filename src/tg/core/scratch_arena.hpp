@@ -0,0 +1,122 @@
+#pragma once
+#include <cstddef>
+#include "tg/core/fwd.hpp"
+
+namespace tg::core
+{
+
+/**
+ * @brief A per-thread allocator of temporary buffers for Step
+ * implementations (intermediate images, row buffers, tables), reused across
+ * executions.
+ *
+ * @details Each worker of a ThreadPool owns an arena, which lives as long as
+ * the pool; other threads get a thread-local one (see ```local()```). An
+ * arena hands out leases from a stack: a lease bumps a pointer in the
+ * current block, and returns its bytes when it goes out of scope. When a
+ * request does not fit, a new block as large as the whole arena (or the
+ * request, if larger) is added, so the capacity grows geometrically. Once
+ * all leases are returned, the blocks are merged into one, so that steady
+ * state needs a single block and no allocation at all.
+ *
+ * Leases are scope-bound and cannot be moved, hence they are returned in
+ * reverse order. A lease taken while an outer one is held (e.g. by a task
+ * the worker helps with while it waits) gets its own bytes.
+ *
+ * @note Only the owning thread may acquire from an arena; ```capacity()```
+ * may be read from any thread.
+ */
+class ScratchArena
+{
+public:
+    static constexpr size_t initial_capacity = size_t{64u} << 10u;
+
+    /**
+     * @brief Bytes borrowed from an arena until the end of the scope.
+     */
+    class Lease
+    {
+    public:
+        ~Lease();
+        void* data() const;
+        size_t size() const;
+
+        template <typename T>
+        T* as() const
+        {
+            return static_cast<T*>(m_p_data);
+        }
+
+    private:
+        friend class ScratchArena;
+        Lease(ScratchArena& arena, void* p_data, size_t size, size_t block_index, size_t mark);
+
+    private:
+        Lease(const Lease&) = delete;
+        Lease(Lease&&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+
+    private:
+        ScratchArena& m_arena;
+        void* m_p_data;
+        size_t m_size;
+        size_t m_block_index;
+        size_t m_mark;
+    };
+
+public:
+    ScratchArena();
+    ~ScratchArena();
+
+    /**
+     * @brief The arena of the calling thread: its worker's arena on a
+     * ThreadPool worker, otherwise a thread-local one.
+     */
+    static ScratchArena& local();
+
+    /**
+     * @brief Borrows uninitialized bytes, aligned as requested.
+     * @exception std::invalid_argument if the alignment is not a power of
+     * two.
+     */
+    Lease acquire(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    size_t capacity() const;
+
+    /**
+     * @brief The bytes currently leased, including alignment padding.
+     * @note Owning thread only.
+     */
+    size_t in_use() const;
+
+    /**
+     * @brief The number of blocks added since the arena was created.
+     */
+    size_t grow_count() const;
+
+private:
+    void detail_add_block(size_t size);
+    void detail_release(size_t block_index, size_t mark);
+
+private:
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena(ScratchArena&&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+    ScratchArena& operator=(ScratchArena&&) = delete;
+
+private:
+    struct Block
+    {
+        std::unique_ptr<unsigned char[]> m_bytes;
+        size_t m_size;
+        size_t m_used;
+    };
+
+    std::vector<Block> m_blocks;
+    size_t m_lease_count;
+    std::atomic<size_t> m_capacity;
+    std::atomic<size_t> m_grow_count;
+};
+
+} // namespace tg::core
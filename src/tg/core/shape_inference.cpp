@@ -0,0 +1,124 @@
+#include "tg/core/shape_inference.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/step.hpp"
+
+namespace tg::core
+{
+
+ShapeInference::ShapeInference(const Plan& plan)
+    : m_plan(plan)
+    , m_inputs(plan.slot_count())
+    , m_slot_meta(plan.slot_count())
+{
+}
+
+ShapeInference::~ShapeInference()
+{
+}
+
+void ShapeInference::set_input(size_t slot_index, const DataMeta& meta)
+{
+    if (slot_index >= m_inputs.size())
+    {
+        throw std::invalid_argument("ShapeInference::set_input(): slot index out of bounds.");
+    }
+    m_inputs.at(slot_index) = meta;
+}
+
+void ShapeInference::set_input(std::string_view name, const DataMeta& meta)
+{
+    auto slot_opt = m_plan.find_slot(name);
+    if (!slot_opt.has_value())
+    {
+        throw std::invalid_argument(
+            "ShapeInference::set_input(): data " + std::string(name) + " not found in Plan."
+        );
+    }
+    this->set_input(slot_opt.value(), meta);
+}
+
+void ShapeInference::set_inputs(const std::vector<VarData>& slots)
+{
+    for (size_t slot_index : m_plan.global_inputs())
+    {
+        m_inputs.at(slot_index) = DataMeta::of(slots.at(slot_index));
+    }
+}
+
+void ShapeInference::propagate()
+{
+    m_slot_meta = m_inputs;
+    std::vector<std::optional<DataMeta>> metas;
+    for (size_t step_index : m_plan.topo_order())
+    {
+        const PlanStep& plan_step = m_plan.step_at(step_index);
+        const size_t data_count = plan_step.m_slots.size();
+        metas.assign(data_count, std::nullopt);
+        for (size_t k = 0u; k < data_count; ++k)
+        {
+            if (plan_step.m_usages.at(k) != DataUsage::Write)
+            {
+                metas.at(k) = m_slot_meta.at(plan_step.m_slots.at(k));
+            }
+        }
+        plan_step.m_step->infer_meta(metas);
+        if (metas.size() != data_count)
+        {
+            throw std::runtime_error("ShapeInference::propagate(): Step resized the metadata array.");
+        }
+        for (size_t k = 0u; k < data_count; ++k)
+        {
+            if (plan_step.m_usages.at(k) == DataUsage::Write)
+            {
+                m_slot_meta.at(plan_step.m_slots.at(k)) = metas.at(k);
+            }
+        }
+    }
+}
+
+const std::optional<DataMeta>& ShapeInference::slot_meta(size_t slot_index) const
+{
+    return m_slot_meta.at(slot_index);
+}
+
+std::vector<std::optional<DataMeta>> ShapeInference::step_output_metas(size_t step_index) const
+{
+    const PlanStep& plan_step = m_plan.step_at(step_index);
+    const size_t data_count = plan_step.m_slots.size();
+    std::vector<std::optional<DataMeta>> metas(data_count);
+    for (size_t k = 0u; k < data_count; ++k)
+    {
+        if (plan_step.m_usages.at(k) == DataUsage::Write)
+        {
+            metas.at(k) = m_slot_meta.at(plan_step.m_slots.at(k));
+        }
+    }
+    return metas;
+}
+
+bool ShapeInference::is_complete() const
+{
+    for (const auto& meta : m_slot_meta)
+    {
+        if (!meta.has_value() || !meta->is_exact())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t ShapeInference::known_bytes() const
+{
+    size_t bytes = 0u;
+    for (const auto& meta : m_slot_meta)
+    {
+        if (meta.has_value())
+        {
+            bytes += meta->bytes();
+        }
+    }
+    return bytes;
+}
+
+} // namespace tg::core
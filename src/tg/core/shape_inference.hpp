@@ -0,0 +1,83 @@
+#pragma once
+#include "tg/core/fwd.hpp"
+#include "tg/core/data_meta.hpp"
+
+namespace tg::core
+{
+
+/**
+ * @brief Shape and type inference, propagated forward through a Plan.
+ *
+ * @details The caller describes the global inputs, either explicitly or
+ * from their values, then calls ```propagate()```. Visiting the Steps in
+ * topological order, each Step maps the metadata of its inputs to the
+ * metadata of its outputs with ```Step::infer_meta()```. Afterwards the
+ * shape and element type of every intermediate buffer is known before
+ * execution, wherever the Steps declare it; admission control (see
+ * ```predict_peak()```) and output preallocation build on this.
+ *
+ * A slot stays unknown if its writer does not infer it, or if the inputs
+ * the writer needs are unknown.
+ *
+ * @note The ShapeInference refers to the Plan, which must outlive it.
+ */
+class ShapeInference
+{
+public:
+    explicit ShapeInference(const Plan& plan);
+    ~ShapeInference();
+
+public:
+    /**
+     * @brief Describes a slot; meant for global inputs, since the writer of
+     * a slot overrides it.
+     * @exception std::invalid_argument if the slot index is out of bounds.
+     */
+    void set_input(size_t slot_index, const DataMeta& meta);
+
+    /**
+     * @brief Describes a slot, by data name.
+     * @exception std::invalid_argument if the name is not found in the Plan.
+     */
+    void set_input(std::string_view name, const DataMeta& meta);
+
+    /**
+     * @brief Describes the global inputs from their values (see
+     * ```DataMeta::of()```); values that cannot be described stay unknown.
+     */
+    void set_inputs(const std::vector<VarData>& slots);
+
+    /**
+     * @brief Propagates the metadata forward through the Plan.
+     * @note Can be called again after the inputs change.
+     */
+    void propagate();
+
+    /**
+     * @brief The metadata of the slot, or nullopt if unknown.
+     */
+    const std::optional<DataMeta>& slot_meta(size_t slot_index) const;
+
+    /**
+     * @brief The metadata of the outputs of a Step, by local data index;
+     * nullopt for inputs and unknown outputs.
+     */
+    std::vector<std::optional<DataMeta>> step_output_metas(size_t step_index) const;
+
+    /**
+     * @brief Whether every slot is known and exact.
+     */
+    bool is_complete() const;
+
+    /**
+     * @brief The total bytes of all slots that are known and exact.
+     */
+    size_t known_bytes() const;
+
+private:
+    const Plan& m_plan;
+    std::vector<std::optional<DataMeta>> m_inputs;
+    std::vector<std::optional<DataMeta>> m_slot_meta;
+};
+
+} // namespace tg::core
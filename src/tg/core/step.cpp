@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "tg/core/fwd.hpp"
 #include "tg/core/step.hpp"
 #include "tg/core/step_info.hpp"
@@ -9,6 +10,10 @@ Step::Step(StepInfoPtr step_info)
     : m_step_info(std::move(step_info))
     , m_init_fault(false)
     , m_exec_fault(false)
+    , m_prepare_mutex()
+    , m_sp_prepared(std::make_shared<const PreparedList>())
+    , m_sp_last_prepared()
+    , m_prepare_clock(0u)
 {
 }
 
@@ -54,6 +59,10 @@ void Step::pre_execute_validation(const std::vector<VarData>& data)
         if (usage == DataUsage::Read || usage == DataUsage::Consume)
         {
             const auto& dak = data.at(k);
+            if (!dak.has_value() && data_info.m_optional)
+            {
+                continue; // optional input, never produced
+            }
             if (!dak.has_value())
             {
                 this->m_exec_fault = true;
@@ -97,6 +106,10 @@ void Step::post_execute_validation(const std::vector<VarData>& data)
         if (usage == DataUsage::Write)
         {
             const auto& dak = data.at(k);
+            if (!dak.has_value() && data_info.m_optional)
+            {
+                continue; // optional output, left unproduced
+            }
             if (!dak.has_value())
             {
                 this->m_exec_fault = true;
@@ -121,6 +134,159 @@ void Step::post_execute_validation(const std::vector<VarData>& data)
     }    
 }
 
+RoiHalo Step::roi_halo() const
+{
+    return RoiHalo::whole();
+}
+
+void Step::execute_roi(std::vector<VarData>& data, const StepRoi& /*roi*/)
+{
+    this->execute(data);
+}
+
+size_t Step::begin_chunks(std::vector<VarData>& /*data*/)
+{
+    return 0u;
+}
+
+void Step::execute_chunk(std::vector<VarData>& /*data*/, size_t /*chunk_index*/)
+{
+    throw std::logic_error(
+        "Step::execute_chunk(): " + this->info().shortname() + ": Step does not split into chunks."
+    );
+}
+
+void Step::end_chunks(std::vector<VarData>& /*data*/)
+{
+}
+
+bool Step::is_batchable() const
+{
+    return false;
+}
+
+void Step::execute_batch(const std::vector<std::vector<VarData>*>& batch)
+{
+    for (std::vector<VarData>* p_data : batch)
+    {
+        this->execute(*p_data);
+    }
+}
+
+ResourceDemand Step::resource_demand(const std::vector<VarData>& /*data*/) const
+{
+    return ResourceDemand{0u, {}};
+}
+
+void Step::infer_meta(std::vector<std::optional<DataMeta>>& /*metas*/) const
+{
+}
+
+bool Step::needs_prepare() const
+{
+    return false;
+}
+
+void Step::prepare(const std::vector<std::optional<DataMeta>>& /*metas*/)
+{
+}
+
+void Step::ensure_prepared(const std::vector<std::optional<DataMeta>>& metas)
+{
+    std::shared_ptr<PreparedEntry> entry = std::atomic_load(&m_sp_last_prepared);
+    const bool is_last = entry &&
+        !entry->m_is_evicted.load(std::memory_order_relaxed) &&
+        entry->m_metas == metas;
+    if (!is_last)
+    {
+        const size_t hash = stc_hash_metas(metas);
+        entry = stc_find_prepared(*std::atomic_load(&m_sp_prepared), hash, metas);
+        if (!entry)
+        {
+            std::lock_guard<std::mutex> lock(m_prepare_mutex);
+            std::shared_ptr<const PreparedList> current = std::atomic_load(&m_sp_prepared);
+            entry = stc_find_prepared(*current, hash, metas);
+            if (!entry)
+            {
+                entry = std::make_shared<PreparedEntry>();
+                entry->m_metas = metas;
+                entry->m_hash = hash;
+                entry->m_is_prepared = false;
+                entry->m_last_use = ++m_prepare_clock;
+                entry->m_is_evicted = false;
+                auto next = std::make_shared<PreparedList>(*current);
+                if (next->size() >= prepared_capacity)
+                {
+                    auto iter = std::min_element(next->begin(), next->end(), [](const auto& a, const auto& b) {
+                        return a->m_last_use.load(std::memory_order_relaxed) < b->m_last_use.load(std::memory_order_relaxed);
+                    });
+                    (*iter)->m_is_evicted.store(true, std::memory_order_relaxed);
+                    next->erase(iter);
+                }
+                next->push_back(entry);
+                std::atomic_store(&m_sp_prepared, std::shared_ptr<const PreparedList>(std::move(next)));
+            }
+        }
+        std::atomic_store(&m_sp_last_prepared, entry);
+    }
+    // Hits only write when an insertion happened since; a steady state is read-only.
+    const size_t clock = m_prepare_clock.load(std::memory_order_relaxed);
+    if (entry->m_last_use.load(std::memory_order_relaxed) != clock)
+    {
+        entry->m_last_use.store(clock, std::memory_order_relaxed);
+    }
+    if (entry->m_is_prepared.load(std::memory_order_acquire))
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(entry->m_mutex);
+    if (!entry->m_is_prepared.load(std::memory_order_relaxed))
+    {
+        // The outputs are inferred here, so that cache hits do not.
+        std::vector<std::optional<DataMeta>> full_metas = metas;
+        this->infer_meta(full_metas);
+        this->prepare(full_metas);
+        entry->m_is_prepared.store(true, std::memory_order_release);
+    }
+}
+
+size_t Step::prepared_count() const
+{
+    return std::atomic_load(&m_sp_prepared)->size();
+}
+
+size_t Step::stc_hash_metas(const std::vector<std::optional<DataMeta>>& metas)
+{
+    size_t hash = metas.size();
+    const auto mix = [&hash](size_t value) {
+        hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6u) + (hash >> 2u);
+    };
+    for (const auto& meta : metas)
+    {
+        mix(meta.has_value());
+        if (meta.has_value())
+        {
+            mix(static_cast<size_t>(meta->m_rows));
+            mix(static_cast<size_t>(meta->m_cols));
+            mix(static_cast<size_t>(meta->m_type));
+            mix(meta->m_elem_size);
+        }
+    }
+    return hash;
+}
+
+std::shared_ptr<Step::PreparedEntry> Step::stc_find_prepared(const PreparedList& list, size_t hash, const std::vector<std::optional<DataMeta>>& metas)
+{
+    for (const auto& entry : list)
+    {
+        if (entry->m_hash == hash && entry->m_metas == metas)
+        {
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
 StepInfoPtr Step::create_step_info()
 {
     return std::make_shared<StepInfo>();
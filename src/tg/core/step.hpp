@@ -1,5 +1,7 @@
 #pragma once
 #include "tg/core/fwd.hpp"
+#include "tg/core/resource_manager.hpp"
+#include "tg/core/data_meta.hpp"
 
 namespace tg::core
 {
@@ -30,9 +32,169 @@ public:
      * The ```data``` array size is same as ```StepInfo::data_count()```,
      * and the items are stored according to the order of their definition
      * in the StepInfo.
+     *
+     * Temporaries that do not outlive the call can be borrowed from
+     * ```ScratchArena::local()``` instead of being allocated.
      */
     virtual void execute(std::vector<VarData>& data) = 0;
 
+    /**
+     * @brief Declares the neighborhood that the Step reads around each
+     * output pixel, used for region-of-interest demand propagation.
+     *
+     * @note The base implementation returns ```RoiHalo::whole()```, meaning
+     * the Step always needs its whole inputs and computes whole outputs.
+     */
+    virtual RoiHalo roi_halo() const;
+
+    /**
+     * @brief Function to be called by the Executor to execute the Step for
+     * a region of interest only.
+     *
+     * @param data Same as for ```execute()```.
+     * @param roi The region to be produced, and the regions covered by the
+     * buffers of each data item, in global coordinates.
+     *
+     * @note The base implementation calls ```execute()```. This is correct
+     * for Steps with a whole halo, because demand propagation always gives
+     * them whole inputs.
+     */
+    virtual void execute_roi(std::vector<VarData>& data, const StepRoi& roi);
+
+public:
+    /**
+     * @brief Optionally splits the work of the Step into independent chunks
+     * (row ranges, tiles, components), which a parallel Executor schedules
+     * on its pool as separate tasks, alongside other ready Steps.
+     *
+     * @param data Same as for ```execute()```.
+     * @returns The number of chunks, or zero to run ```execute()``` instead.
+     *
+     * @details If the Step splits, the Executor calls ```begin_chunks()```
+     * once, then ```execute_chunk()``` once for each chunk index (possibly
+     * concurrently, on different threads), then ```end_chunks()``` once
+     * after all chunks have finished. Typically ```begin_chunks()```
+     * validates and allocates the outputs, and each chunk writes its own
+     * disjoint part of them.
+     *
+     * @note The base implementation returns zero. A Step that splits must
+     * still implement ```execute()```, which is used by the sequential
+     * Executor and for region-of-interest runs.
+     */
+    virtual size_t begin_chunks(std::vector<VarData>& data);
+
+    /**
+     * @brief Executes one chunk.
+     * @note Calls for different chunks of the same run share ```data```;
+     * they may only read the data items, and write into the parts of the
+     * outputs owned by the chunk.
+     */
+    virtual void execute_chunk(std::vector<VarData>& data, size_t chunk_index);
+
+    /**
+     * @brief Completes the Step after all of its chunks have finished.
+     */
+    virtual void end_chunks(std::vector<VarData>& data);
+
+public:
+    /**
+     * @brief Whether the Step benefits from ```execute_batch()```; if so, a
+     * parallel Executor with a batch policy may collect the instances of
+     * this Step that are ready in independent runs into one call (see
+     * ```Executor::set_batch_policy()```).
+     * @note The base implementation returns false.
+     */
+    virtual bool is_batchable() const;
+
+    /**
+     * @brief Executes the Step for several independent runs at once, e.g.
+     * to share setup such as kernel construction.
+     * @param batch The data array of each run, each as for ```execute()```.
+     * @note The base implementation calls ```execute()``` for each run.
+     */
+    virtual void execute_batch(const std::vector<std::vector<VarData>*>& batch);
+
+public:
+    /**
+     * @brief Declares the resources the Step holds while it executes on the
+     * given data, e.g. scratch bytes proportional to the input size, or a
+     * named token that limits how many such Steps run at once.
+     * @note Called on the gathered data, before execution; only consulted
+     * by an Executor with a ResourceManager. The base implementation
+     * returns an empty demand.
+     */
+    virtual ResourceDemand resource_demand(const std::vector<VarData>& data) const;
+
+    /**
+     * @brief Infers the metadata (shape and element type) of the outputs
+     * from the metadata of the inputs, without executing (see
+     * ShapeInference).
+     *
+     * @param metas One entry per data item, in StepInfo order. On entry, the
+     * inputs are set where known; the Step sets the outputs it can infer.
+     *
+     * @note The base implementation infers nothing; outputs stay unknown.
+     */
+    virtual void infer_meta(std::vector<std::optional<DataMeta>>& metas) const;
+
+public:
+    /**
+     * @brief Whether the Step has setup to do before executing (see
+     * ```prepare()```); if not, the Executor never calls it.
+     * @note The base implementation returns false.
+     */
+    virtual bool needs_prepare() const;
+
+    /**
+     * @brief Does the one-time setup of the Step for inputs of the given
+     * metadata: allocating scratch buffers, precomputing tables, so that
+     * the hot ```execute()``` path does no setup work.
+     *
+     * @param metas One entry per data item, in StepInfo order: the inputs
+     * as described, and the outputs as inferred by ```infer_meta()```.
+     *
+     * @details Called through ```ensure_prepared()```, once for each
+     * distinct metadata, before the first execution on it. It may run while
+     * other runs execute the Step on inputs of other metadata, so it must
+     * not invalidate the state they use; typically it adds to a table keyed
+     * by shape, or sets up state that does not depend on the shape once.
+     *
+     * @note The base implementation does nothing.
+     */
+    virtual void prepare(const std::vector<std::optional<DataMeta>>& metas);
+
+    /**
+     * @brief Calls ```prepare()``` unless the Step is already prepared for
+     * the input metadata; concurrent callers for the same metadata wait for
+     * it.
+     *
+     * @param metas One entry per data item, in StepInfo order; only the
+     * inputs are set. The outputs are inferred by ```infer_meta()``` before
+     * ```prepare()``` is called, i.e. only when preparing.
+     *
+     * @details The metadata prepared for are kept in a cache of at most
+     * ```prepared_capacity``` entries, which is read without locking; once
+     * full, the least recently used entry is dropped, and ```prepare()```
+     * is called again if its metadata come back. The entry used last is
+     * compared first, so that executions on an unchanged shape do no more
+     * than that comparison. ```prepare()``` itself runs outside the lock of
+     * the cache, so that preparing for one shape does not hold up
+     * executions on the others. If it throws, the next caller for the
+     * metadata tries again.
+     *
+     * @note Called by the Executor before executing a Step that
+     * ```needs_prepare()```.
+     */
+    void ensure_prepared(const std::vector<std::optional<DataMeta>>& metas);
+
+    /**
+     * @brief The number of distinct metadata in the cache of
+     * ```ensure_prepared()```; at most ```prepared_capacity```.
+     */
+    size_t prepared_count() const;
+
+    static constexpr size_t prepared_capacity = 16u;
+
 protected:
     /**
      * @brief Initialize Step as a base class.
@@ -94,6 +256,46 @@ private:
     StepInfoPtr m_step_info;
     bool m_init_fault;
     bool m_exec_fault;
+
+    /**
+     * @brief Metadata the Step is prepared, or being prepared, for.
+     */
+    struct PreparedEntry
+    {
+        std::vector<std::optional<DataMeta>> m_metas;
+        size_t m_hash;
+
+        /**
+         * @brief Set once ```prepare()``` has returned; the mutex makes the
+         * other callers for the same metadata wait for it.
+         */
+        std::atomic<bool> m_is_prepared;
+        std::mutex m_mutex;
+
+        /**
+         * @brief The insertion count when last used; compared on eviction.
+         */
+        std::atomic<size_t> m_last_use;
+
+        /**
+         * @brief Set once dropped from the cache, so that it is no longer
+         * found as the entry used last.
+         */
+        std::atomic<bool> m_is_evicted;
+    };
+    using PreparedList = std::vector<std::shared_ptr<PreparedEntry>>;
+
+    static size_t stc_hash_metas(const std::vector<std::optional<DataMeta>>& metas);
+    static std::shared_ptr<PreparedEntry> stc_find_prepared(const PreparedList& list, size_t hash, const std::vector<std::optional<DataMeta>>& metas);
+
+    /**
+     * @brief The cache of ```ensure_prepared()```: an immutable list,
+     * loaded and replaced atomically; the mutex only orders the writers.
+     */
+    std::mutex m_prepare_mutex;
+    std::shared_ptr<const PreparedList> m_sp_prepared;
+    std::shared_ptr<PreparedEntry> m_sp_last_prepared;
+    std::atomic<size_t> m_prepare_clock;
 };
 
 } // namespace tg::core
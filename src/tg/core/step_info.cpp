@@ -15,6 +15,7 @@ StepInfo::StepInfo()
     , m_names_frozen{false}
     , m_scope_frozen{false}
     , m_datainfos_frozen{false}
+    , m_nested{false}
 {}
 
 StepInfo::StepInfo(std::string_view shortname)
@@ -38,6 +39,7 @@ StepInfo::StepInfo(const StepInfo& other)
     , m_names_frozen{false}
     , m_scope_frozen{false}
     , m_datainfos_frozen{false}
+    , m_nested{false}
 {
 }
 
@@ -49,6 +51,7 @@ StepInfo::StepInfo(StepInfo&& other)
     , m_names_frozen{false}
     , m_scope_frozen{false}
     , m_datainfos_frozen{false}
+    , m_nested{false}
 {
     other.m_step_shortname.clear();
     other.m_step_type = std::type_index(typeid(void));
@@ -200,6 +203,21 @@ void StepInfo::on_added_to_scope(size_t scope_owner_token, ScopeInfoPtr scopeinf
     m_wp_scopeinfo = scopeinfo; // weak ref
 }
 
+void StepInfo::on_nested_in_scope_step()
+{
+    if (m_nested.exchange(true))
+    {
+        throw std::invalid_argument(
+            "StepInfo::on_nested_in_scope_step(): Step " + m_step_shortname + " is already nested in a ScopeStep."
+        );
+    }
+}
+
+void StepInfo::on_released_from_scope_step()
+{
+    m_nested = false;
+}
+
 void StepInfo::set_shortname(std::string_view shortname)
 {
     if (m_names_frozen)
@@ -328,6 +346,25 @@ void StepInfo::mark_data_as_consume(std::string_view shortname)
     ref_usage = DataUsage::Consume;
 }
 
+void StepInfo::add_data(std::string_view shortname, DataUsage usage, std::type_index data_type)
+{
+    this->detail_add_data(std::string(shortname), usage, data_type);
+}
+
+void StepInfo::mark_data_as_optional(std::string_view shortname)
+{
+    if (m_datainfos_frozen)
+    {
+        throw StepInfoFrozen("");
+    }
+    auto idx_opt = this->find_data(shortname);
+    if (!idx_opt.has_value())
+    {
+        throw StepInfoNameNotFound("");
+    }
+    m_datainfos.at(idx_opt.value()).m_optional = true;
+}
+
 size_t StepInfo::detail_add_data(std::string&& shortname, DataUsage usage, std::type_index data_type)
 {
     if (m_datainfos_frozen)
@@ -139,6 +139,25 @@ public: // Definitions of Step information.
      */
     void on_added_to_scope(size_t scope_owner_token, ScopeInfoPtr scopeinfo);
 
+    /**
+     * @brief This method is called by ScopeStep when the Scope of the Step
+     * is nested in it.
+     *
+     * @details A ScopeStep runs the Steps of its nested Scope as its own
+     * (inlined into the parent Plan, or in its sub-Executor), so a Step
+     * may be nested in one ScopeStep at a time; otherwise the same Step
+     * object would run at two places of a Plan, sharing its state.
+     *
+     * @exception std::invalid_argument if the Step is already nested.
+     */
+    void on_nested_in_scope_step();
+
+    /**
+     * @brief This method is called by the ScopeStep that nested the Step
+     * when it is destroyed.
+     */
+    void on_released_from_scope_step();
+
 public: // Definitions of data information.
 
     /**
@@ -194,6 +213,15 @@ public: // Definitions of data information.
         this->detail_add_data(std::string(shortname), usage, std::type_index(typeid(T)));
     }
 
+    /**
+     * @brief Adds a new data definition whose type is only known at runtime,
+     * such as data forwarded to or from a compiled subgraph.
+     * @exception StepInfoFrozen if the StepInfo is frozen.
+     * @exception StepInfoNameConflict if there is a data definition with
+     *            the same short name.
+     */
+    void add_data(std::string_view shortname, DataUsage usage, std::type_index data_type);
+
     /**
      * @brief Finds the index of a data item by its short name.
      * @returns The index of the data item, or std::nullopt if not found.
@@ -221,6 +249,19 @@ public: // Definitions of data information.
      */
     void mark_data_as_consume(std::string_view shortname);
 
+    /**
+     * @brief Marks the specified data as optional.
+     *
+     * @details For an output (Write), the Step may leave the data unproduced;
+     * the Executor then treats it as never produced, and cancels the Steps
+     * that require it. For an input (Read or Consume), the Step is executed
+     * even if the data was never produced, and is given an empty VarData.
+     *
+     * @exception StepInfoFrozen if the StepInfo is frozen.
+     * @exception StepInfoNameNotFound if the short name is not found.
+     */
+    void mark_data_as_optional(std::string_view shortname);
+
 private:
     void detail_set_step_type(std::type_index type);
     size_t detail_add_data(std::string&& shortname, DataUsage usage, std::type_index data_type);
@@ -233,6 +274,7 @@ private:
     std::atomic<bool> m_names_frozen;
     std::atomic<bool> m_scope_frozen;
     std::atomic<bool> m_datainfos_frozen;
+    std::atomic<bool> m_nested;
 };
 
 } // namespace tg::core
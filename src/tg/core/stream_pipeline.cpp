@@ -0,0 +1,121 @@
+#include "tg/core/stream_pipeline.hpp"
+#include "tg/core/data_info_tuple.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+
+namespace tg::core
+{
+
+StreamPipeline::StreamPipeline(PlanPtr plan, ThreadPoolPtr pool)
+    : m_sp_plan{std::move(plan)}
+    , m_executor{std::move(pool)}
+    , m_replace_mutex{}
+    , m_sp_table{}
+    , m_version{0u}
+{
+    if (!m_sp_plan)
+    {
+        throw std::invalid_argument("StreamPipeline::StreamPipeline(): plan cannot be null.");
+    }
+    auto table = std::make_shared<StepTable>();
+    for (size_t step_index = 0u; step_index < m_sp_plan->step_count(); ++step_index)
+    {
+        table->push_back(m_sp_plan->step_at(step_index).m_step);
+    }
+    m_sp_table = std::move(table);
+}
+
+StreamPipeline::~StreamPipeline()
+{
+}
+
+const Plan& StreamPipeline::plan() const
+{
+    return *m_sp_plan;
+}
+
+void StreamPipeline::process(std::vector<VarData>& slots) const
+{
+    // The snapshot keeps this frame's versions alive until it finishes.
+    StepTablePtr table = this->snapshot();
+    m_executor.run(*m_sp_plan, slots, *table);
+}
+
+StepTablePtr StreamPipeline::snapshot() const
+{
+    return std::atomic_load(&m_sp_table);
+}
+
+void StreamPipeline::replace_step(size_t step_index, StepPtr step)
+{
+    this->replace_steps({{step_index, std::move(step)}});
+}
+
+void StreamPipeline::replace_steps(const std::vector<std::pair<size_t, StepPtr>>& replacements)
+{
+    std::lock_guard<std::mutex> lock(m_replace_mutex);
+    StepTablePtr current = this->snapshot();
+    auto next = std::make_shared<StepTable>(*current);
+    for (const auto& [step_index, step] : replacements)
+    {
+        if (step_index >= next->size() || !next->at(step_index))
+        {
+            throw std::invalid_argument("StreamPipeline::replace_steps(): no such step.");
+        }
+        if (!step)
+        {
+            throw std::invalid_argument("StreamPipeline::replace_steps(): step cannot be null.");
+        }
+        stc_check_compatible(*next->at(step_index), *step);
+        next->at(step_index) = step;
+    }
+    std::atomic_store(&m_sp_table, StepTablePtr{std::move(next)});
+    ++m_version;
+}
+
+std::optional<size_t> StreamPipeline::find_step(std::string_view shortname) const
+{
+    StepTablePtr table = this->snapshot();
+    for (size_t step_index = 0u; step_index < table->size(); ++step_index)
+    {
+        const StepPtr& step = table->at(step_index);
+        if (step && step->info().shortname() == shortname)
+        {
+            return step_index;
+        }
+    }
+    return std::nullopt;
+}
+
+size_t StreamPipeline::version() const
+{
+    return m_version.load();
+}
+
+void StreamPipeline::stc_check_compatible(Step& current, Step& replacement)
+{
+    std::vector<DataInfoTuple> current_infos;
+    std::vector<DataInfoTuple> replacement_infos;
+    current.info().get_data_infos(current_infos);
+    replacement.info().get_data_infos(replacement_infos);
+    bool compatible = (current_infos.size() == replacement_infos.size());
+    for (size_t k = 0u; compatible && k < current_infos.size(); ++k)
+    {
+        const auto& lhs = current_infos.at(k);
+        const auto& rhs = replacement_infos.at(k);
+        compatible = lhs.m_shortname == rhs.m_shortname &&
+            lhs.m_usage == rhs.m_usage &&
+            lhs.m_type == rhs.m_type &&
+            lhs.m_optional == rhs.m_optional;
+    }
+    if (!compatible)
+    {
+        throw std::invalid_argument(
+            "StreamPipeline::replace_steps(): " + replacement.info().shortname() +
+            ": data does not match the replaced Step " + current.info().shortname() + "."
+        );
+    }
+}
+
+} // namespace tg::core
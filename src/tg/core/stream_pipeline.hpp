@@ -0,0 +1,101 @@
+#pragma once
+#include "tg/core/fwd.hpp"
+#include "tg/core/executor.hpp"
+
+namespace tg::core
+{
+
+/**
+ * @brief Runs a compiled Plan over a stream of frames, and lets Steps be
+ * replaced while frames are in flight (hot swap).
+ *
+ * @details The Step objects in use are kept in an immutable StepTable,
+ * published through an atomic shared pointer. Each frame takes a snapshot
+ * of the table when it starts and runs entirely on it; a replacement
+ * publishes a new table. Hence frames already in flight finish on the old
+ * versions (kept alive by their snapshot), while frames started afterwards
+ * pick up the new ones, without draining the pipeline.
+ *
+ * ```process()``` may be called concurrently from several threads, one
+ * frame per call. Replacements are serialized among themselves; taking a
+ * snapshot never blocks.
+ *
+ * A replacement must have the same data (short names, usage, types and
+ * optionality) as the Step it replaces, since the binding of the Plan is
+ * reused as is; e.g. a BlurStep with new sigmas, or another implementation
+ * of the same StepInfo.
+ *
+ * @note The Plan must not be edited while the pipeline is in use.
+ */
+class StreamPipeline
+{
+public:
+    /**
+     * @param plan The compiled Plan.
+     * @param pool The pool for the Executor, or null to run each frame
+     * sequentially on the calling thread.
+     */
+    explicit StreamPipeline(PlanPtr plan, ThreadPoolPtr pool = nullptr);
+    ~StreamPipeline();
+
+public:
+    const Plan& plan() const;
+
+    /**
+     * @brief Processes one frame on the current versions of the Steps.
+     * @param slots The slot array of the frame (see Executor).
+     */
+    void process(std::vector<VarData>& slots) const;
+
+    /**
+     * @brief The current versions of the Steps, by step index.
+     */
+    StepTablePtr snapshot() const;
+
+    /**
+     * @brief Replaces one Step for all frames started from now on.
+     * @exception std::invalid_argument if there is no such live Step, or if
+     * the replacement has different data.
+     */
+    void replace_step(size_t step_index, StepPtr step);
+
+    /**
+     * @brief Replaces several Steps at once; a frame sees either all of the
+     * replacements or none of them.
+     * @exception std::invalid_argument as for ```replace_step()```; then
+     * nothing is replaced.
+     */
+    void replace_steps(const std::vector<std::pair<size_t, StepPtr>>& replacements);
+
+    /**
+     * @brief Finds the index of the first live Step with the given short name.
+     */
+    std::optional<size_t> find_step(std::string_view shortname) const;
+
+    /**
+     * @brief The number of replacements published so far.
+     */
+    size_t version() const;
+
+private:
+    static void stc_check_compatible(Step& current, Step& replacement);
+
+private:
+    StreamPipeline(const StreamPipeline&) = delete;
+    StreamPipeline(StreamPipeline&&) = delete;
+    StreamPipeline& operator=(const StreamPipeline&) = delete;
+    StreamPipeline& operator=(StreamPipeline&&) = delete;
+
+private:
+    PlanPtr m_sp_plan;
+    Executor m_executor;
+    std::mutex m_replace_mutex;
+
+    /**
+     * @note Accessed only with ```std::atomic_load``` and ```std::atomic_store```.
+     */
+    StepTablePtr m_sp_table;
+    std::atomic<size_t> m_version;
+};
+
+} // namespace tg::core
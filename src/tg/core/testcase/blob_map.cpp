@@ -0,0 +1,38 @@
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include "tg/core/testcase/blob_map.hpp"
+
+namespace tg::core::testcase
+{
+
+MapStep::ItemCountFunc BlobMap::make_count_func(size_t stats_index)
+{
+    return [stats_index](const std::vector<VarData>& data) -> size_t {
+        const cv::Mat& stats = data.at(stats_index).as<cv::Mat>();
+        return (stats.rows > 1) ? static_cast<size_t>(stats.rows - 1) : 0u;
+    };
+}
+
+MapStep::ItemBindFunc BlobMap::make_bind_func(
+    size_t image_index, size_t stats_index,
+    size_t item_image_slot, std::optional<size_t> item_stats_slot)
+{
+    return [=](size_t item_index, const std::vector<VarData>& data, std::vector<VarData>& item_slots) {
+        const cv::Mat& image = data.at(image_index).as<cv::Mat>();
+        const cv::Mat& stats = data.at(stats_index).as<cv::Mat>();
+        const int row = static_cast<int>(item_index) + 1; // skip background
+        const cv::Rect bbox{
+            stats.at<int>(row, cv::CC_STAT_LEFT),
+            stats.at<int>(row, cv::CC_STAT_TOP),
+            stats.at<int>(row, cv::CC_STAT_WIDTH),
+            stats.at<int>(row, cv::CC_STAT_HEIGHT)
+        };
+        item_slots.at(item_image_slot).emplace<cv::Mat>(image(bbox));
+        if (item_stats_slot.has_value())
+        {
+            item_slots.at(item_stats_slot.value()).emplace<cv::Mat>(stats.rowRange(row, row + 1));
+        }
+    };
+}
+
+} // namespace tg::core::testcase
@@ -0,0 +1,35 @@
+#pragma once
+#include "tg/core/map_step.hpp"
+
+namespace tg::core::testcase
+{
+
+/**
+ * @brief Item functions for a MapStep over the connected components found
+ * by ConnCompStep.
+ *
+ * @details The items are the rows of the ```stats``` matrix, except row 0
+ * which is the background. Each item is given a zero-copy view of the image
+ * cropped to the bounding box of the component, and a zero-copy view of its
+ * row of ```stats```.
+ */
+struct BlobMap
+{
+    /**
+     * @param stats_index Local data index of ```stats``` in the MapStep.
+     */
+    static MapStep::ItemCountFunc make_count_func(size_t stats_index);
+
+    /**
+     * @param image_index Local data index of the image in the MapStep.
+     * @param stats_index Local data index of ```stats``` in the MapStep.
+     * @param item_image_slot Slot index for the cropped image in the item Plan.
+     * @param item_stats_slot Slot index for the stats row in the item Plan,
+     * if the item Plan uses it.
+     */
+    static MapStep::ItemBindFunc make_bind_func(
+        size_t image_index, size_t stats_index,
+        size_t item_image_slot, std::optional<size_t> item_stats_slot = std::nullopt);
+};
+
+} // namespace tg::core::testcase
@@ -0,0 +1,23 @@
+#include "tg/core/testcase/blur_conncomp_plan.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/testcase/blur_step.hpp"
+#include "tg/core/testcase/conncomp_step.hpp"
+
+namespace tg::core::testcase
+{
+
+PlanPtr make_blur_conncomp_plan()
+{
+    auto blur = std::make_shared<BlurStep>(1.0, 1.0);
+    blur->info().rename_data("output", "smooth");
+    auto conncomp = std::make_shared<ConnCompStep>();
+    conncomp->info().rename_data("input", "smooth");
+    Scope scope("blur_conncomp_scope");
+    scope.add(blur);
+    scope.add(conncomp);
+    scope.freeze();
+    return std::make_shared<Plan>(scope);
+}
+
+} // namespace tg::core::testcase
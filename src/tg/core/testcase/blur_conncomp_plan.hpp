@@ -0,0 +1,17 @@
+#pragma once
+#include "tg/core/fwd.hpp"
+
+namespace tg::core::testcase
+{
+
+/**
+ * @brief Compiles a Plan of BlurStep followed by ConnCompStep.
+ *
+ * @details The global input is ```input```; the blurred image is
+ * ```smooth```, and the outputs are those of ConnCompStep (```labels```,
+ * ```stats```, ```centroids```). The extents of ```stats``` and
+ * ```centroids``` depend on the data.
+ */
+PlanPtr make_blur_conncomp_plan();
+
+} // namespace tg::core::testcase
@@ -1,12 +1,68 @@
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 #include "tg/core/testcase/blur_step.hpp"
+#include "tg/core/scratch_arena.hpp"
+#include "tg/opencv/buffer_types.hpp"
 
 namespace tg::core::testcase
 {
 
+/**
+ * @brief The clamped sigmas and the kernel size; computing them is the
+ * setup done once by ```BlurStep::prepare()```.
+ */
+struct BlurParams
+{
+    double m_sigmax;
+    double m_sigmay;
+    cv::Size m_ksize;
+};
+
+namespace //(unnamed)
+{
+
+BlurParams make_blur_params(double sigmax_in, double sigmay_in)
+{
+    /**
+     * @note Workaround for OpenCV bug require sigmax and sigmay to be strictly positive.
+     */
+    const double sigmin = 1.0e-3;
+    double sigmax = std::max(sigmin, sigmax_in);
+    double sigmay = std::max(sigmin, sigmay_in);
+    /**
+     * @note Kernel length required to be an odd integer for symmetry.
+     * @note For sigma < 0.5, kernel length of 1 is okay since there is practically no blurring.
+     */
+    auto ksize = cv::Size
+    {
+        cv::saturate_cast<int>(sigmax * 2.0) * 2 + 1,
+        cv::saturate_cast<int>(sigmay * 2.0) * 2 + 1
+    };
+    return BlurParams{sigmax, sigmay, ksize};
+}
+
+void apply_blur(const cv::Mat& source, cv::Mat& target, const BlurParams& params, int border)
+{
+    const auto algo = cv::ALGO_HINT_DEFAULT;
+    cv::GaussianBlur(source, target, params.m_ksize, params.m_sigmax, params.m_sigmay, border, algo);
+}
+
+cv::Rect to_local_rect(const RoiRect& rect, const RoiRect& origin)
+{
+    return cv::Rect{rect.m_x - origin.m_x, rect.m_y - origin.m_y, rect.m_width, rect.m_height};
+}
+
+} // namespace(unnamed)
+
 BlurStep::BlurStep()
+    : BlurStep{1.0, 1.0}
+{}
+
+BlurStep::BlurStep(double sigmax, double sigmay)
     : Step{stc_make_info()}
+    , m_sigmax{sigmax}
+    , m_sigmay{sigmay}
+    , m_sp_params{}
 {}
 
 BlurStep::~BlurStep()
@@ -27,28 +83,135 @@ void BlurStep::execute(std::vector<VarData>& data)
 {
     this->pre_execute_validation(data);
     const cv::Mat& input = data.at(0).as<cv::Mat>();
+    apply_blur(input, tg::opencv::output_mat(data.at(1)), *this->detail_params(), cv::BORDER_DEFAULT);
+    this->post_execute_validation(data);
+}
 
+RoiHalo BlurStep::roi_halo() const
+{
+    const cv::Size ksize = this->detail_params()->m_ksize;
+    return RoiHalo{ksize.width / 2, ksize.height / 2};
+}
+
+void BlurStep::execute_roi(std::vector<VarData>& data, const StepRoi& roi)
+{
+    if (roi.m_output.is_full())
+    {
+        this->execute(data);
+        return;
+    }
+    this->pre_execute_validation(data);
+    const cv::Mat& input = data.at(0).as<cv::Mat>();
+    const RoiRect& input_origin = roi.m_data_rects.at(0);
+    const RoiRect input_extent{input_origin.m_x, input_origin.m_y, input.cols, input.rows};
+    const RoiRect output_rect = roi.m_output.intersect(input_extent);
+    if (output_rect.is_empty())
+    {
+        data.at(1).emplace<cv::Mat>();
+        this->post_execute_validation(data);
+        return;
+    }
+    const std::shared_ptr<const BlurParams> params = this->detail_params();
+    const RoiRect source_rect = output_rect.grow(
+        params->m_ksize.width / 2, params->m_ksize.height / 2
+    ).intersect(input_extent);
     /**
-     * @note Workaround for OpenCV bug require sigmax and sigmay to be strictly positive.
+     * @note The source includes the halo wherever the input has it. Where it
+     * does not, the source touches the true image border, so that isolating
+     * the source from the surrounding memory gives the same result as
+     * blurring the whole image.
      */
-    const double sigmin = 1.0e-3;
-    double sigmax = std::max(sigmin, m_sigmax);
-    double sigmay = std::max(sigmin, m_sigmay);
+    const cv::Mat source = input(to_local_rect(source_rect, input_extent));
+    // The blurred source, halo included, is a temporary of the worker.
+    const ScratchArena::Lease lease = ScratchArena::local().acquire(source.total() * source.elemSize());
+    cv::Mat blurred(source.rows, source.cols, source.type(), lease.data());
+    apply_blur(source, blurred, *params, cv::BORDER_DEFAULT | cv::BORDER_ISOLATED);
+    blurred(to_local_rect(output_rect, source_rect)).copyTo(tg::opencv::output_mat(data.at(1)));
+    this->post_execute_validation(data);
+}
+
+size_t BlurStep::begin_chunks(std::vector<VarData>& data)
+{
+    const cv::Mat& input = data.at(0).as<cv::Mat>();
+    const int chunk_count = input.rows / chunk_rows;
+    if (chunk_count < 2)
+    {
+        return 0u; // not worth splitting
+    }
+    this->pre_execute_validation(data);
+    tg::opencv::output_mat(data.at(1)).create(input.size(), input.type());
+    return static_cast<size_t>(chunk_count);
+}
+
+void BlurStep::execute_chunk(std::vector<VarData>& data, size_t chunk_index)
+{
+    const cv::Mat& input = data.at(0).as<cv::Mat>();
+    cv::Mat output = data.at(1).as<cv::Mat>();
+    const int chunk_count = input.rows / chunk_rows;
+    const int chunk = static_cast<int>(chunk_index);
+    const int row_begin = input.rows * chunk / chunk_count;
+    const int row_end = input.rows * (chunk + 1) / chunk_count;
+    const std::shared_ptr<const BlurParams> params = this->detail_params();
     /**
-     * @note Kernel length required to be an odd integer for symmetry.
-     * @note For sigma < 0.5, kernel length of 1 is okay since there is practically no blurring.
+     * @note Without BORDER_ISOLATED, the filter reads the rows around a
+     * row range from the parent image, and only extrapolates at the true
+     * image border; hence the chunks join seamlessly.
      */
-    auto ksize = cv::Size
-    {
-        cv::saturate_cast<int>(sigmax * 2.0) * 2 + 1,
-        cv::saturate_cast<int>(sigmay * 2.0) * 2 + 1
-    };
-    const int border = cv::BORDER_DEFAULT;
-    const auto algo = cv::ALGO_HINT_DEFAULT;
-    cv::Mat output;
-    cv::GaussianBlur(input, output, ksize, sigmax, sigmay, border, algo);    
-    data.at(1).emplace<cv::Mat>(output);
+    const cv::Mat source = input.rowRange(row_begin, row_end);
+    cv::Mat target = output.rowRange(row_begin, row_end);
+    apply_blur(source, target, *params, cv::BORDER_DEFAULT);
+}
+
+void BlurStep::end_chunks(std::vector<VarData>& data)
+{
     this->post_execute_validation(data);
 }
 
+bool BlurStep::is_batchable() const
+{
+    return true;
+}
+
+void BlurStep::execute_batch(const std::vector<std::vector<VarData>*>& batch)
+{
+    const std::shared_ptr<const BlurParams> params = this->detail_params();
+    for (std::vector<VarData>* p_data : batch)
+    {
+        std::vector<VarData>& data = *p_data;
+        this->pre_execute_validation(data);
+        apply_blur(data.at(0).as<cv::Mat>(), tg::opencv::output_mat(data.at(1)), *params, cv::BORDER_DEFAULT);
+        this->post_execute_validation(data);
+    }
+}
+
+void BlurStep::infer_meta(std::vector<std::optional<DataMeta>>& metas) const
+{
+    metas.at(1) = metas.at(0);
+}
+
+bool BlurStep::needs_prepare() const
+{
+    return true;
+}
+
+void BlurStep::prepare(const std::vector<std::optional<DataMeta>>& /*metas*/)
+{
+    // The parameters depend on sigma only; later shapes find them computed.
+    if (!std::atomic_load(&m_sp_params))
+    {
+        std::atomic_store(&m_sp_params, std::make_shared<const BlurParams>(make_blur_params(m_sigmax, m_sigmay)));
+    }
+}
+
+std::shared_ptr<const BlurParams> BlurStep::detail_params() const
+{
+    std::shared_ptr<const BlurParams> params = std::atomic_load(&m_sp_params);
+    if (!params)
+    {
+        // Not prepared, e.g. executed directly rather than by an Executor.
+        params = std::make_shared<const BlurParams>(make_blur_params(m_sigmax, m_sigmay));
+    }
+    return params;
+}
+
 } // namespace tg::core::testcase
@@ -5,22 +5,76 @@
 namespace tg::core::testcase
 {
 
+struct BlurParams;
+
 class BlurStep final
     : public Step
 {
 public:
     BlurStep();
+    BlurStep(double sigmax, double sigmay);
     ~BlurStep() final;
 
     using Step::info;
     void execute(std::vector<VarData>& data) final;
 
+    /**
+     * @brief The halo is half of the Gaussian kernel size.
+     */
+    RoiHalo roi_halo() const final;
+    void execute_roi(std::vector<VarData>& data, const StepRoi& roi) final;
+
+    /**
+     * @brief Splits the output into row ranges of about ```chunk_rows```
+     * rows; each chunk blurs its rows reading the halo rows around them, so
+     * the result is identical to ```execute()```.
+     */
+    size_t begin_chunks(std::vector<VarData>& data) final;
+    void execute_chunk(std::vector<VarData>& data, size_t chunk_index) final;
+    void end_chunks(std::vector<VarData>& data) final;
+
+    static constexpr int chunk_rows = 64;
+
+    /**
+     * @brief A batch blurs each of its images as ```execute()``` does, one
+     * ```cv::GaussianBlur``` call per image.
+     * @note Batching is scheduling-only here: it shares no setup beyond
+     * the parameters, which ```prepare()``` already computes once. The
+     * kernels are built inside each call (see ```prepare()```). The Step
+     * is batchable so that batching can be exercised end to end.
+     */
+    bool is_batchable() const final;
+    void execute_batch(const std::vector<std::vector<VarData>*>& batch) final;
+
+    /**
+     * @brief The output has the shape and type of the input.
+     */
+    void infer_meta(std::vector<std::optional<DataMeta>>& metas) const final;
+
+    /**
+     * @brief Computes the clamped sigmas and the kernel size once; every
+     * execution path then reuses them.
+     * @note The kernels themselves are left to ```cv::GaussianBlur```: for
+     * 8-bit images it builds fixed-point kernels internally, which a
+     * precomputed kernel passed to ```cv::sepFilter2D``` does not match.
+     */
+    bool needs_prepare() const final;
+    void prepare(const std::vector<std::optional<DataMeta>>& metas) final;
+
 private:
     static StepInfoPtr stc_make_info();
+    std::shared_ptr<const BlurParams> detail_params() const;
 
 private:
     double m_sigmax;
     double m_sigmay;
+
+    /**
+     * @brief The parameters computed by ```prepare()```; null until prepared.
+     * @note Accessed atomically, since runs on other shapes may prepare
+     * while the Step executes.
+     */
+    std::shared_ptr<const BlurParams> m_sp_params;
 };
 
 
@@ -1,10 +1,31 @@
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 #include "tg/core/testcase/conncomp_step.hpp"
+#include "tg/opencv/buffer_types.hpp"
 
 namespace tg::core::testcase
 {
 
+namespace //(unnamed)
+{
+
+/**
+ * @brief The most labels an image can have, background included: with
+ * 8-connectivity, one per isolated pixel of every other row and column;
+ * with 4-connectivity, one per square of a checkerboard.
+ */
+size_t max_label_count(int rows, int cols, int connectivity)
+{
+    const size_t rows_n = static_cast<size_t>(rows);
+    const size_t cols_n = static_cast<size_t>(cols);
+    const size_t components = (connectivity == 4)
+        ? (rows_n * cols_n + 1u) / 2u
+        : ((rows_n + 1u) / 2u) * ((cols_n + 1u) / 2u);
+    return components + 1u;
+}
+
+} // namespace(unnamed)
+
 ConnCompStep::ConnCompStep()
     : Step{stc_make_info()}
     , m_connectivity{8}
@@ -31,16 +52,36 @@ void ConnCompStep::execute(std::vector<VarData>& data)
 {
     this->pre_execute_validation(data);
     cv::Mat input = data.at(0).as<cv::Mat>();
-    cv::Mat labels;
-    cv::Mat stats;
-    cv::Mat centroids;
     cv::connectedComponentsWithStats(
-        input, labels, stats, centroids, m_connectivity, m_label_type
+        input,
+        tg::opencv::output_mat(data.at(1)),
+        tg::opencv::output_mat(data.at(2)),
+        tg::opencv::output_mat(data.at(3)),
+        m_connectivity, m_label_type
     );
-    data.at(1).emplace<cv::Mat>(labels);
-    data.at(2).emplace<cv::Mat>(stats);
-    data.at(3).emplace<cv::Mat>(centroids);
     this->post_execute_validation(data);
 }
 
+ResourceDemand ConnCompStep::resource_demand(const std::vector<VarData>& data) const
+{
+    const cv::Mat& input = data.at(0).as<cv::Mat>();
+    const size_t label_bytes = input.total() * static_cast<size_t>(CV_ELEM_SIZE(m_label_type));
+    // One stats row and one centroid per label, at the worst-case label count.
+    const size_t row_bytes = static_cast<size_t>(cv::CC_STAT_MAX) * sizeof(int32_t) + 2u * sizeof(double);
+    const size_t stats_bytes = max_label_count(input.rows, input.cols, m_connectivity) * row_bytes;
+    return ResourceDemand{label_bytes + stats_bytes, {{"ccl-slot", 1u}}};
+}
+
+void ConnCompStep::infer_meta(std::vector<std::optional<DataMeta>>& metas) const
+{
+    if (!metas.at(0).has_value())
+    {
+        return;
+    }
+    const DataMeta& input = metas.at(0).value();
+    metas.at(1) = DataMeta{input.m_rows, input.m_cols, m_label_type, static_cast<size_t>(CV_ELEM_SIZE(m_label_type))};
+    metas.at(2) = DataMeta{DataMeta::unknown_extent, cv::CC_STAT_MAX, CV_32S, sizeof(int32_t)};
+    metas.at(3) = DataMeta{DataMeta::unknown_extent, 2, CV_64F, sizeof(double)};
+}
+
 } // namespace tg::core::testcase
@@ -15,6 +15,18 @@ public:
     using Step::info;
     void execute(std::vector<VarData>& data) final;
 
+    /**
+     * @brief The label image, and the stats and centroids at the worst-case
+     * label count, as scratch; and one ```"ccl-slot"``` token.
+     */
+    ResourceDemand resource_demand(const std::vector<VarData>& data) const final;
+
+    /**
+     * @brief CV_32S labels of the input shape; N x 5 CV_32S stats and N x 2
+     * CV_64F centroids, where the label count N is not known in advance.
+     */
+    void infer_meta(std::vector<std::optional<DataMeta>>& metas) const final;
+
 private:
     static StepInfoPtr stc_make_info();
 
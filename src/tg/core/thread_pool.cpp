@@ -0,0 +1,355 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include "tg/core/thread_pool.hpp"
+
+namespace tg::core
+{
+
+namespace //(unnamed)
+{
+
+thread_local ThreadPool* tls_pool = nullptr;
+thread_local size_t tls_worker = ThreadPool::npos;
+thread_local TaskPriority tls_priority = TaskPriority::Latency;
+
+size_t batch_period_of(double share)
+{
+    return (share > 0.0) ? std::max<size_t>(1u, static_cast<size_t>(std::lround(1.0 / share))) : 0u;
+}
+
+} // namespace(unnamed)
+
+ThreadPool::ThreadPool(size_t thread_count)
+    : m_workers{}
+    , m_threads{}
+    , m_inject_mutex{}
+    , m_inject{}
+    , m_sleep_mutex{}
+    , m_sleep_cv{}
+    , m_pending{0u}
+    , m_batch_period{batch_period_of(default_batch_share)}
+    , m_pick_count{0u}
+    , m_stop{false}
+{
+    if (thread_count == 0u)
+    {
+        thread_count = std::max<size_t>(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t worker_index = 0u; worker_index < thread_count; ++worker_index)
+    {
+        m_workers.emplace_back(std::make_unique<Worker>());
+    }
+    for (size_t worker_index = 0u; worker_index < thread_count; ++worker_index)
+    {
+        m_threads.emplace_back([this, worker_index]() {
+            this->detail_worker_loop(worker_index);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_stop = true;
+    }
+    m_sleep_cv.notify_all();
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+size_t ThreadPool::thread_count() const
+{
+    return m_threads.size();
+}
+
+void ThreadPool::submit(Task task)
+{
+    this->submit(std::move(task), tls_priority);
+}
+
+void ThreadPool::submit(Task task, TaskPriority priority)
+{
+    if (!task)
+    {
+        throw std::invalid_argument("ThreadPool::submit(): task cannot be empty.");
+    }
+    const size_t lane = static_cast<size_t>(priority);
+    m_pending.fetch_add(1u);
+    if (tls_pool == this && tls_worker != npos)
+    {
+        Worker& worker = *m_workers.at(tls_worker);
+        std::lock_guard<std::mutex> lock(worker.m_mutex);
+        worker.m_tasks.at(lane).push_back(std::move(task));
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(m_inject_mutex);
+        m_inject.at(lane).push_back(std::move(task));
+    }
+    {
+        // Pairs with the predicate check of sleeping workers.
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+    }
+    m_sleep_cv.notify_one();
+}
+
+void ThreadPool::set_batch_share(double share)
+{
+    if (!(share >= 0.0 && share <= 1.0))
+    {
+        throw std::invalid_argument("ThreadPool::set_batch_share(): share must be in [0, 1].");
+    }
+    m_batch_period = batch_period_of(share);
+}
+
+double ThreadPool::batch_share() const
+{
+    const size_t period = m_batch_period.load();
+    return (period > 0u) ? 1.0 / static_cast<double>(period) : 0.0;
+}
+
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)>& body)
+{
+    if (count == 0u)
+    {
+        return;
+    }
+    struct ForState
+    {
+        std::atomic<size_t> m_next{0u};
+        std::atomic<size_t> m_done{0u};
+        size_t m_count{0u};
+        const std::function<void(size_t)>* m_body{nullptr};
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::exception_ptr m_error;
+    };
+    auto state = std::make_shared<ForState>();
+    state->m_count = count;
+    state->m_body = &body;
+    /**
+     * @note A helper only dereferences the body after claiming an index
+     * below the count, which cannot happen after parallel_for() returns.
+     */
+    auto drain = [state]() {
+        while (true)
+        {
+            const size_t index = state->m_next.fetch_add(1u);
+            if (index >= state->m_count)
+            {
+                return;
+            }
+            try
+            {
+                (*state->m_body)(index);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(state->m_mutex);
+                if (!state->m_error)
+                {
+                    state->m_error = std::current_exception();
+                }
+            }
+            if (state->m_done.fetch_add(1u) + 1u == state->m_count)
+            {
+                std::lock_guard<std::mutex> lock(state->m_mutex);
+                state->m_cv.notify_all();
+            }
+        }
+    };
+    const size_t helper_count = std::min(count - 1u, this->thread_count());
+    for (size_t helper = 0u; helper < helper_count; ++helper)
+    {
+        this->submit(drain);
+    }
+    drain();
+    while (state->m_done.load() < count)
+    {
+        if (this->try_run_one())
+        {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(state->m_mutex);
+        state->m_cv.wait_for(lock, std::chrono::milliseconds(1), [&state, count]() {
+            return state->m_done.load() >= count;
+        });
+    }
+    if (state->m_error)
+    {
+        std::rethrow_exception(state->m_error);
+    }
+}
+
+bool ThreadPool::try_run_one()
+{
+    Task task;
+    TaskPriority priority = TaskPriority::Latency;
+    if (!this->detail_pop(task, priority))
+    {
+        return false;
+    }
+    /**
+     * @note A thread from outside the pool that helps running a task is
+     * given this pool as its current pool for the duration of the task,
+     * so that the task can use ```current()``` regardless of which thread
+     * it runs on. Such a thread has no deque of its own.
+     */
+    ThreadPool* const saved_pool = tls_pool;
+    const size_t saved_worker = tls_worker;
+    const TaskPriority saved_priority = tls_priority;
+    if (saved_pool != this)
+    {
+        tls_pool = this;
+        tls_worker = npos;
+    }
+    tls_priority = priority;
+    try
+    {
+        task();
+    }
+    catch (...)
+    {
+        // Tasks must not throw; see class notes.
+    }
+    tls_pool = saved_pool;
+    tls_worker = saved_worker;
+    tls_priority = saved_priority;
+    return true;
+}
+
+ThreadPool* ThreadPool::current()
+{
+    return tls_pool;
+}
+
+size_t ThreadPool::current_worker()
+{
+    return tls_worker;
+}
+
+TaskPriority ThreadPool::current_priority()
+{
+    return tls_priority;
+}
+
+ScratchArena* ThreadPool::current_scratch()
+{
+    if (!tls_pool || tls_worker == npos)
+    {
+        return nullptr;
+    }
+    return &tls_pool->m_workers.at(tls_worker)->m_scratch;
+}
+
+size_t ThreadPool::scratch_capacity() const
+{
+    size_t capacity = 0u;
+    for (const auto& worker : m_workers)
+    {
+        capacity += worker->m_scratch.capacity();
+    }
+    return capacity;
+}
+
+void ThreadPool::detail_worker_loop(size_t worker_index)
+{
+    tls_pool = this;
+    tls_worker = worker_index;
+    while (true)
+    {
+        if (this->try_run_one())
+        {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_sleep_mutex);
+        m_sleep_cv.wait(lock, [this]() {
+            return m_stop.load() || m_pending.load() > 0u;
+        });
+        if (m_stop.load() && m_pending.load() == 0u)
+        {
+            break;
+        }
+    }
+    tls_pool = nullptr;
+    tls_worker = npos;
+}
+
+bool ThreadPool::detail_pop(Task& task, TaskPriority& priority)
+{
+    const size_t latency_lane = static_cast<size_t>(TaskPriority::Latency);
+    const size_t batch_lane = static_cast<size_t>(TaskPriority::Batch);
+    const size_t period = m_batch_period.load(std::memory_order_relaxed);
+    // Read here, counted only on success: idle workers polling empty lanes
+    // neither skew the turns nor contend on the counter.
+    const bool batch_turn = (period > 0u) && (m_pick_count.load(std::memory_order_relaxed) % period == period - 1u);
+    const size_t first_lane = batch_turn ? batch_lane : latency_lane;
+    const size_t second_lane = batch_turn ? latency_lane : batch_lane;
+    for (size_t lane : {first_lane, second_lane})
+    {
+        if (this->detail_pop_lane(task, lane))
+        {
+            m_pick_count.fetch_add(1u, std::memory_order_relaxed);
+            priority = static_cast<TaskPriority>(lane);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::detail_pop_lane(Task& task, size_t lane)
+{
+    const size_t worker_count = m_workers.size();
+    const bool is_own_worker = (tls_pool == this && tls_worker != npos);
+    if (is_own_worker)
+    {
+        Worker& own = *m_workers.at(tls_worker);
+        std::lock_guard<std::mutex> lock(own.m_mutex);
+        auto& tasks = own.m_tasks.at(lane);
+        if (!tasks.empty())
+        {
+            task = std::move(tasks.back());
+            tasks.pop_back();
+            m_pending.fetch_sub(1u);
+            return true;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_inject_mutex);
+        auto& tasks = m_inject.at(lane);
+        if (!tasks.empty())
+        {
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            m_pending.fetch_sub(1u);
+            return true;
+        }
+    }
+    const size_t start = is_own_worker ? (tls_worker + 1u) : 0u;
+    for (size_t offset = 0u; offset < worker_count; ++offset)
+    {
+        const size_t victim_index = (start + offset) % worker_count;
+        if (is_own_worker && victim_index == tls_worker)
+        {
+            continue;
+        }
+        Worker& victim = *m_workers.at(victim_index);
+        std::lock_guard<std::mutex> lock(victim.m_mutex);
+        auto& tasks = victim.m_tasks.at(lane);
+        if (!tasks.empty())
+        {
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            m_pending.fetch_sub(1u);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace tg::core
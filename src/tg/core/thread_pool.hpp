@@ -0,0 +1,168 @@
+#pragma once
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include "tg/core/fwd.hpp"
+#include "tg/core/scratch_arena.hpp"
+
+namespace tg::core
+{
+
+/**
+ * @brief A work-stealing thread pool shared by the Executor and the Steps.
+ *
+ * @details Each worker owns a deque of tasks. Tasks submitted from a worker
+ * go to the back of its own deque, and are taken back from the back (LIFO),
+ * which keeps related work on the same core. Tasks submitted from outside
+ * the pool go to a shared injection queue. An idle worker first drains its
+ * own deque, then the injection queue, then steals from the front (FIFO)
+ * of the other workers' deques.
+ *
+ * Tasks are queued in two priority lanes (see TaskPriority), each with the
+ * layout above. A worker looks for a latency-critical task everywhere
+ * (own deque, injection queue, other workers) before it takes a batch
+ * task, so interactive work is never queued behind bulk work. To keep
+ * batch work from starving, every n-th pick looks at the batch lane first,
+ * where n is the inverse of the batch share. A task submitted without a
+ * priority goes to the lane of the task that submits it, so the subtasks
+ * of batch work stay in the batch lane.
+ *
+ * Blocking calls made from inside a task (```parallel_for()```, or an
+ * Executor run nested in a Step) help by running pending tasks while they
+ * wait, so that nesting does not deadlock or idle the worker.
+ *
+ * @note Tasks must not throw; exceptions escaping a task are discarded.
+ */
+class ThreadPool
+{
+public:
+    using Task = std::function<void()>;
+    static constexpr size_t npos = ~static_cast<size_t>(0u);
+    static constexpr double default_batch_share = 0.1;
+
+public:
+    /**
+     * @brief Starts the worker threads.
+     * @param thread_count The number of workers; zero selects the number
+     * of hardware threads.
+     */
+    explicit ThreadPool(size_t thread_count = 0u);
+
+    /**
+     * @brief Runs all pending tasks, then stops and joins the workers.
+     */
+    ~ThreadPool();
+
+public:
+    size_t thread_count() const;
+
+    /**
+     * @brief Queues a task for execution, in the lane of the calling task
+     * (see ```current_priority()```).
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Queues a task for execution in the given lane.
+     */
+    void submit(Task task, TaskPriority priority);
+
+    /**
+     * @brief Sets the share of picks that prefer batch tasks when both
+     * lanes have work.
+     * @param share In ```[0, 1]```; zero gives latency-critical tasks strict
+     * priority. The default is ```default_batch_share```.
+     * @exception std::invalid_argument if the share is out of range.
+     */
+    void set_batch_share(double share);
+    double batch_share() const;
+
+    /**
+     * @brief Calls ```body(index)``` for each index in ```[0, count)```,
+     * distributed over the workers and the calling thread, and returns
+     * when all calls have finished.
+     * @exception Rethrows the first exception thrown by the body.
+     */
+    void parallel_for(size_t count, const std::function<void(size_t)>& body);
+
+    /**
+     * @brief Runs one pending task on the calling thread, if any.
+     * @returns True if a task was run.
+     */
+    bool try_run_one();
+
+    /**
+     * @brief Returns the pool of the calling thread, or null if the calling
+     * thread is neither a worker of any pool nor running a task for one.
+     */
+    static ThreadPool* current();
+
+    /**
+     * @brief Returns the index of the calling worker thread in its pool,
+     * or ```npos``` if the calling thread is not a worker.
+     */
+    static size_t current_worker();
+
+    /**
+     * @brief Returns the lane of the task running on the calling thread, or
+     * ```TaskPriority::Latency``` outside of any task.
+     */
+    static TaskPriority current_priority();
+
+    /**
+     * @brief Returns the scratch arena of the calling worker, or null if the
+     * calling thread is not a worker of a pool (see ```ScratchArena::local()```).
+     */
+    static ScratchArena* current_scratch();
+
+    /**
+     * @brief The total capacity of the scratch arenas of the workers.
+     */
+    size_t scratch_capacity() const;
+
+private:
+    static constexpr size_t lane_count = 2u;
+    using Lanes = std::array<std::deque<Task>, lane_count>;
+
+    struct Worker
+    {
+        std::mutex m_mutex;
+        Lanes m_tasks;
+
+        /**
+         * @brief Used only by the worker's own thread.
+         */
+        ScratchArena m_scratch;
+    };
+
+private:
+    void detail_worker_loop(size_t worker_index);
+    bool detail_pop(Task& task, TaskPriority& priority);
+    bool detail_pop_lane(Task& task, size_t lane);
+
+private:
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+
+private:
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+    std::mutex m_inject_mutex;
+    Lanes m_inject;
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_sleep_cv;
+    std::atomic<size_t> m_pending;
+
+    /**
+     * @brief Every n-th pick prefers the batch lane; zero for never. Only
+     * picks that found a task are counted.
+     */
+    std::atomic<size_t> m_batch_period;
+    std::atomic<size_t> m_pick_count;
+    std::atomic<bool> m_stop;
+};
+
+} // namespace tg::core
@@ -30,7 +30,8 @@ void StepInfoSummary::generate(TextLineCallback text_line_callback) const
             "(Data " + std::to_string(k) + ")" + 
             " (Name) " + dit.m_shortname + 
             " (Usage) " + uts_map.at(dit.m_usage) +
-            " (Type) " + dit.m_type.name()
+            " (Type) " + dit.m_type.name() +
+            (dit.m_optional ? " (Optional)" : "")
         );
     }
 }
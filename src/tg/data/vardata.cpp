@@ -66,6 +66,11 @@ bool VarData::has_value() const
     return static_cast<bool>(m_ptr.get());
 }
 
+bool VarData::is_unique() const
+{
+    return m_ptr.use_count() == 1;
+}
+
 bool VarData::operator!() const
 {
     return !m_ptr;
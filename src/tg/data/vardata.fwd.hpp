@@ -51,6 +51,13 @@ public:
     std::type_index type() const;
     void* raw() const;
     bool has_value() const;
+
+    /**
+     * @brief Whether no other VarData or ```std::shared_ptr``` refers to
+     * the stored data; false if empty.
+     */
+    bool is_unique() const;
+
     bool operator!() const;
     bool operator==(const VarData& other) const;
     bool operator!=(const VarData& other) const;
@@ -0,0 +1,28 @@
+#include "tg/opencv/buffer_types.hpp"
+#include "tg/core/buffer_pool.hpp"
+
+namespace tg::opencv
+{
+
+void register_buffer_types()
+{
+    tg::core::BufferPool::register_type<cv::Mat>(
+        [](const tg::core::DataMeta& meta) -> cv::Mat {
+            return cv::Mat(meta.m_rows, meta.m_cols, meta.m_type);
+        },
+        [](const cv::Mat& mat) -> bool {
+            return mat.u != nullptr && mat.u->refcount == 1;
+        }
+    );
+}
+
+cv::Mat& output_mat(tg::core::VarData& value)
+{
+    if (!value.has_value())
+    {
+        return value.emplace<cv::Mat>();
+    }
+    return value.as<cv::Mat>();
+}
+
+} // namespace tg::opencv
@@ -0,0 +1,25 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include "tg/core/fwd.hpp"
+
+namespace tg::opencv
+{
+
+/**
+ * @brief Registers ```cv::Mat``` with ```tg::core::BufferPool```, so that
+ * an Executor with a buffer pool preallocates the ```cv::Mat``` outputs
+ * whose shape is inferred. A pooled ```cv::Mat``` is reused once its
+ * reference count drops back to the pool's own.
+ * @note Idempotent.
+ */
+void register_buffer_types();
+
+/**
+ * @brief The ```cv::Mat``` a Step writes an output into: the preallocated
+ * one if the Executor placed one in the data item, otherwise a new empty
+ * one. OpenCV functions given it as destination then write into the
+ * existing storage when the size and type match.
+ */
+cv::Mat& output_mat(tg::core::VarData& value);
+
+} // namespace tg::opencv
@@ -0,0 +1,22 @@
+#include "tg/opencv/data_meta.hpp"
+
+namespace tg::opencv
+{
+
+tg::core::DataMeta to_data_meta(const cv::Mat& mat)
+{
+    return tg::core::DataMeta{mat.rows, mat.cols, mat.type(), mat.elemSize()};
+}
+
+void register_data_meta()
+{
+    tg::core::DataMeta::register_type<cv::Mat>([](const cv::Mat& mat) -> std::optional<tg::core::DataMeta> {
+        if (mat.dims > 2)
+        {
+            return std::nullopt;
+        }
+        return to_data_meta(mat);
+    });
+}
+
+} // namespace tg::opencv
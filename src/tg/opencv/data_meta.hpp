@@ -0,0 +1,22 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include "tg/core/fwd.hpp"
+#include "tg/core/data_meta.hpp"
+
+namespace tg::opencv
+{
+
+/**
+ * @brief Describes a ```cv::Mat``` as a DataMeta: its rows, columns, OpenCV
+ * type and element size.
+ */
+tg::core::DataMeta to_data_meta(const cv::Mat& mat);
+
+/**
+ * @brief Registers ```to_data_meta()``` with ```tg::core::DataMeta```, so
+ * that shape inference can describe ```cv::Mat``` inputs from their values.
+ * @note Idempotent.
+ */
+void register_data_meta();
+
+} // namespace tg::opencv
@@ -0,0 +1,15 @@
+#include <opencv2/core.hpp>
+#include "tg/opencv/data_sizes.hpp"
+#include "tg/core/data_size.hpp"
+
+namespace tg::opencv
+{
+
+void register_data_sizes()
+{
+    tg::core::DataSize::register_type<cv::Mat>([](const cv::Mat& mat) -> size_t {
+        return mat.total() * mat.elemSize();
+    });
+}
+
+} // namespace tg::opencv
@@ -0,0 +1,15 @@
+#pragma once
+#include "tg/core/fwd.hpp"
+
+namespace tg::opencv
+{
+
+/**
+ * @brief Registers the size functions of the OpenCV data types with
+ * ```tg::core::DataSize```, so that memory predictions account for them:
+ * a ```cv::Mat``` counts its pixel bytes.
+ * @note Idempotent.
+ */
+void register_data_sizes();
+
+} // namespace tg::opencv
@@ -0,0 +1,80 @@
+#include <algorithm>
+#include "tg/opencv/parallel_backend.hpp"
+#include "tg/core/thread_pool.hpp"
+
+namespace tg::opencv
+{
+
+ThreadPoolBackend::ThreadPoolBackend(tg::core::ThreadPoolPtr pool)
+    : m_sp_pool{std::move(pool)}
+{
+    if (!m_sp_pool)
+    {
+        throw std::invalid_argument("ThreadPoolBackend::ThreadPoolBackend(): pool cannot be null.");
+    }
+}
+
+ThreadPoolBackend::~ThreadPoolBackend()
+{
+}
+
+void ThreadPoolBackend::install(tg::core::ThreadPoolPtr pool)
+{
+    std::shared_ptr<cv::parallel::ParallelForAPI> backend;
+    if (pool)
+    {
+        backend = std::make_shared<ThreadPoolBackend>(std::move(pool));
+    }
+    cv::parallel::setParallelForBackend(backend);
+}
+
+void ThreadPoolBackend::parallel_for(int tasks, FN_parallel_for_body_cb_t body_callback, void* callback_data)
+{
+    if (tasks <= 0)
+    {
+        return;
+    }
+    if (tasks == 1)
+    {
+        body_callback(0, 1, callback_data);
+        return;
+    }
+    /**
+     * @note OpenCV already splits its range into ```tasks``` stripes; a few
+     * ranges per worker are enough for stealing to balance the load.
+     */
+    const size_t task_count = static_cast<size_t>(tasks);
+    const size_t range_count = std::min(task_count, m_sp_pool->thread_count() * 4u);
+    m_sp_pool->parallel_for(range_count, [&](size_t range_index) {
+        const int begin = static_cast<int>(task_count * range_index / range_count);
+        const int end = static_cast<int>(task_count * (range_index + 1u) / range_count);
+        body_callback(begin, end, callback_data);
+    });
+}
+
+int ThreadPoolBackend::getThreadNum() const
+{
+    const size_t worker = tg::core::ThreadPool::current_worker();
+    if (worker == tg::core::ThreadPool::npos || tg::core::ThreadPool::current() != m_sp_pool.get())
+    {
+        return static_cast<int>(m_sp_pool->thread_count());
+    }
+    return static_cast<int>(worker);
+}
+
+int ThreadPoolBackend::getNumThreads() const
+{
+    return static_cast<int>(m_sp_pool->thread_count()) + 1;
+}
+
+int ThreadPoolBackend::setNumThreads(int /*nThreads*/)
+{
+    return this->getNumThreads();
+}
+
+const char* ThreadPoolBackend::getName() const
+{
+    return "tg";
+}
+
+} // namespace tg::opencv
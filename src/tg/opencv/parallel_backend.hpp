@@ -0,0 +1,62 @@
+#pragma once
+#include <opencv2/core/parallel/parallel_backend.hpp>
+#include "tg/core/fwd.hpp"
+
+namespace tg::opencv
+{
+
+/**
+ * @brief An OpenCV parallel backend that runs the parallel regions of
+ * OpenCV (```cv::parallel_for_()```) on a tg ThreadPool.
+ *
+ * @details Without it, OpenCV functions called from Steps (GaussianBlur,
+ * connectedComponents, ...) spin up OpenCV's own threads, on top of the
+ * workers of the Executor, and oversubscribe the CPU when several Steps
+ * run at once. With it, a parallel region is split into ranges that are
+ * submitted to the shared work-stealing pool, and the calling thread helps
+ * until they are done (see ```ThreadPool::parallel_for()```); hence the
+ * machine has a single thread budget, and a region started inside a Step
+ * does not block its worker.
+ *
+ * Thread numbers: the workers are numbered ```0``` to ```N - 1```; any
+ * other thread reports ```N```, so ```getNumThreads()``` is ```N + 1```.
+ *
+ * @note Use ```install()``` to make it OpenCV's current backend.
+ */
+class ThreadPoolBackend
+    : public cv::parallel::ParallelForAPI
+{
+public:
+    explicit ThreadPoolBackend(tg::core::ThreadPoolPtr pool);
+    ~ThreadPoolBackend() override;
+
+    /**
+     * @brief Makes a ThreadPoolBackend on the given pool the parallel
+     * backend of OpenCV, for all threads.
+     * @note A null pool restores the built-in backend of OpenCV.
+     */
+    static void install(tg::core::ThreadPoolPtr pool);
+
+public:
+    void parallel_for(int tasks, FN_parallel_for_body_cb_t body_callback, void* callback_data) override;
+    int getThreadNum() const override;
+    int getNumThreads() const override;
+
+    /**
+     * @brief The pool has a fixed size; the request is ignored.
+     * @returns The number of threads before the call.
+     */
+    int setNumThreads(int nThreads) override;
+    const char* getName() const override;
+
+private:
+    ThreadPoolBackend(const ThreadPoolBackend&) = delete;
+    ThreadPoolBackend(ThreadPoolBackend&&) = delete;
+    ThreadPoolBackend& operator=(const ThreadPoolBackend&) = delete;
+    ThreadPoolBackend& operator=(ThreadPoolBackend&&) = delete;
+
+private:
+    tg::core::ThreadPoolPtr m_sp_pool;
+};
+
+} // namespace tg::opencv
@@ -0,0 +1,182 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <opencv2/core.hpp>
+#include "tg/core/fwd.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/core/thread_pool.hpp"
+#include "tg/core/testcase/blur_step.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+using namespace tg::core::testcase;
+
+namespace //(unnamed)
+{
+
+/**
+ * @brief A batchable Step that doubles its input; records the batch sizes.
+ */
+class DoubleBatchStep : public Step
+{
+public:
+    DoubleBatchStep()
+        : Step{}
+        , m_mutex{}
+        , m_batch_sizes{}
+    {
+        this->info().set_shortname("double");
+        this->info().add_data<int>("value", DataUsage::Read);
+        this->info().add_data<int>("doubled", DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        data.at(1).emplace<int>(data.at(0).as<int>() * 2);
+        this->post_execute_validation(data);
+    }
+    bool is_batchable() const override {
+        return true;
+    }
+    void execute_batch(const std::vector<std::vector<VarData>*>& batch) override {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_batch_sizes.push_back(batch.size());
+        }
+        Step::execute_batch(batch);
+    }
+    std::vector<size_t> batch_sizes() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_batch_sizes;
+    }
+private:
+    std::mutex m_mutex;
+    std::vector<size_t> m_batch_sizes;
+};
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void batch_testcase_1(OStrm cout)
+{
+    cout << "running batch_testcase_1..." << std::endl;
+    auto step = std::make_shared<DoubleBatchStep>();
+    Scope scope("batch_scope");
+    scope.add(step);
+    scope.freeze();
+    Plan plan(scope);
+    Executor executor(std::make_shared<ThreadPool>(4u));
+    executor.set_batch_policy(BatchPolicy{8u, std::chrono::microseconds(5000)});
+    const int request_count = 64;
+    std::atomic<int> wrong_count{0};
+    auto request = [&](int first) {
+        for (int value = first; value < request_count; value += 8)
+        {
+            std::vector<VarData> slots(plan.slot_count());
+            slots.at(plan.find_slot("value").value()).emplace<int>(value);
+            executor.run(plan, slots);
+            if (slots.at(plan.find_slot("doubled").value()).as<int>() != value * 2)
+            {
+                ++wrong_count;
+            }
+        }
+    };
+    std::vector<std::thread> clients;
+    for (int first = 0; first < 8; ++first)
+    {
+        clients.emplace_back(request, first);
+    }
+    for (auto& client : clients)
+    {
+        client.join();
+    }
+    size_t instance_count = 0u;
+    size_t max_size = 0u;
+    const auto batch_sizes = step->batch_sizes();
+    for (size_t size : batch_sizes)
+    {
+        instance_count += size;
+        max_size = std::max(max_size, size);
+    }
+    cout << "Requests: " << request_count << ", batches: " << batch_sizes.size()
+        << ", largest batch: " << max_size << std::endl;
+    if (wrong_count.load() != 0 || instance_count != static_cast<size_t>(request_count) || max_size > 8u)
+    {
+        throw std::runtime_error("batch_testcase_1: unexpected result.");
+    }
+    cout << "batch_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void batch_testcase_2(OStrm cout)
+{
+    cout << "running batch_testcase_2..." << std::endl;
+    // A batched BlurStep gives the same images as unbatched runs.
+    Scope scope("blur_scope");
+    scope.add(std::make_shared<BlurStep>(1.5, 1.5));
+    scope.freeze();
+    Plan plan(scope);
+    Executor batching(std::make_shared<ThreadPool>(4u));
+    batching.set_batch_policy(BatchPolicy{4u, std::chrono::microseconds(2000)});
+    Executor sequential;
+    auto make_image = [](int seed) {
+        cv::Mat image = cv::Mat::zeros(32, 32, CV_8UC1);
+        for (int row = 0; row < image.rows; ++row)
+        {
+            for (int col = 0; col < image.cols; ++col)
+            {
+                image.at<uchar>(row, col) = static_cast<uchar>((row * seed + col * 31) % 256);
+            }
+        }
+        return image;
+    };
+    auto blur = [&](const Executor& executor, const cv::Mat& image) {
+        std::vector<VarData> slots(plan.slot_count());
+        slots.at(plan.find_slot("input").value()).emplace<cv::Mat>(image);
+        executor.run(plan, slots);
+        return slots.at(plan.find_slot("output").value()).as<cv::Mat>();
+    };
+    std::vector<cv::Mat> batched(4u);
+    std::vector<std::thread> clients;
+    for (int k = 0; k < 4; ++k)
+    {
+        clients.emplace_back([&, k]() {
+            batched.at(static_cast<size_t>(k)) = blur(batching, make_image(k + 3));
+        });
+    }
+    for (auto& client : clients)
+    {
+        client.join();
+    }
+    int mismatch = 0;
+    for (int k = 0; k < 4; ++k)
+    {
+        const cv::Mat expect = blur(sequential, make_image(k + 3));
+        const cv::Mat& actual = batched.at(static_cast<size_t>(k));
+        for (int row = 0; row < expect.rows; ++row)
+        {
+            for (int col = 0; col < expect.cols; ++col)
+            {
+                mismatch += (expect.at<uchar>(row, col) != actual.at<uchar>(row, col)) ? 1 : 0;
+            }
+        }
+    }
+    cout << "Mismatched pixels: " << mismatch << std::endl;
+    if (mismatch != 0)
+    {
+        throw std::runtime_error("batch_testcase_2: batched blur differs.");
+    }
+    cout << "batch_testcase_2 success." << std::endl;
+}
+
+INLINE_NEVER
+void batch_testcase()
+{
+    OStrm cout;
+    batch_testcase_1(cout);
+    batch_testcase_2(cout);
+}
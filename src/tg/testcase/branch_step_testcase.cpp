@@ -0,0 +1,131 @@
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <string>
+#include "tg/core/fwd.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/core/thread_pool.hpp"
+#include "tg/core/branch_step.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+
+namespace //(unnamed)
+{
+
+class IntFuncStep : public Step
+{
+public:
+    using Func = std::function<int(int)>;
+    IntFuncStep(std::string_view shortname, std::string_view input, std::string_view output, Func func)
+        : Step{}
+        , m_func{std::move(func)}
+        , m_run_count{0}
+    {
+        this->info().set_shortname(shortname);
+        this->info().add_data<int>(input, DataUsage::Read);
+        this->info().add_data<int>(output, DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        data.at(1).emplace<int>(m_func(data.at(0).as<int>()));
+        ++m_run_count;
+        this->post_execute_validation(data);
+    }
+    int run_count() const { return m_run_count.load(); }
+private:
+    Func m_func;
+    std::atomic<int> m_run_count;
+};
+
+class IsEvenStep : public Step
+{
+public:
+    IsEvenStep() : Step{} {
+        this->info().set_shortname("is_even");
+        this->info().add_data<int>("value", DataUsage::Read);
+        this->info().add_data<bool>("is_even", DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        data.at(1).emplace<bool>(data.at(0).as<int>() % 2 == 0);
+        this->post_execute_validation(data);
+    }
+};
+
+class JoinStep : public Step
+{
+public:
+    JoinStep() : Step{} {
+        this->info().set_shortname("join");
+        this->info().add_data<int>("halved", DataUsage::Read);
+        this->info().add_data<int>("tripled", DataUsage::Read);
+        this->info().add_data<int>("next", DataUsage::Write);
+        this->info().mark_data_as_optional("halved");
+        this->info().mark_data_as_optional("tripled");
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        const VarData& taken = data.at(0).has_value() ? data.at(0) : data.at(1);
+        data.at(2).emplace<int>(taken.as<int>());
+        this->post_execute_validation(data);
+    }
+};
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void branch_step_testcase_1(OStrm cout, ThreadPoolPtr pool)
+{
+    cout << "running branch_step_testcase_1 (" << (pool ? "parallel" : "sequential") << ")..." << std::endl;
+    auto halve = std::make_shared<IntFuncStep>("halve", "even_value", "halved", [](int v) { return v / 2; });
+    auto triple = std::make_shared<IntFuncStep>("triple", "odd_value", "tripled_raw", [](int v) { return 3 * v; });
+    auto plus_one = std::make_shared<IntFuncStep>("plus_one", "tripled_raw", "tripled", [](int v) { return v + 1; });
+    Scope scope("collatz_scope");
+    scope.add(std::make_shared<IsEvenStep>());
+    scope.add(BranchStep::create<int>("branch", "is_even", "value", "even_value", "odd_value"));
+    scope.add(halve);
+    scope.add(triple);
+    scope.add(plus_one);
+    scope.add(std::make_shared<JoinStep>());
+    scope.freeze();
+    Plan plan(scope);
+    Executor executor(pool);
+    int value = 27;
+    int step_count = 0;
+    while (value != 1)
+    {
+        std::vector<VarData> slots(plan.slot_count());
+        slots.at(plan.find_slot("value").value()).emplace<int>(value);
+        executor.run(plan, slots);
+        const bool even = (value % 2 == 0);
+        const bool odd_side_produced = slots.at(plan.find_slot("tripled").value()).has_value();
+        if (even == odd_side_produced)
+        {
+            throw std::runtime_error("branch_step_testcase_1: untaken side was produced.");
+        }
+        value = slots.at(plan.find_slot("next").value()).as<int>();
+        ++step_count;
+    }
+    cout << "Collatz steps: " << step_count << ", halve runs: " << halve->run_count()
+        << ", triple runs: " << triple->run_count() << ", plus_one runs: " << plus_one->run_count() << std::endl;
+    if (step_count != 111 || halve->run_count() + triple->run_count() != step_count ||
+        triple->run_count() != plus_one->run_count())
+    {
+        throw std::runtime_error("branch_step_testcase_1: unexpected result.");
+    }
+    cout << "branch_step_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void branch_step_testcase()
+{
+    OStrm cout;
+    branch_step_testcase_1(cout, nullptr);
+    branch_step_testcase_1(cout, std::make_shared<ThreadPool>(4u));
+}
@@ -0,0 +1,138 @@
+#include <iostream>
+#include <string>
+#include <opencv2/core.hpp>
+#include "tg/core/fwd.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/core/buffer_pool.hpp"
+#include "tg/core/thread_pool.hpp"
+#include "tg/core/testcase/blur_conncomp_plan.hpp"
+#include "tg/opencv/buffer_types.hpp"
+#include "tg/opencv/data_meta.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+using namespace tg::core::testcase;
+
+namespace //(unnamed)
+{
+
+cv::Mat make_image(int seed)
+{
+    cv::Mat image = cv::Mat::zeros(128, 96, CV_8UC1);
+    for (int row = 16 + seed; row < 48 + seed; ++row)
+    {
+        for (int col = 8; col < 40; ++col)
+        {
+            image.at<uchar>(row, col) = 255;
+        }
+    }
+    return image;
+}
+
+int count_mismatch(const cv::Mat& expect, const cv::Mat& actual)
+{
+    if (expect.rows != actual.rows || expect.cols != actual.cols || expect.type() != actual.type())
+    {
+        return -1;
+    }
+    int mismatch = 0;
+    const size_t row_bytes = static_cast<size_t>(expect.cols) * expect.elemSize();
+    for (int row = 0; row < expect.rows; ++row)
+    {
+        for (size_t col = 0u; col < row_bytes; ++col)
+        {
+            mismatch += (expect.ptr<uchar>(row)[col] != actual.ptr<uchar>(row)[col]) ? 1 : 0;
+        }
+    }
+    return mismatch;
+}
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void buffer_pool_testcase_1(OStrm cout)
+{
+    cout << "running buffer_pool_testcase_1..." << std::endl;
+    tg::opencv::register_buffer_types();
+    const std::type_index mat_type(typeid(cv::Mat));
+    const DataMeta meta{10, 10, CV_8UC1, 1u};
+    BufferPool pool(150u);
+    const uchar* p_first = nullptr;
+    {
+        VarData first = pool.acquire(mat_type, meta);
+        p_first = first.as<cv::Mat>().data;
+    }
+    VarData second = pool.acquire(mat_type, meta);
+    const bool is_reused = (second.as<cv::Mat>().data == p_first);
+    // The pooled buffer is in use; the next one exceeds the capacity.
+    VarData third = pool.acquire(mat_type, meta);
+    third.clear();
+    // A header copy kept by the caller blocks the reuse of its storage.
+    cv::Mat kept = second.as<cv::Mat>();
+    second.clear();
+    VarData fourth = pool.acquire(mat_type, meta);
+    const bool is_kept_safe = (fourth.as<cv::Mat>().data != kept.data);
+    cout << "Reused: " << pool.reuse_count() << ", allocated: " << pool.alloc_count()
+        << ", pooled bytes: " << pool.pooled_bytes() << std::endl;
+    if (!is_reused || !is_kept_safe || pool.reuse_count() != 1u || pool.alloc_count() != 3u ||
+        pool.pooled_bytes() != 100u || pool.acquire(mat_type, DataMeta{}).has_value())
+    {
+        throw std::runtime_error("buffer_pool_testcase_1: unexpected pooling.");
+    }
+    cout << "buffer_pool_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void buffer_pool_testcase_2(OStrm cout)
+{
+    cout << "running buffer_pool_testcase_2..." << std::endl;
+    tg::opencv::register_buffer_types();
+    tg::opencv::register_data_meta();
+    PlanPtr plan = make_blur_conncomp_plan();
+    const size_t input_slot = plan->find_slot("input").value();
+    const size_t labels_slot = plan->find_slot("labels").value();
+    const size_t stats_slot = plan->find_slot("stats").value();
+    auto buffers = std::make_shared<BufferPool>();
+    Executor pooled(std::make_shared<ThreadPool>(2u));
+    pooled.set_buffer_pool(buffers);
+    Executor plain;
+    int mismatch = 0;
+    for (int seed = 0; seed < 5; ++seed)
+    {
+        std::vector<VarData> expect(plan->slot_count());
+        std::vector<VarData> actual(plan->slot_count());
+        expect.at(input_slot).emplace<cv::Mat>(make_image(seed));
+        actual.at(input_slot) = expect.at(input_slot);
+        plain.run(*plan, expect);
+        pooled.run(*plan, actual);
+        mismatch += count_mismatch(expect.at(labels_slot).as<cv::Mat>(), actual.at(labels_slot).as<cv::Mat>());
+        mismatch += count_mismatch(expect.at(stats_slot).as<cv::Mat>(), actual.at(stats_slot).as<cv::Mat>());
+    }
+    const size_t reused = buffers->reuse_count();
+    // A result kept by the caller is not handed out again.
+    std::vector<VarData> kept(plan->slot_count());
+    kept.at(input_slot).emplace<cv::Mat>(make_image(0));
+    pooled.run(*plan, kept);
+    const cv::Mat kept_labels = kept.at(labels_slot).as<cv::Mat>().clone();
+    std::vector<VarData> other(plan->slot_count());
+    other.at(input_slot).emplace<cv::Mat>(make_image(9));
+    pooled.run(*plan, other);
+    const int kept_mismatch = count_mismatch(kept_labels, kept.at(labels_slot).as<cv::Mat>());
+    cout << "Reused: " << reused << ", allocated: " << buffers->alloc_count()
+        << ", mismatch: " << mismatch << ", kept mismatch: " << kept_mismatch << std::endl;
+    if (mismatch != 0 || kept_mismatch != 0 || reused != 8u || buffers->alloc_count() != 4u)
+    {
+        throw std::runtime_error("buffer_pool_testcase_2: unexpected result.");
+    }
+    cout << "buffer_pool_testcase_2 success." << std::endl;
+}
+
+INLINE_NEVER
+void buffer_pool_testcase()
+{
+    OStrm cout;
+    buffer_pool_testcase_1(cout);
+    buffer_pool_testcase_2(cout);
+}
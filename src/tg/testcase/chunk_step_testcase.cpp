@@ -0,0 +1,171 @@
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <opencv2/core.hpp>
+#include "tg/core/fwd.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/core/thread_pool.hpp"
+#include "tg/core/testcase/blur_step.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+using namespace tg::core::testcase;
+
+namespace //(unnamed)
+{
+
+/**
+ * @brief Squares a vector of values, split into fixed-size chunks; records
+ * the threads the chunks ran on.
+ */
+class SquareChunkStep : public Step
+{
+public:
+    static constexpr size_t chunk_size = 1000u;
+
+public:
+    explicit SquareChunkStep(std::string_view shortname)
+        : Step{}
+        , m_mutex{}
+        , m_threads{}
+    {
+        this->info().set_shortname(shortname);
+        this->info().add_data<std::vector<long long>>("values", DataUsage::Read);
+        this->info().add_data<std::vector<long long>>("squares", DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        const auto& values = data.at(0).as<std::vector<long long>>();
+        auto& squares = data.at(1).emplace<std::vector<long long>>(values.size());
+        for (size_t k = 0u; k < values.size(); ++k)
+        {
+            squares.at(k) = values.at(k) * values.at(k);
+        }
+        this->post_execute_validation(data);
+    }
+    size_t begin_chunks(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        const auto& values = data.at(0).as<std::vector<long long>>();
+        data.at(1).emplace<std::vector<long long>>(values.size());
+        return (values.size() + chunk_size - 1u) / chunk_size;
+    }
+    void execute_chunk(std::vector<VarData>& data, size_t chunk_index) override {
+        const auto& values = data.at(0).as<std::vector<long long>>();
+        auto& squares = data.at(1).as<std::vector<long long>>();
+        const size_t end = std::min(values.size(), (chunk_index + 1u) * chunk_size);
+        for (size_t k = chunk_index * chunk_size; k < end; ++k)
+        {
+            squares.at(k) = values.at(k) * values.at(k);
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_threads.insert(std::this_thread::get_id());
+    }
+    void end_chunks(std::vector<VarData>& data) override {
+        this->post_execute_validation(data);
+    }
+    size_t thread_count() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_threads.size();
+    }
+private:
+    std::mutex m_mutex;
+    std::set<std::thread::id> m_threads;
+};
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void chunk_step_testcase_1(OStrm cout)
+{
+    cout << "running chunk_step_testcase_1..." << std::endl;
+    // Two independent chunked Steps; their chunks share the pool.
+    auto left = std::make_shared<SquareChunkStep>("left");
+    auto right = std::make_shared<SquareChunkStep>("right");
+    right->info().rename_data("values", "more_values");
+    right->info().rename_data("squares", "more_squares");
+    Scope scope("chunk_scope");
+    scope.add(left);
+    scope.add(right);
+    scope.freeze();
+    Plan plan(scope);
+    std::vector<long long> values(100000u);
+    for (size_t k = 0u; k < values.size(); ++k)
+    {
+        values.at(k) = static_cast<long long>(k) - 50000;
+    }
+    Executor executor(std::make_shared<ThreadPool>(4u));
+    std::vector<VarData> slots(plan.slot_count());
+    slots.at(plan.find_slot("values").value()).emplace<std::vector<long long>>(values);
+    slots.at(plan.find_slot("more_values").value()).emplace<std::vector<long long>>(values);
+    executor.run(plan, slots);
+    for (const char* name : {"squares", "more_squares"})
+    {
+        const auto& squares = slots.at(plan.find_slot(name).value()).as<std::vector<long long>>();
+        for (size_t k = 0u; k < values.size(); ++k)
+        {
+            if (squares.at(k) != values.at(k) * values.at(k))
+            {
+                throw std::runtime_error("chunk_step_testcase_1: unexpected result.");
+            }
+        }
+    }
+    cout << "Chunk threads, left: " << left->thread_count() << ", right: " << right->thread_count() << std::endl;
+    cout << "chunk_step_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void chunk_step_testcase_2(OStrm cout)
+{
+    cout << "running chunk_step_testcase_2..." << std::endl;
+    // The row-range chunks of BlurStep must match the whole-image blur.
+    Scope scope("blur_scope");
+    scope.add(std::make_shared<BlurStep>(2.0, 2.0));
+    scope.freeze();
+    Plan plan(scope);
+    cv::Mat image = cv::Mat::zeros(300, 200, CV_8UC1);
+    for (int row = 0; row < image.rows; ++row)
+    {
+        for (int col = 0; col < image.cols; ++col)
+        {
+            image.at<uchar>(row, col) = static_cast<uchar>((row * 7 + col * 13) % 256);
+        }
+    }
+    auto run_blur = [&](const Executor& executor) {
+        std::vector<VarData> slots(plan.slot_count());
+        slots.at(plan.find_slot("input").value()).emplace<cv::Mat>(image);
+        executor.run(plan, slots);
+        return slots.at(plan.find_slot("output").value()).as<cv::Mat>();
+    };
+    const cv::Mat whole = run_blur(Executor{});
+    const cv::Mat chunked = run_blur(Executor{std::make_shared<ThreadPool>(4u)});
+    int mismatch = 0;
+    for (int row = 0; row < image.rows; ++row)
+    {
+        for (int col = 0; col < image.cols; ++col)
+        {
+            mismatch += (whole.at<uchar>(row, col) != chunked.at<uchar>(row, col)) ? 1 : 0;
+        }
+    }
+    cout << "Chunks: " << image.rows / BlurStep::chunk_rows << ", mismatched pixels: " << mismatch << std::endl;
+    if (mismatch != 0)
+    {
+        throw std::runtime_error("chunk_step_testcase_2: chunked blur differs from whole blur.");
+    }
+    cout << "chunk_step_testcase_2 success." << std::endl;
+}
+
+INLINE_NEVER
+void chunk_step_testcase()
+{
+    OStrm cout;
+    chunk_step_testcase_1(cout);
+    chunk_step_testcase_2(cout);
+}
@@ -0,0 +1,155 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "tg/core/fwd.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/core/thread_pool.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+
+namespace //(unnamed)
+{
+
+/**
+ * @brief A scalar bookkeeping Step; records the thread it ran on.
+ */
+class TickStep : public Step
+{
+public:
+    TickStep(std::string_view shortname, std::string_view input, std::string_view output, std::thread::id* p_thread)
+        : Step{}
+        , m_p_thread{p_thread}
+    {
+        this->info().set_shortname(shortname);
+        this->info().add_data<int>(input, DataUsage::Read);
+        this->info().add_data<int>(output, DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        *m_p_thread = std::this_thread::get_id();
+        data.at(1).emplace<int>(data.at(0).as<int>() + 1);
+        this->post_execute_validation(data);
+    }
+private:
+    std::thread::id* m_p_thread;
+};
+
+/**
+ * @brief Stands in for an image Step: busy for a fixed time.
+ */
+class BusyStep : public Step
+{
+public:
+    BusyStep(std::string_view shortname, std::string_view input, std::string_view output)
+        : Step{}
+    {
+        this->info().set_shortname(shortname);
+        this->info().add_data<int>(input, DataUsage::Read);
+        this->info().add_data<int>(output, DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        const auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(200);
+        while (std::chrono::steady_clock::now() < until) {}
+        data.at(1).emplace<int>(data.at(0).as<int>() + 1000);
+        this->post_execute_validation(data);
+    }
+};
+
+int run_plan(const Plan& plan, const Executor& executor, std::string_view output)
+{
+    std::vector<VarData> slots(plan.slot_count());
+    slots.at(plan.find_slot("x0").value()).emplace<int>(0);
+    executor.run(plan, slots);
+    return slots.at(plan.find_slot(output).value()).as<int>();
+}
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void coarsening_testcase_1(OStrm cout)
+{
+    cout << "running coarsening_testcase_1..." << std::endl;
+    // Image Steps, each followed by a chain of scalar bookkeeping Steps.
+    const size_t segment_count = 4u;
+    const size_t chain_length = 500u;
+    std::vector<std::thread::id> threads(segment_count * chain_length);
+    Scope scope("coarsening_scope");
+    size_t value = 0u;
+    for (size_t segment = 0u; segment < segment_count; ++segment)
+    {
+        scope.add(std::make_shared<BusyStep>(
+            "busy" + std::to_string(segment), "x" + std::to_string(value), "x" + std::to_string(value + 1u)
+        ));
+        ++value;
+        for (size_t k = 0u; k < chain_length; ++k)
+        {
+            scope.add(std::make_shared<TickStep>(
+                "tick" + std::to_string(value), "x" + std::to_string(value), "x" + std::to_string(value + 1u),
+                &threads.at(segment * chain_length + k)
+            ));
+            ++value;
+        }
+    }
+    scope.freeze();
+    Plan plan(scope);
+    const std::string output = "x" + std::to_string(value);
+    const int expect = static_cast<int>(segment_count * 1000u + segment_count * chain_length);
+    auto pool = std::make_shared<ThreadPool>(4u);
+    auto time_runs = [&](const Executor& executor, int repeat) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int k = 0; k < repeat; ++k)
+        {
+            if (run_plan(plan, executor, output) != expect)
+            {
+                throw std::runtime_error("coarsening_testcase_1: unexpected result.");
+            }
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        return std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() / repeat;
+    };
+    Executor uncoarsened(pool);
+    uncoarsened.set_coarsening_threshold(std::chrono::nanoseconds(0));
+    Executor coarsened(pool);
+    // Well below the busy Steps, well above the ticks even on a loaded machine.
+    coarsened.set_coarsening_threshold(std::chrono::microseconds(100));
+    const auto uncoarsened_us = time_runs(uncoarsened, 20);
+    // The first runs measure; later runs coarsen.
+    time_runs(coarsened, 5);
+    const auto coarsened_us = time_runs(coarsened, 20);
+    size_t switches = 0u;
+    for (size_t k = 1u; k < threads.size(); ++k)
+    {
+        if (k % chain_length != 0u && threads.at(k) != threads.at(k - 1u))
+        {
+            ++switches;
+        }
+    }
+    cout << "Per run, uncoarsened: " << uncoarsened_us << " us, coarsened: " << coarsened_us
+        << " us, thread switches within chains: " << switches << std::endl;
+    // A tick preempted while measured may be dispatched once in a while.
+    if (switches * 100u > threads.size())
+    {
+        throw std::runtime_error("coarsening_testcase_1: cheap chain was not kept on one thread.");
+    }
+    const auto busy_cost = plan.estimated_cost(0u);
+    if (!busy_cost.has_value() || busy_cost.value() < coarsened.coarsening_threshold())
+    {
+        throw std::runtime_error("coarsening_testcase_1: expensive Step estimated as cheap.");
+    }
+    cout << "coarsening_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void coarsening_testcase()
+{
+    OStrm cout;
+    coarsening_testcase_1(cout);
+}
@@ -0,0 +1,129 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "tg/core/fwd.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/dag_validator.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+
+namespace //(unnamed)
+{
+
+class NodeStep : public Step
+{
+public:
+    NodeStep(std::string_view shortname, std::vector<std::string> reads, std::vector<std::string> writes)
+        : Step{}
+    {
+        this->info().set_shortname(shortname);
+        for (const auto& name : reads)
+        {
+            this->info().add_data<int>(name, DataUsage::Read);
+        }
+        for (const auto& name : writes)
+        {
+            this->info().add_data<int>(name, DataUsage::Write);
+        }
+    }
+    void execute(std::vector<VarData>& /*data*/) override {}
+};
+
+StepPtr make_node(std::string_view shortname, std::vector<std::string> reads, std::vector<std::string> writes)
+{
+    return std::make_shared<NodeStep>(shortname, std::move(reads), std::move(writes));
+}
+
+bool same_report(const ValidationReport& lhs, const ValidationReport& rhs)
+{
+    return lhs.m_unreachable_steps == rhs.m_unreachable_steps &&
+        lhs.m_unproduced_reads == rhs.m_unproduced_reads &&
+        lhs.m_multiple_writers == rhs.m_multiple_writers &&
+        lhs.m_multiple_consumers == rhs.m_multiple_consumers;
+}
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void dag_validator_testcase_1(OStrm cout)
+{
+    cout << "running dag_validator_testcase_1..." << std::endl;
+    Scope scope("faulty_scope");
+    scope.add(make_node("source", {"input"}, {"a"}));
+    scope.add(make_node("orphan", {"missing"}, {"b"}));
+    scope.add(make_node("after_orphan", {"b"}, {"c"}));
+    scope.add(make_node("cycle_1", {"d"}, {"e"}));
+    scope.add(make_node("cycle_2", {"e"}, {"d"}));
+    scope.add(make_node("writer_1", {"a"}, {"f"}));
+    scope.add(make_node("writer_2", {"a"}, {"f"}));
+    scope.freeze();
+    DagValidator validator(scope);
+    validator.declare_global_input("input");
+    ValidationReport report = validator.validate();
+    cout << validator.describe(report);
+    if (report.is_valid() || report.m_unreachable_steps != std::vector<size_t>{1u, 2u, 3u, 4u} ||
+        report.m_unproduced_reads.size() != 1u || report.m_multiple_writers.size() != 1u)
+    {
+        throw std::runtime_error("dag_validator_testcase_1: unexpected report.");
+    }
+    // Fix the graph by edits; only the affected region is revisited.
+    validator.declare_global_input("missing");
+    validator.remove_step(4u);
+    validator.add_step(make_node("cycle_break", {"input"}, {"d"}));
+    validator.remove_step(6u);
+    report = validator.revalidate();
+    cout << validator.describe(report);
+    if (!report.is_valid() || !same_report(report, validator.validate()))
+    {
+        throw std::runtime_error("dag_validator_testcase_1: unexpected report after edits.");
+    }
+    cout << "dag_validator_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void dag_validator_testcase_2(OStrm cout)
+{
+    cout << "running dag_validator_testcase_2..." << std::endl;
+    using Clock = std::chrono::steady_clock;
+    constexpr size_t chain_length = 100000u;
+    DagValidator validator;
+    validator.declare_global_input("d0");
+    for (size_t k = 0u; k < chain_length; ++k)
+    {
+        validator.add_step(make_node(
+            "s" + std::to_string(k),
+            {"d" + std::to_string(k)},
+            {"d" + std::to_string(k + 1u)}
+        ));
+    }
+    auto start = Clock::now();
+    ValidationReport report = validator.validate();
+    auto full_us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+    // Break, then repair, the chain near its end.
+    const size_t edit_at = chain_length - 10u;
+    validator.remove_step(edit_at);
+    start = Clock::now();
+    ValidationReport broken = validator.revalidate();
+    validator.add_step(make_node("repair", {"d" + std::to_string(edit_at)}, {"d" + std::to_string(edit_at + 1u)}));
+    ValidationReport repaired = validator.revalidate();
+    auto incr_us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+    cout << "Full pass: " << full_us << " us, two incremental passes: " << incr_us << " us" << std::endl;
+    if (!report.is_valid() || broken.m_unreachable_steps.size() != 9u ||
+        broken.m_unproduced_reads.size() != 1u || !repaired.is_valid())
+    {
+        throw std::runtime_error("dag_validator_testcase_2: unexpected report.");
+    }
+    cout << "dag_validator_testcase_2 success." << std::endl;
+}
+
+INLINE_NEVER
+void dag_validator_testcase()
+{
+    OStrm cout;
+    dag_validator_testcase_1(cout);
+    dag_validator_testcase_2(cout);
+}
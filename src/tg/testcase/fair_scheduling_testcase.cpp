@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "tg/core/fwd.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/core/thread_pool.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+
+namespace //(unnamed)
+{
+
+/**
+ * @brief The tenants in the order their Steps executed.
+ */
+struct ServeLog
+{
+    std::mutex m_mutex;
+    std::string m_tags;
+};
+
+class SpinStep : public Step
+{
+public:
+    SpinStep(int index, char tag, ServeLog& log)
+        : Step{}
+        , m_tag{tag}
+        , m_log{log}
+    {
+        this->info().set_shortname("spin_" + std::to_string(index));
+        this->info().add_data<int>("seed", DataUsage::Read);
+        this->info().add_data<int>("out_" + std::to_string(index), DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        // A fixed amount of CPU work, however the thread is preempted.
+        volatile uint64_t sink = 0u;
+        for (uint64_t k = 0u; k < 300000u; ++k)
+        {
+            sink = sink + k;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_log.m_mutex);
+            m_log.m_tags.push_back(m_tag);
+        }
+        data.at(1).emplace<int>(data.at(0).as<int>());
+        this->post_execute_validation(data);
+    }
+private:
+    char m_tag;
+    ServeLog& m_log;
+};
+
+PlanPtr make_fan_out_plan(const std::string& scopename, char tag, int width, ServeLog& log)
+{
+    Scope scope(scopename);
+    for (int k = 0; k < width; ++k)
+    {
+        scope.add(std::make_shared<SpinStep>(k, tag, log));
+    }
+    scope.freeze();
+    return std::make_shared<Plan>(scope);
+}
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void fair_scheduling_testcase_1(OStrm cout)
+{
+    cout << "running fair_scheduling_testcase_1..." << std::endl;
+    ServeLog log;
+    const int width = 100;
+    PlanPtr plan_a = make_fan_out_plan("tenant_a", 'a', width, log);
+    PlanPtr plan_b = make_fan_out_plan("tenant_b", 'b', width, log);
+    Executor executor(std::make_shared<ThreadPool>(1u));
+    executor.set_fair_scheduling(true);
+    executor.set_tenant_weight("tenant_b", 3.0);
+    auto run = [&executor](const PlanPtr& plan) {
+        std::vector<VarData> slots(plan->slot_count());
+        slots.at(plan->find_slot("seed").value()).emplace<int>(1);
+        executor.run(*plan, slots);
+    };
+    std::thread thread_a(run, plan_a);
+    std::thread thread_b(run, plan_b);
+    thread_a.join();
+    thread_b.join();
+    // While both tenants are backlogged, they share the pool 1:3.
+    const std::string& tags = log.m_tags;
+    const size_t begin = std::max(tags.find('a'), tags.find('b'));
+    const size_t end = std::min(tags.rfind('a'), tags.rfind('b'));
+    const auto count_b = std::count(tags.begin() + static_cast<std::ptrdiff_t>(begin), tags.begin() + static_cast<std::ptrdiff_t>(end), 'b');
+    const double share_b = (end > begin) ? static_cast<double>(count_b) / static_cast<double>(end - begin) : 0.0;
+    cout << "Share of tenant_b while both were backlogged: " << share_b << " over " << (end - begin) << " Steps" << std::endl;
+    if (share_b < 0.6 || share_b > 0.9)
+    {
+        throw std::runtime_error("fair_scheduling_testcase_1: unfair share.");
+    }
+    for (const auto& stats : executor.tenant_stats())
+    {
+        const auto cpu_ms = std::chrono::duration_cast<std::chrono::milliseconds>(stats.m_cpu_time).count();
+        cout << stats.m_tenant << ": weight " << stats.m_weight << ", tasks " << stats.m_task_count << ", cpu " << cpu_ms << " ms" << std::endl;
+        // The task that completed a run may still be accounting for itself.
+        if (stats.m_task_count + 1u < static_cast<size_t>(width) || cpu_ms < width / 20)
+        {
+            throw std::runtime_error("fair_scheduling_testcase_1: tenant time not reported.");
+        }
+    }
+    cout << "fair_scheduling_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void fair_scheduling_testcase()
+{
+    OStrm cout;
+    fair_scheduling_testcase_1(cout);
+}
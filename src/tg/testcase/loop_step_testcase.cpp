@@ -0,0 +1,196 @@
+#include <iostream>
+#include <string>
+#include <opencv2/core.hpp>
+#include "tg/core/fwd.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/core/loop_step.hpp"
+#include "tg/opencv/buffer_types.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+
+namespace //(unnamed)
+{
+
+/**
+ * @brief One Newton iteration for the integer square root of "target".
+ */
+class NewtonStep : public Step
+{
+public:
+    NewtonStep() : Step{} {
+        this->info().set_shortname("newton");
+        this->info().add_data<long long>("target", DataUsage::Read);
+        this->info().add_data<long long>("guess", DataUsage::Read);
+        this->info().add_data<long long>("next_guess", DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        const long long target = data.at(0).as<long long>();
+        const long long guess = data.at(1).as<long long>();
+        data.at(2).emplace<long long>((guess + target / guess) / 2);
+        this->post_execute_validation(data);
+    }
+};
+
+class ConvergedStep : public Step
+{
+public:
+    ConvergedStep() : Step{} {
+        this->info().set_shortname("converged");
+        this->info().add_data<long long>("guess", DataUsage::Read);
+        this->info().add_data<long long>("next_guess", DataUsage::Read);
+        this->info().add_data<bool>("converged", DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        data.at(2).emplace<bool>(data.at(1).as<long long>() >= data.at(0).as<long long>());
+        this->post_execute_validation(data);
+    }
+};
+
+/**
+ * @brief Adds one to every pixel, writing into the storage of its output;
+ * records the address of each output it writes.
+ */
+class IncrementStep : public Step
+{
+public:
+    explicit IncrementStep(std::vector<const uchar*>& addresses) : Step{}, m_addresses{addresses} {
+        this->info().set_shortname("increment");
+        this->info().add_data<cv::Mat>("image", DataUsage::Read);
+        this->info().add_data<cv::Mat>("next_image", DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        const cv::Mat& input = data.at(0).as<cv::Mat>();
+        cv::Mat& output = tg::opencv::output_mat(data.at(1));
+        output.create(input.rows, input.cols, input.type());
+        for (int row = 0; row < input.rows; ++row)
+        {
+            for (int col = 0; col < input.cols; ++col)
+            {
+                output.at<uchar>(row, col) = static_cast<uchar>(input.at<uchar>(row, col) + 1);
+            }
+        }
+        m_addresses.push_back(output.data);
+        this->post_execute_validation(data);
+    }
+private:
+    std::vector<const uchar*>& m_addresses;
+};
+
+class CountStep : public Step
+{
+public:
+    CountStep() : Step{} {
+        this->info().set_shortname("count");
+        this->info().add_data<int>("count", DataUsage::Read);
+        this->info().add_data<int>("next_count", DataUsage::Write);
+        this->info().add_data<bool>("done", DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        const int next_count = data.at(0).as<int>() + 1;
+        data.at(1).emplace<int>(next_count);
+        data.at(2).emplace<bool>(next_count >= 6);
+        this->post_execute_validation(data);
+    }
+};
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void loop_step_testcase_1(OStrm cout)
+{
+    cout << "running loop_step_testcase_1..." << std::endl;
+    PlanPtr body_plan;
+    {
+        Scope body_scope("newton_body");
+        body_scope.add(std::make_shared<NewtonStep>());
+        body_scope.add(std::make_shared<ConvergedStep>());
+        body_scope.freeze();
+        body_plan = std::make_shared<Plan>(body_scope);
+    }
+    auto loop = std::make_shared<LoopStep>("isqrt", body_plan, "converged", 100u);
+    loop->bind_input("value", "target");
+    loop->bind_input("value", "guess");
+    loop->carry("next_guess", "guess");
+    loop->bind_output("guess", "root");
+    Scope scope("isqrt_scope");
+    scope.add(loop);
+    scope.freeze();
+    Plan plan(scope);
+    Executor executor;
+    for (long long value : {1LL, 2LL, 99LL, 100LL, 1000000007LL})
+    {
+        std::vector<VarData> slots(plan.slot_count());
+        slots.at(plan.find_slot("value").value()).emplace<long long>(value);
+        executor.run(plan, slots);
+        const long long root = slots.at(plan.find_slot("root").value()).as<long long>();
+        cout << "isqrt(" << value << ") = " << root << std::endl;
+        if (root * root > value || (root + 1) * (root + 1) <= value)
+        {
+            throw std::runtime_error("loop_step_testcase_1: unexpected result.");
+        }
+    }
+    cout << "loop_step_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void loop_step_testcase_2(OStrm cout)
+{
+    cout << "running loop_step_testcase_2..." << std::endl;
+    tg::opencv::register_buffer_types();
+    std::vector<const uchar*> addresses;
+    PlanPtr body_plan;
+    {
+        Scope body_scope("increment_body");
+        body_scope.add(std::make_shared<IncrementStep>(addresses));
+        body_scope.add(std::make_shared<CountStep>());
+        body_scope.freeze();
+        body_plan = std::make_shared<Plan>(body_scope);
+    }
+    auto loop = std::make_shared<LoopStep>("add_six", body_plan, "done", 100u);
+    loop->bind_input("image", "image");
+    loop->bind_input("count", "count");
+    loop->carry("next_image", "image");
+    loop->carry("next_count", "count");
+    loop->bind_output("next_image", "result");
+    Scope scope("add_six_scope");
+    scope.add(loop);
+    scope.freeze();
+    Plan plan(scope);
+    std::vector<VarData> slots(plan.slot_count());
+    const cv::Mat image = cv::Mat::zeros(8, 8, CV_8UC1);
+    slots.at(plan.find_slot("image").value()).emplace<cv::Mat>(image);
+    slots.at(plan.find_slot("count").value()).emplace<int>(0);
+    Executor executor;
+    executor.run(plan, slots);
+    const cv::Mat& result = slots.at(plan.find_slot("result").value()).as<cv::Mat>();
+    // The first two iterations allocate; later ones alternate between those buffers.
+    bool is_stable = addresses.size() == 6u && addresses.at(0) != addresses.at(1);
+    for (size_t k = 2u; k < addresses.size(); ++k)
+    {
+        is_stable = is_stable && addresses.at(k) == addresses.at(k - 2u);
+    }
+    cout << "Iterations: " << addresses.size() << ", result: " << static_cast<int>(result.at<uchar>(0, 0)) << std::endl;
+    if (!is_stable || result.at<uchar>(0, 0) != 6 || result.at<uchar>(7, 7) != 6 || image.at<uchar>(0, 0) != 0)
+    {
+        throw std::runtime_error("loop_step_testcase_2: buffers not reused across iterations.");
+    }
+    cout << "loop_step_testcase_2 success." << std::endl;
+}
+
+INLINE_NEVER
+void loop_step_testcase()
+{
+    OStrm cout;
+    loop_step_testcase_1(cout);
+    loop_step_testcase_2(cout);
+}
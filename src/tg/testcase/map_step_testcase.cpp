@@ -0,0 +1,203 @@
+#include <iostream>
+#include <string>
+#include <opencv2/core.hpp>
+#include "tg/core/fwd.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/core/thread_pool.hpp"
+#include "tg/core/map_step.hpp"
+#include "tg/core/reduce_step.hpp"
+#include "tg/core/testcase/blur_step.hpp"
+#include "tg/core/testcase/conncomp_step.hpp"
+#include "tg/core/testcase/blob_map.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+using namespace tg::core::testcase;
+
+namespace //(unnamed)
+{
+
+class SquareStep : public Step
+{
+public:
+    SquareStep() : Step{} {
+        this->info().set_shortname("square");
+        this->info().add_data<int>("value", DataUsage::Read);
+        this->info().add_data<long long>("square", DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        const int value = data.at(0).as<int>();
+        data.at(1).emplace<long long>(static_cast<long long>(value) * value);
+        this->post_execute_validation(data);
+    }
+};
+
+PlanPtr make_square_plan()
+{
+    Scope scope("item_scope");
+    scope.add(std::make_shared<SquareStep>());
+    scope.freeze();
+    return std::make_shared<Plan>(scope);
+}
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void map_step_testcase_1(OStrm cout)
+{
+    cout << "running map_step_testcase_1..." << std::endl;
+    PlanPtr item_plan = make_square_plan();
+    const size_t value_slot = item_plan->find_slot("value").value();
+    auto count_func = [](const std::vector<VarData>& data) -> size_t {
+        return data.at(0).as<std::vector<int>>().size();
+    };
+    auto bind_func = [value_slot](size_t item_index, const std::vector<VarData>& data, std::vector<VarData>& item_slots) {
+        item_slots.at(value_slot).emplace<int>(data.at(0).as<std::vector<int>>().at(item_index));
+    };
+    auto map_step = std::make_shared<MapStep>("map_square", item_plan, count_func, bind_func);
+    map_step->info().add_data<std::vector<int>>("values", DataUsage::Read);
+    map_step->collect("square", "squares");
+    Scope scope("map_scope");
+    scope.add(map_step);
+    scope.freeze();
+    Plan plan(scope);
+    std::vector<int> values;
+    for (int k = 0; k < 1000; ++k)
+    {
+        values.push_back(k);
+    }
+    Executor executor(std::make_shared<ThreadPool>(4u));
+    std::vector<VarData> slots(plan.slot_count());
+    slots.at(plan.find_slot("values").value()).emplace<std::vector<int>>(values);
+    executor.run(plan, slots);
+    const auto& squares = slots.at(plan.find_slot("squares").value()).as<MapStep::Items>();
+    long long sum = 0;
+    for (const auto& item : squares)
+    {
+        sum += item.as<long long>();
+    }
+    cout << "Item count: " << squares.size() << ", sum of squares: " << sum << std::endl;
+    if (squares.size() != values.size() || sum != 332833500LL)
+    {
+        throw std::runtime_error("map_step_testcase_1: unexpected result.");
+    }
+    cout << "map_step_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void map_step_testcase_2(OStrm cout)
+{
+    cout << "running map_step_testcase_2..." << std::endl;
+    PlanPtr item_plan;
+    {
+        Scope item_scope("blob_scope");
+        auto blur = std::make_shared<BlurStep>(1.0, 1.0);
+        blur->info().rename_data("input", "blob");
+        blur->info().rename_data("output", "blob_smooth");
+        item_scope.add(blur);
+        item_scope.freeze();
+        item_plan = std::make_shared<Plan>(item_scope);
+    }
+    auto map_step = std::make_shared<MapStep>(
+        "map_blobs", item_plan,
+        BlobMap::make_count_func(1u),
+        BlobMap::make_bind_func(0u, 1u, item_plan->find_slot("blob").value())
+    );
+    map_step->info().add_data<cv::Mat>("image", DataUsage::Read);
+    map_step->info().add_data<cv::Mat>("stats", DataUsage::Read);
+    map_step->collect("blob_smooth", "blobs_smooth");
+    auto conncomp = std::make_shared<ConnCompStep>();
+    conncomp->info().rename_data("input", "image");
+    Scope scope("conncomp_scope");
+    scope.add(conncomp);
+    scope.add(map_step);
+    scope.freeze();
+    Plan plan(scope);
+    cv::Mat image = cv::Mat::zeros(64, 64, CV_8UC1);
+    for (int row = 8; row < 24; ++row)
+    {
+        for (int col = 8; col < 20; ++col)
+        {
+            image.at<uchar>(row, col) = 255;
+            image.at<uchar>(row + 32, col + 32) = 255;
+        }
+    }
+    Executor executor(std::make_shared<ThreadPool>(4u));
+    std::vector<VarData> slots(plan.slot_count());
+    slots.at(plan.find_slot("image").value()).emplace<cv::Mat>(image);
+    executor.run(plan, slots);
+    const auto& blobs = slots.at(plan.find_slot("blobs_smooth").value()).as<MapStep::Items>();
+    cout << "Blob count: " << blobs.size() << std::endl;
+    // Two 12 x 16 blobs; each item blurs the region of its bounding box.
+    if (blobs.size() != 2u)
+    {
+        throw std::runtime_error("map_step_testcase_2: unexpected blob count.");
+    }
+    for (const auto& blob : blobs)
+    {
+        const cv::Mat& mat = blob.as<cv::Mat>();
+        cout << "Blob size: " << mat.cols << " x " << mat.rows << std::endl;
+        if (mat.cols != 12 || mat.rows != 16)
+        {
+            throw std::runtime_error("map_step_testcase_2: unexpected blob size.");
+        }
+    }
+    cout << "map_step_testcase_2 success." << std::endl;
+}
+
+INLINE_NEVER
+void map_step_testcase_3(OStrm cout)
+{
+    cout << "running map_step_testcase_3..." << std::endl;
+    PlanPtr item_plan = make_square_plan();
+    const size_t value_slot = item_plan->find_slot("value").value();
+    auto count_func = [](const std::vector<VarData>& data) -> size_t {
+        return static_cast<size_t>(data.at(0).as<int>());
+    };
+    auto bind_func = [value_slot](size_t item_index, const std::vector<VarData>& /*data*/, std::vector<VarData>& item_slots) {
+        item_slots.at(value_slot).emplace<int>(static_cast<int>(item_index));
+    };
+    auto map_step = std::make_shared<MapStep>("map_square", item_plan, count_func, bind_func);
+    map_step->info().add_data<int>("count", DataUsage::Read);
+    map_step->collect("square", "squares");
+    auto reduce_step = ReduceStep::create<long long>(
+        "sum_squares", "squares", "sum", 0LL,
+        [](const long long& lhs, const long long& rhs) { return lhs + rhs; }
+    );
+    Scope scope("fan_in_scope");
+    scope.add(map_step);
+    scope.add(reduce_step);
+    scope.freeze();
+    Plan plan(scope);
+    Executor executor(std::make_shared<ThreadPool>(4u));
+    for (int count : {0, 1, 7, 1000})
+    {
+        std::vector<VarData> slots(plan.slot_count());
+        slots.at(plan.find_slot("count").value()).emplace<int>(count);
+        executor.run(plan, slots);
+        const long long sum = slots.at(plan.find_slot("sum").value()).as<long long>();
+        const long long n = count;
+        const long long expect = (n > 0) ? (n - 1) * n * (2 * n - 1) / 6 : 0;
+        cout << "Count: " << count << ", sum of squares: " << sum << std::endl;
+        if (sum != expect)
+        {
+            throw std::runtime_error("map_step_testcase_3: unexpected result.");
+        }
+    }
+    cout << "map_step_testcase_3 success." << std::endl;
+}
+
+INLINE_NEVER
+void map_step_testcase()
+{
+    OStrm cout;
+    map_step_testcase_1(cout);
+    map_step_testcase_2(cout);
+    map_step_testcase_3(cout);
+}
@@ -0,0 +1,195 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <opencv2/core.hpp>
+#include "tg/core/fwd.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/core/memory_budget.hpp"
+#include "tg/core/runtime.hpp"
+#include "tg/core/thread_pool.hpp"
+#include "tg/core/testcase/blur_step.hpp"
+#include "tg/opencv/data_sizes.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+using namespace tg::core::testcase;
+
+namespace //(unnamed)
+{
+
+/**
+ * @brief Tracks how many runs execute at once.
+ */
+class OccupyStep : public Step
+{
+public:
+    explicit OccupyStep(std::atomic<int>& active, std::atomic<int>& peak)
+        : Step{}
+        , m_active{active}
+        , m_peak{peak}
+    {
+        this->info().set_shortname("occupy");
+        this->info().add_data<int>("size", DataUsage::Read);
+        this->info().add_data<int>("done", DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        const int active = ++m_active;
+        int seen = m_peak.load();
+        while (active > seen && !m_peak.compare_exchange_weak(seen, active))
+        {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        --m_active;
+        data.at(1).emplace<int>(data.at(0).as<int>());
+        this->post_execute_validation(data);
+    }
+private:
+    std::atomic<int>& m_active;
+    std::atomic<int>& m_peak;
+};
+
+/**
+ * @brief Predicts the peak memory of a run as its "size" input.
+ */
+size_t predict_by_size(const Plan& plan, const std::vector<VarData>& slots)
+{
+    return static_cast<size_t>(slots.at(plan.find_slot("size").value()).as<int>());
+}
+
+void write_file(const std::filesystem::path& path, const std::string& text)
+{
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream file(path);
+    file << text << "\n";
+}
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void memory_budget_testcase_1(OStrm cout)
+{
+    cout << "running memory_budget_testcase_1..." << std::endl;
+    const auto root = std::filesystem::temp_directory_path() / "tg_memory_budget_testcase";
+    std::filesystem::remove_all(root);
+    write_file(root / "v2_max" / "memory.max", "max");
+    write_file(root / "v2" / "memory.max", "536870912");
+    write_file(root / "v1_max" / "memory" / "memory.limit_in_bytes", "9223372036854771712");
+    write_file(root / "v1" / "memory" / "memory.limit_in_bytes", "1073741824");
+    std::filesystem::create_directories(root / "none");
+    // The limit of the cgroup of the process, bound by its ancestors.
+    write_file(root / "self_v2", "12:pids:/\n0::/app/worker");
+    write_file(root / "nested_v2" / "memory.max", "max");
+    write_file(root / "nested_v2" / "app" / "memory.max", "268435456");
+    write_file(root / "nested_v2" / "app" / "worker" / "memory.max", "max");
+    write_file(root / "self_v1", "4:cpu,memory:/job/\n0::/");
+    write_file(root / "nested_v1" / "memory" / "memory.limit_in_bytes", "9223372036854771712");
+    write_file(root / "nested_v1" / "memory" / "job" / "memory.limit_in_bytes", "134217728");
+    const bool is_ok =
+        !MemoryBudget::read_cgroup_limit((root / "v2_max").string()).has_value() &&
+        MemoryBudget::read_cgroup_limit((root / "v2").string()) == std::optional<size_t>(536870912u) &&
+        !MemoryBudget::read_cgroup_limit((root / "v1_max").string()).has_value() &&
+        MemoryBudget::read_cgroup_limit((root / "v1").string()) == std::optional<size_t>(1073741824u) &&
+        !MemoryBudget::read_cgroup_limit((root / "none").string()).has_value() &&
+        MemoryBudget::read_cgroup_limit((root / "nested_v2").string(), (root / "self_v2").string()) == std::optional<size_t>(268435456u) &&
+        MemoryBudget::read_cgroup_limit((root / "nested_v1").string(), (root / "self_v1").string()) == std::optional<size_t>(134217728u);
+    std::filesystem::remove_all(root);
+    const auto limit = MemoryBudget::read_cgroup_limit();
+    cout << "cgroup limit of this process: " << (limit.has_value() ? std::to_string(limit.value()) : "none") << std::endl;
+    auto budget = MemoryBudget::from_environment(0.8, 1u << 30u);
+    cout << "Budget from environment: " << budget->budget() << std::endl;
+    if (!is_ok)
+    {
+        throw std::runtime_error("memory_budget_testcase_1: unexpected cgroup limit.");
+    }
+    cout << "memory_budget_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void memory_budget_testcase_2(OStrm cout)
+{
+    cout << "running memory_budget_testcase_2..." << std::endl;
+    std::atomic<int> active{0};
+    std::atomic<int> peak{0};
+    Scope scope("budget_scope");
+    scope.add(std::make_shared<OccupyStep>(active, peak));
+    scope.freeze();
+    Plan plan(scope);
+    auto budget = std::make_shared<MemoryBudget>(10u);
+    Executor executor(std::make_shared<ThreadPool>(4u));
+    executor.set_memory_budget(budget, predict_by_size);
+    // Callers on their own threads: two runs of 6 never fit together.
+    std::vector<std::thread> callers;
+    for (int k = 0; k < 6; ++k)
+    {
+        callers.emplace_back([&]() {
+            std::vector<VarData> slots(plan.slot_count());
+            slots.at(plan.find_slot("size").value()).emplace<int>(6);
+            executor.run(plan, slots);
+        });
+    }
+    for (auto& caller : callers)
+    {
+        caller.join();
+    }
+    const int executor_peak = peak.exchange(0);
+    // Requests of a Runtime sharing the budget are admitted before queueing.
+    Runtime runtime(std::make_shared<Plan>(scope), std::make_shared<ThreadPool>(4u));
+    runtime.executor().set_memory_budget(budget, predict_by_size);
+    std::vector<std::future<Runtime::NamedData>> futures;
+    for (int size : {6, 6, 6, 6, 25, 6})
+    {
+        Runtime::NamedData inputs;
+        inputs["size"].emplace<int>(size);
+        futures.push_back(runtime.submit(std::move(inputs)));
+    }
+    for (auto& future : futures)
+    {
+        future.get();
+    }
+    const int runtime_peak = peak.load();
+    cout << "Peak concurrent runs: executor " << executor_peak << ", runtime " << runtime_peak << std::endl;
+    if (executor_peak != 1 || runtime_peak != 1 || budget->in_use() != 0u || budget->waiting_count() != 0u)
+    {
+        throw std::runtime_error("memory_budget_testcase_2: budget not enforced.");
+    }
+    cout << "memory_budget_testcase_2 success." << std::endl;
+}
+
+INLINE_NEVER
+void memory_budget_testcase_3(OStrm cout)
+{
+    cout << "running memory_budget_testcase_3..." << std::endl;
+    tg::opencv::register_data_sizes();
+    Scope scope("blur_scope");
+    scope.add(std::make_shared<BlurStep>(1.0, 1.0));
+    scope.freeze();
+    Plan plan(scope);
+    Executor executor;
+    std::vector<VarData> slots(plan.slot_count());
+    slots.at(plan.find_slot("input").value()).emplace<cv::Mat>(cv::Mat::zeros(100, 100, CV_8UC3));
+    const size_t predicted = executor.predict_peak(plan, slots);
+    cout << "Predicted peak: " << predicted << std::endl;
+    if (predicted != 2u * 30000u)
+    {
+        throw std::runtime_error("memory_budget_testcase_3: unexpected prediction.");
+    }
+    cout << "memory_budget_testcase_3 success." << std::endl;
+}
+
+INLINE_NEVER
+void memory_budget_testcase()
+{
+    OStrm cout;
+    memory_budget_testcase_1(cout);
+    memory_budget_testcase_2(cout);
+    memory_budget_testcase_3(cout);
+}
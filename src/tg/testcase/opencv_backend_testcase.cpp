@@ -0,0 +1,135 @@
+#include <iostream>
+#include <string>
+#include <opencv2/core.hpp>
+#include "tg/core/fwd.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/core/thread_pool.hpp"
+#include "tg/opencv/parallel_backend.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+using tg::opencv::ThreadPoolBackend;
+
+namespace //(unnamed)
+{
+
+/**
+ * @brief Counts the visits of each index, and the visits made from a
+ * thread with an out-of-range thread number.
+ */
+class CountBody : public cv::ParallelLoopBody
+{
+public:
+    CountBody(std::vector<std::atomic<int>>& counts, const ThreadPoolBackend& backend)
+        : m_counts{counts}
+        , m_backend{backend}
+        , m_bad_thread_nums{0}
+    {}
+    void operator()(const cv::Range& range) const override {
+        const int thread_num = m_backend.getThreadNum();
+        if (thread_num < 0 || thread_num >= m_backend.getNumThreads())
+        {
+            ++m_bad_thread_nums;
+        }
+        for (int k = range.start; k < range.end; ++k)
+        {
+            ++m_counts.at(static_cast<size_t>(k));
+        }
+    }
+    int bad_thread_nums() const {
+        return m_bad_thread_nums.load();
+    }
+private:
+    std::vector<std::atomic<int>>& m_counts;
+    const ThreadPoolBackend& m_backend;
+    mutable std::atomic<int> m_bad_thread_nums;
+};
+
+/**
+ * @brief A Step whose work is an OpenCV parallel region.
+ */
+class RegionStep : public Step
+{
+public:
+    RegionStep(std::string_view shortname, std::string_view output, const ThreadPoolBackend& backend)
+        : Step{}
+        , m_backend{backend}
+    {
+        this->info().set_shortname(shortname);
+        this->info().add_data<int>(output, DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        std::vector<std::atomic<int>> counts(10000u);
+        CountBody body(counts, m_backend);
+        cv::parallel_for_(cv::Range(0, static_cast<int>(counts.size())), body);
+        int total = 0;
+        for (const auto& count : counts)
+        {
+            total += count.load();
+        }
+        data.at(0).emplace<int>(total - body.bad_thread_nums());
+        this->post_execute_validation(data);
+    }
+private:
+    const ThreadPoolBackend& m_backend;
+};
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void opencv_backend_testcase_1(OStrm cout)
+{
+    cout << "running opencv_backend_testcase_1..." << std::endl;
+    auto pool = std::make_shared<ThreadPool>(4u);
+    const ThreadPoolBackend backend(pool);
+    ThreadPoolBackend::install(pool);
+    // A region started from outside the pool.
+    std::vector<std::atomic<int>> counts(100000u);
+    CountBody body(counts, backend);
+    cv::parallel_for_(cv::Range(0, static_cast<int>(counts.size())), body);
+    for (const auto& count : counts)
+    {
+        if (count.load() != 1)
+        {
+            throw std::runtime_error("opencv_backend_testcase_1: index not visited exactly once.");
+        }
+    }
+    if (body.bad_thread_nums() != 0)
+    {
+        throw std::runtime_error("opencv_backend_testcase_1: thread number out of range.");
+    }
+    // Regions started from concurrent Steps share the pool of the Executor.
+    Scope scope("region_scope");
+    for (int k = 0; k < 8; ++k)
+    {
+        scope.add(std::make_shared<RegionStep>("region" + std::to_string(k), "total" + std::to_string(k), backend));
+    }
+    scope.freeze();
+    Plan plan(scope);
+    Executor executor(pool);
+    std::vector<VarData> slots(plan.slot_count());
+    executor.run(plan, slots);
+    for (int k = 0; k < 8; ++k)
+    {
+        if (slots.at(plan.find_slot("total" + std::to_string(k)).value()).as<int>() != 10000)
+        {
+            throw std::runtime_error("opencv_backend_testcase_1: nested region gave a wrong result.");
+        }
+    }
+    cout << "Backend: " << backend.getName() << ", threads: " << backend.getNumThreads() << std::endl;
+    ThreadPoolBackend::install(nullptr);
+    cout << "opencv_backend_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void opencv_backend_testcase()
+{
+    OStrm cout;
+    opencv_backend_testcase_1(cout);
+}
@@ -0,0 +1,202 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "tg/core/fwd.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+
+namespace //(unnamed)
+{
+
+class AddStep : public Step
+{
+public:
+    AddStep(std::string_view shortname, std::string_view input, std::string_view output, int addend)
+        : Step{}
+        , m_addend{addend}
+    {
+        this->info().set_shortname(shortname);
+        this->info().add_data<int>(input, DataUsage::Read);
+        this->info().add_data<int>(output, DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        data.at(1).emplace<int>(data.at(0).as<int>() + m_addend);
+        this->post_execute_validation(data);
+    }
+private:
+    int m_addend;
+};
+
+/**
+ * @brief Checks the invariants that the executors rely on.
+ */
+void check_plan(const Plan& plan, const char* what)
+{
+    std::vector<size_t> pos(plan.step_count(), ~static_cast<size_t>(0u));
+    const auto& order = plan.topo_order();
+    for (size_t k = 0u; k < order.size(); ++k)
+    {
+        pos.at(order.at(k)) = k;
+    }
+    if (order.size() != plan.live_step_count())
+    {
+        throw std::runtime_error(std::string("plan_edit_testcase: ") + what + ": bad order size.");
+    }
+    for (size_t from : order)
+    {
+        const PlanStep& plan_step = plan.step_at(from);
+        if (plan_step.m_predecessor_count != plan_step.m_predecessors.size())
+        {
+            throw std::runtime_error(std::string("plan_edit_testcase: ") + what + ": bad predecessor count.");
+        }
+        for (size_t to : plan_step.m_successors)
+        {
+            if (pos.at(to) <= pos.at(from))
+            {
+                throw std::runtime_error(std::string("plan_edit_testcase: ") + what + ": order violated.");
+            }
+        }
+    }
+}
+
+int run_plan(const Plan& plan, int input, std::string_view output)
+{
+    Executor executor;
+    std::vector<VarData> slots(plan.slot_count());
+    slots.at(plan.find_slot("x0").value()).emplace<int>(input);
+    executor.run(plan, slots);
+    return slots.at(plan.find_slot(output).value()).as<int>();
+}
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void plan_edit_testcase_1(OStrm cout)
+{
+    cout << "running plan_edit_testcase_1..." << std::endl;
+    Scope scope("edit_scope");
+    scope.add(std::make_shared<AddStep>("a", "x0", "x1", 1));
+    scope.add(std::make_shared<AddStep>("b", "x1", "x2", 10));
+    scope.add(std::make_shared<AddStep>("c", "x2", "x3", 100));
+    scope.freeze();
+    Plan plan(scope);
+    check_plan(plan, "compiled");
+    // Insert a Step between a and b: b now reads "y".
+    const size_t d = plan.add_step(std::make_shared<AddStep>("d", "x1", "y", 1000));
+    plan.rewire(1u, "x1", "y");
+    check_plan(plan, "inserted");
+    if (run_plan(plan, 0, "x3") != 1111)
+    {
+        throw std::runtime_error("plan_edit_testcase_1: unexpected result after insertion.");
+    }
+    // A Step reading x3 and writing x0's input again would close a cycle.
+    const size_t slot_count = plan.slot_count();
+    bool rejected = false;
+    try
+    {
+        plan.add_step(std::make_shared<AddStep>("e", "x3", "x1_alt", 0));
+        plan.rewire(0u, "x0", "x1_alt");
+    }
+    catch (const std::runtime_error& e)
+    {
+        cout << "Rejected: " << e.what() << std::endl;
+        rejected = true;
+    }
+    check_plan(plan, "rejected");
+    if (!rejected || plan.find_slot("x0") != plan.step_at(0u).m_slots.at(0u))
+    {
+        throw std::runtime_error("plan_edit_testcase_1: cycle not rejected.");
+    }
+    // A Step cannot be rewired to read the slot it writes.
+    bool alias_rejected = false;
+    try
+    {
+        plan.rewire(2u, "x2", "x3");
+    }
+    catch (const std::runtime_error& e)
+    {
+        cout << "Rejected: " << e.what() << std::endl;
+        alias_rejected = true;
+    }
+    check_plan(plan, "alias rejected");
+    if (!alias_rejected || plan.find_slot("x2") != plan.step_at(2u).m_slots.at(0u))
+    {
+        throw std::runtime_error("plan_edit_testcase_1: aliasing rewire not rejected.");
+    }
+    // A Step rejected for closing a cycle leaves the reduced edges in use.
+    plan.reduce_edges();
+    const size_t step_count = plan.step_count();
+    bool is_still_reduced = false;
+    try
+    {
+        plan.add_step(std::make_shared<AddStep>("g", "x3", "x0", 0));
+    }
+    catch (const std::runtime_error& e)
+    {
+        cout << "Rejected: " << e.what() << std::endl;
+        is_still_reduced = plan.is_reduced();
+    }
+    check_plan(plan, "cycle rejected");
+    if (!is_still_reduced || plan.step_count() != step_count)
+    {
+        throw std::runtime_error("plan_edit_testcase_1: rejected Step changed the Plan.");
+    }
+    // Remove d and e again, restoring the original chain.
+    plan.remove_step(plan.step_count() - 1u);
+    plan.remove_step(d);
+    plan.rewire(1u, "x1", "x1");
+    check_plan(plan, "removed");
+    if (run_plan(plan, 0, "x3") != 111 || plan.slot_count() > slot_count + 1u || plan.find_slot("y").has_value())
+    {
+        throw std::runtime_error("plan_edit_testcase_1: unexpected result after removal.");
+    }
+    cout << "plan_edit_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void plan_edit_testcase_2(OStrm cout)
+{
+    cout << "running plan_edit_testcase_2..." << std::endl;
+    using Clock = std::chrono::steady_clock;
+    constexpr int chain_length = 20000;
+    Scope scope("long_scope");
+    for (int k = 0; k < chain_length; ++k)
+    {
+        scope.add(std::make_shared<AddStep>(
+            "s" + std::to_string(k), "x" + std::to_string(k), "x" + std::to_string(k + 1), 1
+        ));
+    }
+    scope.freeze();
+    auto start = Clock::now();
+    Plan plan(scope);
+    auto full_us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+    // Splice a Step in the middle, appended last in index order.
+    const std::string mid = "x" + std::to_string(chain_length / 2);
+    start = Clock::now();
+    plan.add_step(std::make_shared<AddStep>("splice", mid, "spliced", 1000));
+    plan.rewire(static_cast<size_t>(chain_length / 2), mid, "spliced");
+    auto edit_us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+    cout << "Full compile: " << full_us << " us, splice: " << edit_us << " us" << std::endl;
+    check_plan(plan, "spliced");
+    if (run_plan(plan, 0, "x" + std::to_string(chain_length)) != chain_length + 1000)
+    {
+        throw std::runtime_error("plan_edit_testcase_2: unexpected result.");
+    }
+    cout << "plan_edit_testcase_2 success." << std::endl;
+}
+
+INLINE_NEVER
+void plan_edit_testcase()
+{
+    OStrm cout;
+    plan_edit_testcase_1(cout);
+    plan_edit_testcase_2(cout);
+}
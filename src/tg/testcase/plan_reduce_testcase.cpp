@@ -0,0 +1,221 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include "tg/core/fwd.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/core/thread_pool.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+
+namespace //(unnamed)
+{
+
+/**
+ * @brief Writes one plus the sum of its inputs, modulo 2^64 (the sums of
+ * a dense chain grow exponentially).
+ */
+class SumStep : public Step
+{
+public:
+    SumStep(std::string_view shortname, const std::vector<std::string>& inputs, std::string_view output)
+        : Step{}
+    {
+        this->info().set_shortname(shortname);
+        for (const auto& input : inputs)
+        {
+            this->info().add_data<uint64_t>(input, DataUsage::Read);
+        }
+        this->info().add_data<uint64_t>(output, DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        uint64_t sum = 1u;
+        for (size_t k = 0u; k + 1u < data.size(); ++k)
+        {
+            sum += data.at(k).as<uint64_t>();
+        }
+        data.back().emplace<uint64_t>(sum);
+        this->post_execute_validation(data);
+    }
+};
+
+size_t count_edges(const Plan& plan, bool reduced)
+{
+    size_t count = 0u;
+    for (size_t step_index = 0u; step_index < plan.step_count(); ++step_index)
+    {
+        const PlanStep& plan_step = plan.step_at(step_index);
+        count += reduced ? plan_step.m_reduced_successors.size() : plan_step.m_successors.size();
+    }
+    return count;
+}
+
+/**
+ * @brief Reachability over full or reduced edges, as a matrix of flags.
+ */
+std::vector<std::vector<bool>> closure(const Plan& plan, bool reduced)
+{
+    const size_t step_count = plan.step_count();
+    std::vector<std::vector<bool>> reach(step_count, std::vector<bool>(step_count, false));
+    const auto& order = plan.topo_order();
+    for (auto iter = order.rbegin(); iter != order.rend(); ++iter)
+    {
+        const PlanStep& plan_step = plan.step_at(*iter);
+        for (size_t to : reduced ? plan_step.m_reduced_successors : plan_step.m_successors)
+        {
+            reach.at(*iter).at(to) = true;
+            for (size_t other = 0u; other < step_count; ++other)
+            {
+                if (reach.at(to).at(other))
+                {
+                    reach.at(*iter).at(other) = true;
+                }
+            }
+        }
+    }
+    return reach;
+}
+
+uint64_t run_plan(const Plan& plan, Executor& executor, std::string_view output)
+{
+    std::vector<VarData> slots(plan.slot_count());
+    slots.at(plan.find_slot("v0").value()).emplace<uint64_t>(0);
+    executor.run(plan, slots);
+    return slots.at(plan.find_slot(output).value()).as<uint64_t>();
+}
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void plan_reduce_testcase_1(OStrm cout)
+{
+    cout << "running plan_reduce_testcase_1..." << std::endl;
+    // Step k reads every earlier value: k(k-1)/2 edges, reducing to a chain.
+    const size_t step_count = 200u;
+    Scope scope("dense_scope");
+    std::vector<std::string> names{"v0"};
+    for (size_t k = 1u; k <= step_count; ++k)
+    {
+        const std::string output = "v" + std::to_string(k);
+        scope.add(std::make_shared<SumStep>("sum" + std::to_string(k), names, output));
+        names.push_back(output);
+    }
+    scope.freeze();
+    Plan plan(scope);
+    const size_t full_edges = count_edges(plan, false);
+    const size_t reduced_edges = count_edges(plan, true);
+    cout << "Edges: " << full_edges << ", after reduction: " << reduced_edges << std::endl;
+    if (!plan.is_reduced() || reduced_edges != step_count - 1u)
+    {
+        throw std::runtime_error("plan_reduce_testcase_1: unexpected reduced edge count.");
+    }
+    Executor executor(std::make_shared<ThreadPool>(4u));
+    const std::string output = names.back();
+    const uint64_t expect = run_plan(plan, executor, output);
+    const int repeat = 50;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < repeat; ++k)
+    {
+        if (run_plan(plan, executor, output) != expect)
+        {
+            throw std::runtime_error("plan_reduce_testcase_1: unexpected result.");
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    // A no-op edit leaves the reduction stale; execution uses the full edges.
+    plan.rewire(0u, "v1", "v1_tmp");
+    plan.rewire(0u, "v1", "v1");
+    if (plan.is_reduced())
+    {
+        throw std::runtime_error("plan_reduce_testcase_1: reduction should be stale after an edit.");
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    for (int k = 0; k < repeat; ++k)
+    {
+        if (run_plan(plan, executor, output) != expect)
+        {
+            throw std::runtime_error("plan_reduce_testcase_1: unexpected result on full edges.");
+        }
+    }
+    auto t3 = std::chrono::steady_clock::now();
+    using us = std::chrono::microseconds;
+    cout << "Per run, reduced: " << std::chrono::duration_cast<us>(t1 - t0).count() / repeat
+        << " us, full: " << std::chrono::duration_cast<us>(t3 - t2).count() / repeat << " us" << std::endl;
+    plan.reduce_edges();
+    if (!plan.is_reduced() || count_edges(plan, true) != reduced_edges)
+    {
+        throw std::runtime_error("plan_reduce_testcase_1: reduction not restored.");
+    }
+    cout << "plan_reduce_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void plan_reduce_testcase_2(OStrm cout)
+{
+    cout << "running plan_reduce_testcase_2..." << std::endl;
+    // Random DAGs: the reduction must keep reachability and be minimal.
+    std::mt19937 rng(12345u);
+    for (int trial = 0; trial < 20; ++trial)
+    {
+        const size_t step_count = 40u;
+        Scope scope("random_scope");
+        std::vector<std::string> names{"v0"};
+        for (size_t k = 1u; k <= step_count; ++k)
+        {
+            std::vector<std::string> inputs;
+            for (const auto& name : names)
+            {
+                if (rng() % 4u == 0u)
+                {
+                    inputs.push_back(name);
+                }
+            }
+            const std::string output = "v" + std::to_string(k);
+            scope.add(std::make_shared<SumStep>("sum" + std::to_string(k), inputs, output));
+            names.push_back(output);
+        }
+        scope.freeze();
+        Plan plan(scope);
+        const auto full = closure(plan, false);
+        const auto reduced = closure(plan, true);
+        if (full != reduced)
+        {
+            throw std::runtime_error("plan_reduce_testcase_2: reachability changed.");
+        }
+        // Minimal: no kept edge is implied by another path.
+        for (size_t from = 0u; from < plan.step_count(); ++from)
+        {
+            for (size_t to : plan.step_at(from).m_reduced_successors)
+            {
+                for (size_t other : plan.step_at(from).m_reduced_successors)
+                {
+                    if (other != to && full.at(other).at(to))
+                    {
+                        throw std::runtime_error("plan_reduce_testcase_2: redundant edge kept.");
+                    }
+                }
+            }
+        }
+        if (trial == 0)
+        {
+            cout << "Edges: " << count_edges(plan, false) << ", after reduction: " << count_edges(plan, true) << std::endl;
+        }
+    }
+    cout << "plan_reduce_testcase_2 success." << std::endl;
+}
+
+INLINE_NEVER
+void plan_reduce_testcase()
+{
+    OStrm cout;
+    plan_reduce_testcase_1(cout);
+    plan_reduce_testcase_2(cout);
+}
@@ -0,0 +1,248 @@
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <opencv2/core.hpp>
+#include "tg/core/fwd.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/core/thread_pool.hpp"
+#include "tg/core/testcase/blur_step.hpp"
+#include "tg/opencv/data_meta.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+using namespace tg::core::testcase;
+
+namespace //(unnamed)
+{
+
+/**
+ * @brief Prepares a table per input height, and fails if executed on a
+ * height it was not prepared for.
+ */
+class RowTableStep : public Step
+{
+public:
+    RowTableStep() : Step{} {
+        this->info().set_shortname("row_table");
+        this->info().add_data<cv::Mat>("image", DataUsage::Read);
+        this->info().add_data<int>("rows", DataUsage::Write);
+    }
+    bool needs_prepare() const override {
+        return true;
+    }
+    void prepare(const std::vector<std::optional<DataMeta>>& metas) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tables.insert(metas.at(0).value().m_rows);
+        ++m_prepare_calls;
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        const int rows = data.at(0).as<cv::Mat>().rows;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_tables.count(rows) == 0u)
+            {
+                throw std::runtime_error("RowTableStep: not prepared for this shape.");
+            }
+        }
+        data.at(1).emplace<int>(rows);
+        this->post_execute_validation(data);
+    }
+    size_t prepare_calls() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_prepare_calls;
+    }
+private:
+    mutable std::mutex m_mutex;
+    std::set<int> m_tables;
+    size_t m_prepare_calls = 0u;
+};
+
+/**
+ * @brief Counts its prepare() calls; the first one fails if asked to.
+ */
+class CountingPrepareStep : public Step
+{
+public:
+    explicit CountingPrepareStep(bool is_first_failing) : Step{}, m_is_first_failing{is_first_failing} {
+        this->info().set_shortname("counting_prepare");
+        this->info().add_data<cv::Mat>("image", DataUsage::Read);
+    }
+    bool needs_prepare() const override {
+        return true;
+    }
+    void prepare(const std::vector<std::optional<DataMeta>>& /*metas*/) override {
+        if (m_prepare_calls.fetch_add(1u) == 0u && m_is_first_failing)
+        {
+            throw std::runtime_error("CountingPrepareStep: failing as asked.");
+        }
+    }
+    void infer_meta(std::vector<std::optional<DataMeta>>& /*metas*/) const override {
+        ++m_infer_calls;
+    }
+    void execute(std::vector<VarData>& /*data*/) override {
+    }
+    size_t prepare_calls() const {
+        return m_prepare_calls.load();
+    }
+    size_t infer_calls() const {
+        return m_infer_calls.load();
+    }
+private:
+    bool m_is_first_failing;
+    std::atomic<size_t> m_prepare_calls{0u};
+    mutable std::atomic<size_t> m_infer_calls{0u};
+};
+
+std::vector<std::optional<DataMeta>> metas_of_rows(int rows)
+{
+    return {DataMeta{rows, 16, CV_8UC1, 1u}};
+}
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void prepare_testcase_1(OStrm cout)
+{
+    cout << "running prepare_testcase_1..." << std::endl;
+    tg::opencv::register_data_meta();
+    auto step = std::make_shared<RowTableStep>();
+    Scope scope("prepare_scope");
+    scope.add(step);
+    scope.freeze();
+    Plan plan(scope);
+    Executor executor(std::make_shared<ThreadPool>(4u));
+    std::vector<std::thread> callers;
+    for (int k = 0; k < 4; ++k)
+    {
+        callers.emplace_back([&, k]() {
+            for (int run = 0; run < 10; ++run)
+            {
+                std::vector<VarData> slots(plan.slot_count());
+                const int rows = ((k + run) % 2 == 0) ? 32 : 48;
+                slots.at(plan.find_slot("image").value()).emplace<cv::Mat>(cv::Mat::zeros(rows, 16, CV_8UC1));
+                executor.run(plan, slots);
+            }
+        });
+    }
+    for (auto& caller : callers)
+    {
+        caller.join();
+    }
+    cout << "Prepare calls: " << step->prepare_calls() << ", prepared shapes: " << step->prepared_count() << std::endl;
+    if (step->prepare_calls() != 2u || step->prepared_count() != 2u)
+    {
+        throw std::runtime_error("prepare_testcase_1: unexpected prepare calls.");
+    }
+    cout << "prepare_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void prepare_testcase_2(OStrm cout)
+{
+    cout << "running prepare_testcase_2..." << std::endl;
+    const int capacity = static_cast<int>(Step::prepared_capacity);
+    // The cache stays bounded; the least recently used shapes are dropped.
+    CountingPrepareStep step(false);
+    for (int rows = 1; rows <= 2 * capacity; ++rows)
+    {
+        step.ensure_prepared(metas_of_rows(rows));
+    }
+    const size_t after_fill = step.prepare_calls();
+    for (int rows = capacity + 1; rows <= 2 * capacity; ++rows)
+    {
+        step.ensure_prepared(metas_of_rows(rows));
+    }
+    // Repeating the last shape only compares it; outputs are inferred when preparing.
+    for (int k = 0; k < 4; ++k)
+    {
+        step.ensure_prepared(metas_of_rows(2 * capacity));
+    }
+    const size_t after_hits = step.prepare_calls();
+    step.ensure_prepared(metas_of_rows(1));
+    cout << "Prepared shapes: " << step.prepared_count() << ", prepare calls: " << step.prepare_calls() << std::endl;
+    if (step.prepared_count() != Step::prepared_capacity || after_fill != 2u * Step::prepared_capacity ||
+        after_hits != after_fill || step.prepare_calls() != after_fill + 1u ||
+        step.infer_calls() != step.prepare_calls())
+    {
+        throw std::runtime_error("prepare_testcase_2: unexpected cache behavior.");
+    }
+    // A failed prepare() is retried by the next caller.
+    CountingPrepareStep failing(true);
+    bool is_thrown = false;
+    try
+    {
+        failing.ensure_prepared(metas_of_rows(8));
+    }
+    catch (const std::runtime_error&)
+    {
+        is_thrown = true;
+    }
+    failing.ensure_prepared(metas_of_rows(8));
+    failing.ensure_prepared(metas_of_rows(8));
+    if (!is_thrown || failing.prepare_calls() != 2u)
+    {
+        throw std::runtime_error("prepare_testcase_2: failed prepare not retried.");
+    }
+    cout << "prepare_testcase_2 success." << std::endl;
+}
+
+INLINE_NEVER
+void prepare_testcase_3(OStrm cout)
+{
+    cout << "running prepare_testcase_3..." << std::endl;
+    tg::opencv::register_data_meta();
+    auto blur = std::make_shared<BlurStep>(2.0, 2.0);
+    Scope scope("blur_scope");
+    scope.add(blur);
+    scope.freeze();
+    Plan plan(scope);
+    Executor executor;
+    int mismatch = 0;
+    for (int rows : {40, 40, 80})
+    {
+        cv::Mat image = cv::Mat::zeros(rows, 40, CV_8UC1);
+        for (int row = 0; row < rows; ++row)
+        {
+            image.at<uchar>(row, row % 40) = 255;
+        }
+        std::vector<VarData> slots(plan.slot_count());
+        slots.at(plan.find_slot("input").value()).emplace<cv::Mat>(image);
+        executor.run(plan, slots);
+        // An unprepared BlurStep computes its parameters in place.
+        BlurStep direct(2.0, 2.0);
+        std::vector<VarData> data(2u);
+        data.at(0).emplace<cv::Mat>(image);
+        direct.execute(data);
+        const cv::Mat& expect = data.at(1).as<cv::Mat>();
+        const cv::Mat& actual = slots.at(plan.find_slot("output").value()).as<cv::Mat>();
+        for (int row = 0; row < rows; ++row)
+        {
+            for (int col = 0; col < 40; ++col)
+            {
+                mismatch += (expect.at<uchar>(row, col) != actual.at<uchar>(row, col)) ? 1 : 0;
+            }
+        }
+    }
+    cout << "Prepared shapes: " << blur->prepared_count() << ", mismatched pixels: " << mismatch << std::endl;
+    if (blur->prepared_count() != 2u || mismatch != 0)
+    {
+        throw std::runtime_error("prepare_testcase_3: unexpected result.");
+    }
+    cout << "prepare_testcase_3 success." << std::endl;
+}
+
+INLINE_NEVER
+void prepare_testcase()
+{
+    OStrm cout;
+    prepare_testcase_1(cout);
+    prepare_testcase_2(cout);
+    prepare_testcase_3(cout);
+}
@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "tg/core/fwd.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/core/thread_pool.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+
+namespace //(unnamed)
+{
+
+/**
+ * @brief Records the lane of itself, and of the subtasks it spawns.
+ */
+class LaneProbeStep : public Step
+{
+public:
+    LaneProbeStep()
+        : Step{}
+    {
+        this->info().set_shortname("probe");
+        this->info().add_data<int>("input", DataUsage::Read);
+        this->info().add_data<int>("mismatches", DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        const TaskPriority expect = static_cast<TaskPriority>(data.at(0).as<int>());
+        std::atomic<int> mismatches{0};
+        if (ThreadPool::current_priority() != expect)
+        {
+            ++mismatches;
+        }
+        ThreadPool::current()->parallel_for(16u, [&](size_t /*index*/) {
+            if (ThreadPool::current_priority() != expect)
+            {
+                ++mismatches;
+            }
+        });
+        data.at(1).emplace<int>(mismatches.load());
+        this->post_execute_validation(data);
+    }
+};
+
+/**
+ * @brief Holds the single worker of a pool while tasks are queued, then
+ * records the order in which the lanes are served.
+ */
+std::vector<TaskPriority> serve_order(ThreadPool& pool, size_t latency_count, size_t batch_count)
+{
+    std::atomic<bool> gate{false};
+    pool.submit([&gate]() {
+        while (!gate.load())
+        {
+            std::this_thread::yield();
+        }
+    }, TaskPriority::Latency);
+    std::mutex mutex;
+    std::vector<TaskPriority> order;
+    std::atomic<size_t> done{0u};
+    auto make_task = [&](TaskPriority priority) {
+        return [&, priority]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(priority);
+            ++done;
+        };
+    };
+    for (size_t k = 0u; k < std::max(latency_count, batch_count); ++k)
+    {
+        if (k < batch_count)
+        {
+            pool.submit(make_task(TaskPriority::Batch), TaskPriority::Batch);
+        }
+        if (k < latency_count)
+        {
+            pool.submit(make_task(TaskPriority::Latency), TaskPriority::Latency);
+        }
+    }
+    gate = true;
+    while (done.load() < latency_count + batch_count)
+    {
+        std::this_thread::yield();
+    }
+    return order;
+}
+
+size_t count_batch(const std::vector<TaskPriority>& order, size_t first_count)
+{
+    return static_cast<size_t>(std::count(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(first_count), TaskPriority::Batch));
+}
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void priority_lane_testcase_1(OStrm cout)
+{
+    cout << "running priority_lane_testcase_1..." << std::endl;
+    ThreadPool pool(1u);
+    // Strict priority: all latency-critical tasks go first.
+    pool.set_batch_share(0.0);
+    auto order = serve_order(pool, 100u, 100u);
+    const size_t strict_batch = count_batch(order, 100u);
+    // With a quarter reserved, batch work gets about a quarter of the picks.
+    pool.set_batch_share(0.25);
+    order = serve_order(pool, 100u, 100u);
+    const size_t shared_batch = count_batch(order, 100u);
+    cout << "Batch tasks among the first 100: strict " << strict_batch << ", shared " << shared_batch << std::endl;
+    if (strict_batch != 0u || shared_batch < 20u || shared_batch > 30u)
+    {
+        throw std::runtime_error("priority_lane_testcase_1: unexpected lane order.");
+    }
+    bool is_rejected = false;
+    try
+    {
+        pool.set_batch_share(1.5);
+    }
+    catch (const std::invalid_argument&)
+    {
+        is_rejected = true;
+    }
+    if (!is_rejected || pool.batch_share() != 0.25)
+    {
+        throw std::runtime_error("priority_lane_testcase_1: bad share accepted.");
+    }
+    cout << "priority_lane_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void priority_lane_testcase_2(OStrm cout)
+{
+    cout << "running priority_lane_testcase_2..." << std::endl;
+    Scope scope("probe_scope");
+    scope.add(std::make_shared<LaneProbeStep>());
+    scope.freeze();
+    Plan plan(scope);
+    auto pool = std::make_shared<ThreadPool>(2u);
+    Executor interactive(pool);
+    Executor bulk(pool);
+    bulk.set_priority(TaskPriority::Batch);
+    for (const Executor* p_executor : {&interactive, &bulk})
+    {
+        std::vector<VarData> slots(plan.slot_count());
+        slots.at(plan.find_slot("input").value()).emplace<int>(static_cast<int>(p_executor->priority()));
+        p_executor->run(plan, slots);
+        const int mismatches = slots.at(plan.find_slot("mismatches").value()).as<int>();
+        if (mismatches != 0)
+        {
+            throw std::runtime_error("priority_lane_testcase_2: task ran in the wrong lane.");
+        }
+    }
+    cout << "priority_lane_testcase_2 success." << std::endl;
+}
+
+INLINE_NEVER
+void priority_lane_testcase()
+{
+    OStrm cout;
+    priority_lane_testcase_1(cout);
+    priority_lane_testcase_2(cout);
+}
@@ -0,0 +1,295 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <opencv2/core.hpp>
+#include "tg/core/fwd.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/core/map_step.hpp"
+#include "tg/core/resource_manager.hpp"
+#include "tg/core/thread_pool.hpp"
+#include "tg/core/testcase/conncomp_step.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+using namespace tg::core::testcase;
+
+namespace //(unnamed)
+{
+
+/**
+ * @brief Tracks the peak number of Steps and of declared bytes in flight.
+ */
+struct Occupancy
+{
+    std::atomic<size_t> m_steps{0u};
+    std::atomic<size_t> m_bytes{0u};
+    std::atomic<size_t> m_peak_steps{0u};
+    std::atomic<size_t> m_peak_bytes{0u};
+
+    static void stc_raise(std::atomic<size_t>& peak, size_t value)
+    {
+        size_t seen = peak.load();
+        while (value > seen && !peak.compare_exchange_weak(seen, value))
+        {
+        }
+    }
+};
+
+class HeavyStep : public Step
+{
+public:
+    HeavyStep(int index, ResourceDemand demand, Occupancy& occupancy)
+        : Step{}
+        , m_demand{std::move(demand)}
+        , m_occupancy{occupancy}
+    {
+        this->info().set_shortname("heavy_" + std::to_string(index));
+        this->info().add_data<int>("seed", DataUsage::Read);
+        this->info().add_data<int>("heavy_out_" + std::to_string(index), DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        Occupancy::stc_raise(m_occupancy.m_peak_steps, ++m_occupancy.m_steps);
+        Occupancy::stc_raise(m_occupancy.m_peak_bytes, m_occupancy.m_bytes += m_demand.m_scratch_bytes);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        m_occupancy.m_bytes -= m_demand.m_scratch_bytes;
+        --m_occupancy.m_steps;
+        data.at(1).emplace<int>(data.at(0).as<int>());
+        this->post_execute_validation(data);
+    }
+    ResourceDemand resource_demand(const std::vector<VarData>& /*data*/) const override {
+        return m_demand;
+    }
+private:
+    ResourceDemand m_demand;
+    Occupancy& m_occupancy;
+};
+
+PlanPtr make_heavy_plan(int width, const ResourceDemand& demand, Occupancy& occupancy, Occupancy& light_occupancy)
+{
+    Scope scope("heavy_scope");
+    for (int k = 0; k < width; ++k)
+    {
+        scope.add(std::make_shared<HeavyStep>(k, demand, occupancy));
+        // Light Steps declare nothing and are not held back.
+        scope.add(std::make_shared<HeavyStep>(width + k, ResourceDemand{0u, {}}, light_occupancy));
+    }
+    scope.freeze();
+    return std::make_shared<Plan>(scope);
+}
+
+void run_seeded(const Executor& executor, const Plan& plan)
+{
+    std::vector<VarData> slots(plan.slot_count());
+    slots.at(plan.find_slot("seed").value()).emplace<int>(1);
+    executor.run(plan, slots);
+}
+
+/**
+ * @brief A MapStep whose items each run one heavy Step.
+ */
+PlanPtr make_heavy_map_plan(size_t item_count, const ResourceDemand& demand, Occupancy& occupancy)
+{
+    Occupancy unused;
+    PlanPtr item_plan = make_heavy_plan(1, demand, occupancy, unused);
+    const size_t seed_slot = item_plan->find_slot("seed").value();
+    auto map_step = std::make_shared<MapStep>(
+        "map_heavy", item_plan,
+        [item_count](const std::vector<VarData>& /*data*/) { return item_count; },
+        [seed_slot](size_t item_index, const std::vector<VarData>& /*data*/, std::vector<VarData>& item_slots) {
+            item_slots.at(seed_slot).emplace<int>(static_cast<int>(item_index));
+        }
+    );
+    map_step->info().add_data<int>("seed", DataUsage::Read);
+    map_step->collect("heavy_out_0", "heavy_outs");
+    Scope scope("heavy_map_scope");
+    scope.add(map_step);
+    scope.freeze();
+    return std::make_shared<Plan>(scope);
+}
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void resource_testcase_1(OStrm cout)
+{
+    cout << "running resource_testcase_1..." << std::endl;
+    auto resources = std::make_shared<ResourceManager>();
+    resources->set_token_count("ccl-slot", 1u);
+    Occupancy heavy;
+    Occupancy light;
+    PlanPtr plan = make_heavy_plan(24, ResourceDemand{0u, {{"ccl-slot", 1u}}}, heavy, light);
+    Executor parallel(std::make_shared<ThreadPool>(4u));
+    parallel.set_resource_manager(resources);
+    Executor sequential;
+    sequential.set_resource_manager(resources);
+    run_seeded(parallel, *plan);
+    run_seeded(sequential, *plan);
+    cout << "Peak heavy Steps: " << heavy.m_peak_steps.load() << ", peak light Steps: " << light.m_peak_steps.load() << std::endl;
+    if (heavy.m_peak_steps.load() != 1u || resources->tokens_in_use("ccl-slot") != 0u || resources->waiting_count() != 0u)
+    {
+        throw std::runtime_error("resource_testcase_1: token limit not enforced.");
+    }
+    cout << "resource_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void resource_testcase_2(OStrm cout)
+{
+    cout << "running resource_testcase_2..." << std::endl;
+    const size_t megabyte = 1u << 20u;
+    auto resources = std::make_shared<ResourceManager>();
+    resources->set_scratch_budget(3u * megabyte);
+    Occupancy heavy;
+    Occupancy light;
+    PlanPtr plan = make_heavy_plan(24, ResourceDemand{megabyte, {}}, heavy, light);
+    // Two Executors sharing one budget.
+    auto pool = std::make_shared<ThreadPool>(4u);
+    Executor executor_a(pool);
+    Executor executor_b(pool);
+    executor_a.set_resource_manager(resources);
+    executor_b.set_resource_manager(resources);
+    std::thread thread_a([&]() { run_seeded(executor_a, *plan); });
+    std::thread thread_b([&]() { run_seeded(executor_b, *plan); });
+    thread_a.join();
+    thread_b.join();
+    cout << "Peak scratch bytes: " << heavy.m_peak_bytes.load() << std::endl;
+    if (heavy.m_peak_bytes.load() > 3u * megabyte || resources->scratch_in_use() != 0u)
+    {
+        throw std::runtime_error("resource_testcase_2: scratch budget exceeded.");
+    }
+    // A demand that can never fit fails the run instead of waiting forever.
+    Occupancy unused;
+    PlanPtr oversized = make_heavy_plan(1, ResourceDemand{4u * megabyte, {}}, unused, unused);
+    bool is_rejected = false;
+    try
+    {
+        run_seeded(executor_a, *oversized);
+    }
+    catch (const std::invalid_argument& ex)
+    {
+        cout << "Rejected: " << ex.what() << std::endl;
+        is_rejected = true;
+    }
+    if (!is_rejected)
+    {
+        throw std::runtime_error("resource_testcase_2: oversized demand accepted.");
+    }
+    cout << "resource_testcase_2 success." << std::endl;
+}
+
+INLINE_NEVER
+void resource_testcase_3(OStrm cout)
+{
+    cout << "running resource_testcase_3..." << std::endl;
+    ConnCompStep conncomp;
+    std::vector<VarData> data(4u);
+    data.at(0).emplace<cv::Mat>(cv::Mat::zeros(480, 640, CV_8UC1));
+    const ResourceDemand demand = conncomp.resource_demand(data);
+    cout << "ConnCompStep scratch bytes: " << demand.m_scratch_bytes << std::endl;
+    // Labels, then stats and centroids for up to 240 x 320 components and the background.
+    const size_t expected_bytes = 480u * 640u * 4u + (240u * 320u + 1u) * (5u * 4u + 2u * 8u);
+    if (demand.m_scratch_bytes != expected_bytes || demand.m_tokens.size() != 1u || demand.m_tokens.front().first != "ccl-slot")
+    {
+        throw std::runtime_error("resource_testcase_3: unexpected demand.");
+    }
+    cout << "resource_testcase_3 success." << std::endl;
+}
+
+INLINE_NEVER
+void resource_testcase_4(OStrm cout)
+{
+    cout << "running resource_testcase_4..." << std::endl;
+    auto resources = std::make_shared<ResourceManager>();
+    resources->set_token_count("ccl-slot", 1u);
+    // The items of a MapStep run on their own Executor, yet are limited by
+    // the ResourceManager of the enclosing run.
+    Occupancy heavy;
+    PlanPtr plan = make_heavy_map_plan(16u, ResourceDemand{0u, {{"ccl-slot", 1u}}}, heavy);
+    Executor executor(std::make_shared<ThreadPool>(4u));
+    executor.set_resource_manager(resources);
+    run_seeded(executor, *plan);
+    cout << "Peak heavy items: " << heavy.m_peak_steps.load() << std::endl;
+    if (heavy.m_peak_steps.load() != 1u || resources->tokens_in_use("ccl-slot") != 0u)
+    {
+        throw std::runtime_error("resource_testcase_4: nested Steps not limited.");
+    }
+    // A limit cannot be lowered below a queued demand, which could then never be admitted.
+    const ResourceDemand slot{0u, {{"ccl-slot", 1u}}};
+    resources->try_acquire(slot);
+    if (resources->acquire_or_wait(slot, []() {}))
+    {
+        throw std::runtime_error("resource_testcase_4: demand not queued.");
+    }
+    bool is_rejected = false;
+    try
+    {
+        resources->set_token_count("ccl-slot", 0u);
+    }
+    catch (const std::invalid_argument& ex)
+    {
+        cout << "Rejected: " << ex.what() << std::endl;
+        is_rejected = true;
+    }
+    resources->release(slot);
+    if (!is_rejected || resources->waiting_count() != 0u || resources->tokens_in_use("ccl-slot") != 1u)
+    {
+        throw std::runtime_error("resource_testcase_4: queued demand stranded.");
+    }
+    resources->release(slot);
+    cout << "resource_testcase_4 success." << std::endl;
+}
+
+INLINE_NEVER
+void resource_testcase_5(OStrm cout)
+{
+    cout << "running resource_testcase_5..." << std::endl;
+    ResourceManager resources;
+    resources.set_scratch_budget(3u);
+    const ResourceDemand large{3u, {}};
+    const ResourceDemand small{1u, {}};
+    // A small demand that would fit does not overtake a queued large one.
+    const bool is_held = resources.try_acquire(ResourceDemand{2u, {}});
+    bool is_large_admitted = false;
+    bool is_small_admitted = false;
+    const int large_owner = 0;
+    resources.acquire_or_wait(large, [&]() { is_large_admitted = true; }, &large_owner);
+    const bool is_small_refused = !resources.try_acquire(small);
+    resources.acquire_or_wait(small, [&]() { is_small_admitted = true; });
+    const bool is_fifo_held = !is_large_admitted && !is_small_admitted && resources.waiting_count() == 2u;
+    resources.release(ResourceDemand{2u, {}});
+    const bool is_large_first = is_large_admitted && !is_small_admitted;
+    resources.release(large);
+    const bool is_small_next = is_small_admitted && resources.scratch_in_use() == 1u;
+    resources.release(small);
+    // Withdrawing the head of the queue admits the demands behind it.
+    resources.try_acquire(ResourceDemand{2u, {}});
+    is_small_admitted = false;
+    resources.acquire_or_wait(large, []() {}, &large_owner);
+    resources.acquire_or_wait(small, [&]() { is_small_admitted = true; });
+    resources.withdraw(&large_owner);
+    const bool is_unblocked = is_small_admitted && resources.waiting_count() == 0u;
+    cout << "Admitted in order: " << is_large_first << ", after withdraw: " << is_unblocked << std::endl;
+    if (!is_held || !is_small_refused || !is_fifo_held || !is_large_first || !is_small_next || !is_unblocked)
+    {
+        throw std::runtime_error("resource_testcase_5: demands not admitted in arrival order.");
+    }
+    cout << "resource_testcase_5 success." << std::endl;
+}
+
+INLINE_NEVER
+void resource_testcase()
+{
+    OStrm cout;
+    resource_testcase_1(cout);
+    resource_testcase_2(cout);
+    resource_testcase_3(cout);
+    resource_testcase_4(cout);
+    resource_testcase_5(cout);
+}
@@ -0,0 +1,111 @@
+#include <iostream>
+#include <cstring>
+#include <string>
+#include <opencv2/core.hpp>
+#include "tg/core/fwd.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/roi_demand.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/core/testcase/blur_step.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+using namespace tg::core::testcase;
+
+namespace //(unnamed)
+{
+
+std::string rect_to_string(const RoiRect& rect)
+{
+    if (rect.is_full())
+    {
+        return "(full)";
+    }
+    return "(" + std::to_string(rect.m_x) + ", " + std::to_string(rect.m_y) + ", " +
+        std::to_string(rect.m_width) + ", " + std::to_string(rect.m_height) + ")";
+}
+
+bool same_pixels(const cv::Mat& lhs, const cv::Mat& rhs)
+{
+    if (lhs.size() != rhs.size() || lhs.type() != rhs.type())
+    {
+        return false;
+    }
+    const size_t row_bytes = lhs.cols * lhs.elemSize();
+    for (int row = 0; row < lhs.rows; ++row)
+    {
+        if (std::memcmp(lhs.ptr<uchar>(row), rhs.ptr<uchar>(row), row_bytes) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void roi_demand_testcase_1(OStrm cout)
+{
+    cout << "running roi_demand_testcase_1..." << std::endl;
+    Scope scope("RoiScope");
+    auto blur_a = std::make_shared<BlurStep>(2.0, 2.0);
+    auto blur_b = std::make_shared<BlurStep>(3.0, 3.0);
+    blur_a->info().set_shortname("blur_a");
+    blur_a->info().rename_data("input", "image");
+    blur_a->info().rename_data("output", "smooth");
+    blur_b->info().set_shortname("blur_b");
+    blur_b->info().rename_data("input", "smooth");
+    blur_b->info().rename_data("output", "smoother");
+    scope.add(blur_b);
+    scope.add(blur_a);
+    scope.freeze();
+    Plan plan(scope);
+    const RoiRect request{200, 100, 16, 8};
+    RoiDemand demand(plan);
+    demand.request("smoother", request);
+    demand.propagate();
+    for (size_t slot_index = 0u; slot_index < plan.slot_count(); ++slot_index)
+    {
+        cout << "Slot " << plan.slot_at(slot_index).m_name
+            << " demand " << rect_to_string(demand.slot_demand(slot_index))
+            << " coverage " << rect_to_string(demand.slot_coverage(slot_index)) << std::endl;
+    }
+    cv::Mat image(480, 640, CV_8UC1);
+    for (int row = 0; row < image.rows; ++row)
+    {
+        for (int col = 0; col < image.cols; ++col)
+        {
+            image.at<uchar>(row, col) = static_cast<uchar>((row * 7 + col * 13) & 0xFF);
+        }
+    }
+    Executor executor;
+    const size_t image_slot = plan.find_slot("image").value();
+    const size_t smoother_slot = plan.find_slot("smoother").value();
+    std::vector<VarData> full_slots(plan.slot_count());
+    full_slots.at(image_slot).emplace<cv::Mat>(image);
+    executor.run(plan, full_slots);
+    std::vector<VarData> roi_slots(plan.slot_count());
+    roi_slots.at(image_slot).emplace<cv::Mat>(image);
+    executor.run(plan, roi_slots, demand);
+    const cv::Mat& full_result = full_slots.at(smoother_slot).as<cv::Mat>();
+    const cv::Mat& roi_result = roi_slots.at(smoother_slot).as<cv::Mat>();
+    const RoiRect& coverage = demand.slot_coverage(smoother_slot);
+    cv::Rect local{request.m_x - coverage.m_x, request.m_y - coverage.m_y, request.m_width, request.m_height};
+    if (!same_pixels(full_result(cv::Rect{request.m_x, request.m_y, request.m_width, request.m_height}), roi_result(local)))
+    {
+        throw std::runtime_error("roi_demand_testcase_1: ROI result differs from the whole-image result.");
+    }
+    cout << "roi_demand_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void roi_demand_testcase()
+{
+    OStrm cout;
+    roi_demand_testcase_1(cout);
+}
@@ -0,0 +1,427 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "tg/core/fwd.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/core/resource_manager.hpp"
+#include "tg/core/run_control.hpp"
+#include "tg/core/runtime.hpp"
+#include "tg/core/thread_pool.hpp"
+#include "tg/core/details/timing_wheel.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+
+namespace //(unnamed)
+{
+
+using Clock = std::chrono::steady_clock;
+
+class SlowIncStep : public Step
+{
+public:
+    SlowIncStep(std::string_view input, std::string_view output)
+        : Step{}
+    {
+        this->info().set_shortname(output);
+        this->info().add_data<int>(input, DataUsage::Read);
+        this->info().add_data<int>(output, DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        data.at(1).emplace<int>(data.at(0).as<int>() + 1);
+        this->post_execute_validation(data);
+    }
+};
+
+/**
+ * @brief Spins until the RunControl of its run is stopped, then abandons
+ * its work.
+ */
+class PollingStep : public Step
+{
+public:
+    PollingStep()
+        : Step{}
+    {
+        this->info().set_shortname("polling");
+        this->info().add_data<int>("v0", DataUsage::Read);
+        this->info().add_data<int>("polled", DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        const RunControl* p_control = RunControl::current();
+        if (!p_control)
+        {
+            throw std::runtime_error("PollingStep: no current RunControl.");
+        }
+        while (!p_control->is_stopped())
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        p_control->throw_if_stopped();
+        data.at(1).emplace<int>(1);
+        this->post_execute_validation(data);
+    }
+};
+
+/**
+ * @brief Runs an inner Plan with no RunControl of its own.
+ */
+class NestedRunStep : public Step
+{
+public:
+    NestedRunStep(PlanPtr inner_plan, const Executor& inner_executor)
+        : Step{}
+        , m_sp_inner_plan{std::move(inner_plan)}
+        , m_inner_executor{inner_executor}
+    {
+        this->info().set_shortname("nested");
+        this->info().add_data<int>("v0", DataUsage::Read);
+        this->info().add_data<int>("nested", DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        std::vector<VarData> inner_slots(m_sp_inner_plan->slot_count());
+        inner_slots.at(m_sp_inner_plan->find_slot("v0").value()) = data.at(0);
+        m_inner_executor.run(*m_sp_inner_plan, inner_slots);
+        data.at(1).emplace<int>(1);
+        this->post_execute_validation(data);
+    }
+private:
+    PlanPtr m_sp_inner_plan;
+    const Executor& m_inner_executor;
+};
+
+/**
+ * @brief Holds one "gate" token while it executes; fails if asked to.
+ */
+class GatedStep : public Step
+{
+public:
+    explicit GatedStep(bool is_failing)
+        : Step{}
+        , m_is_failing{is_failing}
+    {
+        this->info().set_shortname("gated");
+        this->info().add_data<int>("v0", DataUsage::Read);
+        this->info().add_data<int>("gated", DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        if (m_is_failing)
+        {
+            throw std::runtime_error("GatedStep: failing as asked.");
+        }
+        data.at(1).emplace<int>(data.at(0).as<int>());
+        this->post_execute_validation(data);
+    }
+    ResourceDemand resource_demand(const std::vector<VarData>& /*data*/) const override {
+        return ResourceDemand{0u, {{"gate", 1u}}};
+    }
+private:
+    bool m_is_failing;
+};
+
+PlanPtr make_gated_plan(bool is_failing)
+{
+    Scope scope("gated_scope");
+    scope.add(std::make_shared<GatedStep>(is_failing));
+    scope.freeze();
+    return std::make_shared<Plan>(scope);
+}
+
+PlanPtr make_chain_plan(int length)
+{
+    Scope scope("slow_chain");
+    for (int k = 0; k < length; ++k)
+    {
+        scope.add(std::make_shared<SlowIncStep>("v" + std::to_string(k), "v" + std::to_string(k + 1)));
+    }
+    scope.freeze();
+    return std::make_shared<Plan>(scope);
+}
+
+bool is_all_empty(const std::vector<VarData>& slots)
+{
+    for (const auto& slot : slots)
+    {
+        if (slot.has_value())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Runs the Plan, expecting RunCancelled; returns the elapsed time.
+ */
+Clock::duration run_expect_cancelled(const Executor& executor, const Plan& plan, const RunControlPtr& control, std::vector<VarData>& slots)
+{
+    const auto start = Clock::now();
+    try
+    {
+        executor.run(plan, slots, control);
+    }
+    catch (const RunCancelled&)
+    {
+        return Clock::now() - start;
+    }
+    throw std::runtime_error("run_control_testcase: run was not cancelled.");
+}
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void run_control_testcase_1(OStrm cout)
+{
+    cout << "running run_control_testcase_1..." << std::endl;
+    const int length = 100;
+    PlanPtr plan = make_chain_plan(length);
+    Executor sequential;
+    Executor parallel(std::make_shared<ThreadPool>(2u));
+    for (const Executor* p_executor : {&sequential, &parallel})
+    {
+        // Without a deadline, the chain completes and the control is finished.
+        {
+            auto control = std::make_shared<RunControl>();
+            std::vector<VarData> slots(plan->slot_count());
+            slots.at(plan->find_slot("v0").value()).emplace<int>(0);
+            p_executor->run(*plan, slots, control);
+            if (slots.at(plan->find_slot("v" + std::to_string(length)).value()).as<int>() != length ||
+                control->status() != RunStatus::Finished)
+            {
+                throw std::runtime_error("run_control_testcase_1: unexpected result.");
+            }
+        }
+        // With a deadline of 20 ms, the 200 ms chain stops early.
+        auto control = RunControl::with_timeout(std::chrono::milliseconds(20));
+        std::vector<VarData> slots(plan->slot_count());
+        slots.at(plan->find_slot("v0").value()).emplace<int>(0);
+        const auto elapsed = run_expect_cancelled(*p_executor, *plan, control, slots);
+        const auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+        cout << (p_executor->pool() ? "Parallel" : "Sequential") << " run stopped after " << elapsed_ms << " ms" << std::endl;
+        if (control->status() != RunStatus::DeadlineExceeded || !is_all_empty(slots) || elapsed_ms >= 2 * length)
+        {
+            throw std::runtime_error("run_control_testcase_1: deadline not enforced.");
+        }
+    }
+    cout << "run_control_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void run_control_testcase_2(OStrm cout)
+{
+    cout << "running run_control_testcase_2..." << std::endl;
+    PlanPtr plan = make_chain_plan(100);
+    Executor executor(std::make_shared<ThreadPool>(2u));
+    auto control = std::make_shared<RunControl>();
+    std::thread canceller([control]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        control->cancel();
+    });
+    std::vector<VarData> slots(plan->slot_count());
+    slots.at(plan->find_slot("v0").value()).emplace<int>(0);
+    run_expect_cancelled(executor, *plan, control, slots);
+    canceller.join();
+    // Cancelling again, or expiring, has no further effect.
+    control->cancel();
+    control->expire();
+    if (control->status() != RunStatus::Cancelled || !is_all_empty(slots))
+    {
+        throw std::runtime_error("run_control_testcase_2: unexpected status.");
+    }
+    // A control stopped before the run starts no Step at all.
+    auto stopped = std::make_shared<RunControl>();
+    stopped->cancel();
+    slots.at(plan->find_slot("v0").value()).emplace<int>(0);
+    run_expect_cancelled(executor, *plan, stopped, slots);
+    cout << "run_control_testcase_2 success." << std::endl;
+}
+
+INLINE_NEVER
+void run_control_testcase_3(OStrm cout)
+{
+    cout << "running run_control_testcase_3..." << std::endl;
+    // A Step polls the control of its run, and a nested run inherits it.
+    PlanPtr inner_plan;
+    {
+        Scope scope("polling_scope");
+        scope.add(std::make_shared<PollingStep>());
+        scope.freeze();
+        inner_plan = std::make_shared<Plan>(scope);
+    }
+    Executor executor(std::make_shared<ThreadPool>(2u));
+    Executor inner_executor(std::make_shared<ThreadPool>(1u));
+    PlanPtr outer_plan;
+    {
+        Scope scope("nesting_scope");
+        scope.add(std::make_shared<NestedRunStep>(inner_plan, inner_executor));
+        scope.freeze();
+        outer_plan = std::make_shared<Plan>(scope);
+    }
+    auto control = RunControl::with_timeout(std::chrono::milliseconds(5));
+    std::vector<VarData> slots(outer_plan->slot_count());
+    slots.at(outer_plan->find_slot("v0").value()).emplace<int>(0);
+    run_expect_cancelled(executor, *outer_plan, control, slots);
+    Runtime runtime(inner_plan, std::make_shared<ThreadPool>(2u));
+    // Through the Runtime, the future delivers RunCancelled.
+    Runtime::NamedData inputs;
+    inputs["v0"].emplace<int>(0);
+    auto future = runtime.submit(std::move(inputs), RunControl::with_timeout(std::chrono::milliseconds(5)));
+    bool is_cancelled = false;
+    try
+    {
+        future.get();
+    }
+    catch (const RunCancelled& ex)
+    {
+        cout << "Request stopped: " << ex.what() << std::endl;
+        is_cancelled = true;
+    }
+    if (!is_cancelled)
+    {
+        throw std::runtime_error("run_control_testcase_3: request was not cancelled.");
+    }
+    cout << "run_control_testcase_3 success." << std::endl;
+}
+
+INLINE_NEVER
+void run_control_testcase_4(OStrm cout)
+{
+    cout << "running run_control_testcase_4..." << std::endl;
+    // Deadlines spanning several turns of the wheel expire in time, not early.
+    details::TimingWheel wheel;
+    const auto start = Clock::now();
+    std::vector<RunControlPtr> controls;
+    for (int k = 0; k < 64; ++k)
+    {
+        controls.push_back(RunControl::with_timeout(std::chrono::milliseconds((k * 37) % 700)));
+        wheel.schedule(controls.back());
+    }
+    auto unrelated = std::make_shared<RunControl>();
+    wheel.schedule(unrelated);
+    while (wheel.entry_count() > 0u)
+    {
+        for (const auto& control : controls)
+        {
+            if (control->is_stopped() && Clock::now() < control->deadline().value())
+            {
+                throw std::runtime_error("run_control_testcase_4: expired before the deadline.");
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+    cout << "All deadlines expired after " << elapsed_ms << " ms" << std::endl;
+    for (const auto& control : controls)
+    {
+        if (control->status() != RunStatus::DeadlineExceeded)
+        {
+            throw std::runtime_error("run_control_testcase_4: deadline missed.");
+        }
+    }
+    if (unrelated->is_stopped())
+    {
+        throw std::runtime_error("run_control_testcase_4: control without deadline expired.");
+    }
+    cout << "run_control_testcase_4 success." << std::endl;
+}
+
+INLINE_NEVER
+void run_control_testcase_5(OStrm cout)
+{
+    cout << "running run_control_testcase_5..." << std::endl;
+    // The only "gate" token is held elsewhere, so the Step of each run
+    // waits for it in the ResourceManager.
+    auto resources = std::make_shared<ResourceManager>();
+    resources->set_token_count("gate", 1u);
+    const ResourceDemand gate{0u, {{"gate", 1u}}};
+    if (!resources->try_acquire(gate))
+    {
+        throw std::runtime_error("run_control_testcase_5: gate not acquired.");
+    }
+    PlanPtr plan = make_gated_plan(false);
+    Executor executor(std::make_shared<ThreadPool>(2u));
+    executor.set_resource_manager(resources);
+    // Cancelling withdraws the queued Step, and the caller returns at once.
+    auto control = std::make_shared<RunControl>();
+    std::thread canceller([control, resources]() {
+        while (resources->waiting_count() == 0u)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        control->cancel();
+    });
+    std::vector<VarData> slots(plan->slot_count());
+    slots.at(plan->find_slot("v0").value()).emplace<int>(7);
+    run_expect_cancelled(executor, *plan, control, slots);
+    canceller.join();
+    if (!is_all_empty(slots) || resources->waiting_count() != 0u || resources->tokens_in_use("gate") != 1u)
+    {
+        throw std::runtime_error("run_control_testcase_5: cancelled run not released.");
+    }
+    // A request past its deadline completes its future while the gate is still held.
+    Runtime runtime(plan, std::make_shared<ThreadPool>(2u));
+    runtime.executor().set_resource_manager(resources);
+    Runtime::NamedData inputs;
+    inputs["v0"].emplace<int>(7);
+    auto future = runtime.submit(std::move(inputs), RunControl::with_timeout(std::chrono::milliseconds(5)));
+    if (future.wait_for(std::chrono::seconds(5)) != std::future_status::ready)
+    {
+        throw std::runtime_error("run_control_testcase_5: expired request not completed.");
+    }
+    bool is_cancelled = false;
+    try
+    {
+        future.get();
+    }
+    catch (const RunCancelled&)
+    {
+        is_cancelled = true;
+    }
+    resources->release(gate);
+    if (!is_cancelled || runtime.in_flight() != 0u)
+    {
+        throw std::runtime_error("run_control_testcase_5: request was not cancelled.");
+    }
+    // A run that fails finishes its control all the same.
+    PlanPtr failing_plan = make_gated_plan(true);
+    for (const Executor* p_executor : {&executor, &runtime.executor()})
+    {
+        auto failing_control = std::make_shared<RunControl>();
+        std::vector<VarData> failing_slots(failing_plan->slot_count());
+        failing_slots.at(failing_plan->find_slot("v0").value()).emplace<int>(7);
+        try
+        {
+            p_executor->run(*failing_plan, failing_slots, failing_control);
+        }
+        catch (const std::runtime_error&)
+        {
+        }
+        if (failing_control->status() != RunStatus::Finished)
+        {
+            throw std::runtime_error("run_control_testcase_5: failed run not finished.");
+        }
+    }
+    cout << "run_control_testcase_5 success." << std::endl;
+}
+
+INLINE_NEVER
+void run_control_testcase()
+{
+    OStrm cout;
+    run_control_testcase_1(cout);
+    run_control_testcase_2(cout);
+    run_control_testcase_3(cout);
+    run_control_testcase_4(cout);
+    run_control_testcase_5(cout);
+}
@@ -0,0 +1,182 @@
+#include <future>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "tg/core/fwd.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/runtime.hpp"
+#include "tg/core/memory_budget.hpp"
+#include "tg/core/thread_pool.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+
+namespace //(unnamed)
+{
+
+class MulAddStep : public Step
+{
+public:
+    MulAddStep(std::string_view shortname, std::string_view lhs, std::string_view rhs, std::string_view output, int addend)
+        : Step{}
+        , m_addend{addend}
+    {
+        this->info().set_shortname(shortname);
+        this->info().add_data<int>(lhs, DataUsage::Read);
+        this->info().add_data<int>(rhs, DataUsage::Read);
+        this->info().add_data<int>(output, DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        data.at(2).emplace<int>(data.at(0).as<int>() * data.at(1).as<int>() + m_addend);
+        this->post_execute_validation(data);
+    }
+private:
+    int m_addend;
+};
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void runtime_testcase_1(OStrm cout)
+{
+    cout << "running runtime_testcase_1..." << std::endl;
+    Scope scope("serving_scope");
+    scope.add(std::make_shared<MulAddStep>("product", "a", "b", "ab", 0));
+    scope.add(std::make_shared<MulAddStep>("scaled", "ab", "b", "abb", 1));
+    scope.add(std::make_shared<MulAddStep>("mixed", "a", "ab", "a2b", 2));
+    scope.freeze();
+    Runtime runtime(scope, std::make_shared<ThreadPool>(4u));
+    // Several client threads, each with requests in flight.
+    const int client_count = 4;
+    const int request_count = 500;
+    std::atomic<int> wrong_count{0};
+    auto client = [&](int client_index) {
+        std::vector<std::pair<int, std::future<Runtime::NamedData>>> pending;
+        for (int k = 0; k < request_count; ++k)
+        {
+            const int a = client_index * 1000 + k;
+            Runtime::NamedData inputs;
+            inputs["a"].emplace<int>(a % 100);
+            inputs["b"].emplace<int>(3);
+            pending.emplace_back(a % 100, runtime.submit(std::move(inputs)));
+        }
+        for (auto& [a, future] : pending)
+        {
+            Runtime::NamedData outputs = future.get();
+            const int ab = a * 3;
+            if (outputs.at("abb").as<int>() != ab * 3 + 1 || outputs.at("a2b").as<int>() != a * ab + 2)
+            {
+                ++wrong_count;
+            }
+        }
+    };
+    std::vector<std::thread> clients;
+    for (int k = 0; k < client_count; ++k)
+    {
+        clients.emplace_back(client, k);
+    }
+    for (auto& thread : clients)
+    {
+        thread.join();
+    }
+    cout << "Requests: " << client_count * request_count << ", wrong: " << wrong_count.load()
+        << ", arenas: " << runtime.arena_count() << ", peak in flight: " << runtime.peak_in_flight() << std::endl;
+    if (wrong_count.load() != 0 || runtime.in_flight() != 0u || runtime.arena_count() > runtime.peak_in_flight())
+    {
+        throw std::runtime_error("runtime_testcase_1: unexpected result.");
+    }
+    cout << "runtime_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void runtime_testcase_2(OStrm cout)
+{
+    cout << "running runtime_testcase_2..." << std::endl;
+    Scope scope("serving_scope");
+    scope.add(std::make_shared<MulAddStep>("product", "a", "b", "ab", 0));
+    scope.freeze();
+    Runtime runtime(scope, nullptr);
+    // Sequential requests reuse a single arena.
+    for (int k = 0; k < 10; ++k)
+    {
+        Runtime::NamedData inputs;
+        inputs["a"].emplace<int>(k);
+        inputs["b"].emplace<int>(k);
+        if (runtime.submit(std::move(inputs)).get().at("ab").as<int>() != k * k)
+        {
+            throw std::runtime_error("runtime_testcase_2: unexpected result.");
+        }
+    }
+    // A missing input fails through the future; an unknown one at once.
+    bool missing_reported = false;
+    Runtime::NamedData partial;
+    partial["a"].emplace<int>(1);
+    auto future = runtime.submit(std::move(partial));
+    try
+    {
+        future.get();
+    }
+    catch (const std::invalid_argument& e)
+    {
+        cout << "Reported: " << e.what() << std::endl;
+        missing_reported = true;
+    }
+    bool unknown_rejected = false;
+    try
+    {
+        Runtime::NamedData unknown;
+        unknown["ab"].emplace<int>(1);
+        runtime.submit(std::move(unknown));
+    }
+    catch (const std::invalid_argument& e)
+    {
+        cout << "Rejected: " << e.what() << std::endl;
+        unknown_rejected = true;
+    }
+    // A request whose peak cannot be predicted is rejected, and gives its arena back.
+    runtime.executor().set_memory_budget(std::make_shared<MemoryBudget>(1024u), [](const Plan& plan, const std::vector<VarData>& slots) {
+        if (slots.at(plan.find_slot("a").value()).as<int>() < 0)
+        {
+            throw std::invalid_argument("malformed input");
+        }
+        return size_t{64u};
+    });
+    bool unpredictable_rejected = false;
+    try
+    {
+        Runtime::NamedData malformed;
+        malformed["a"].emplace<int>(-1);
+        malformed["b"].emplace<int>(1);
+        runtime.submit(std::move(malformed));
+    }
+    catch (const std::invalid_argument& e)
+    {
+        cout << "Rejected: " << e.what() << std::endl;
+        unpredictable_rejected = true;
+    }
+    const size_t in_flight_after = runtime.in_flight();
+    Runtime::NamedData valid;
+    valid["a"].emplace<int>(2);
+    valid["b"].emplace<int>(3);
+    const bool is_served = runtime.submit(std::move(valid)).get().at("ab").as<int>() == 6;
+    cout << "Arenas: " << runtime.arena_count() << std::endl;
+    if (!missing_reported || !unknown_rejected || !unpredictable_rejected || in_flight_after != 0u ||
+        !is_served || runtime.arena_count() != 1u)
+    {
+        throw std::runtime_error("runtime_testcase_2: unexpected error handling.");
+    }
+    cout << "runtime_testcase_2 success." << std::endl;
+}
+
+INLINE_NEVER
+void runtime_testcase()
+{
+    OStrm cout;
+    runtime_testcase_1(cout);
+    runtime_testcase_2(cout);
+}
@@ -0,0 +1,158 @@
+#include <functional>
+#include <iostream>
+#include <string>
+#include "tg/core/fwd.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/scope_step.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/core/thread_pool.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+
+namespace //(unnamed)
+{
+
+class AffineStep : public Step
+{
+public:
+    AffineStep(std::string_view shortname, std::string_view input, std::string_view output, int scale, int offset)
+        : Step{}
+        , m_scale{scale}
+        , m_offset{offset}
+    {
+        this->info().set_shortname(shortname);
+        this->info().add_data<int>(input, DataUsage::Read);
+        this->info().add_data<int>(output, DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        data.at(1).emplace<int>(data.at(0).as<int>() * m_scale + m_offset);
+        this->post_execute_validation(data);
+    }
+private:
+    int m_scale;
+    int m_offset;
+};
+
+/**
+ * @brief Fills a nested Scope computing y = 3x + 1 in two Steps; each
+ * ScopeStep needs a Scope of its own.
+ */
+void build_affine_scope(Scope& inner)
+{
+    inner.add(std::make_shared<AffineStep>("scale", "x", "scaled", 3, 0));
+    inner.add(std::make_shared<AffineStep>("offset", "scaled", "y", 1, 1));
+    inner.freeze();
+}
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void scope_step_testcase_1(OStrm cout)
+{
+    cout << "running scope_step_testcase_1..." << std::endl;
+    Scope first_inner("affine_scope");
+    build_affine_scope(first_inner);
+    Scope second_inner("affine_scope");
+    build_affine_scope(second_inner);
+    auto first = std::make_shared<ScopeStep>("first", first_inner, ScopeStepMode::Inline);
+    first->bind_input("a", "x");
+    first->bind_output("y", "b");
+    auto second = std::make_shared<ScopeStep>("second", second_inner, ScopeStepMode::Macro);
+    second->bind_input("b", "x");
+    second->bind_output("y", "c");
+    // A Scope whose Steps are already nested cannot be nested again.
+    bool reuse_rejected = false;
+    try
+    {
+        ScopeStep reuse("reuse", first_inner, ScopeStepMode::Macro);
+    }
+    catch (const std::invalid_argument& e)
+    {
+        cout << "Rejected: " << e.what() << std::endl;
+        reuse_rejected = true;
+    }
+    if (!reuse_rejected)
+    {
+        throw std::runtime_error("scope_step_testcase_1: nested Scope reused.");
+    }
+    Scope scope("outer_scope");
+    scope.add(first);
+    scope.add(second);
+    scope.freeze();
+    Plan plan(scope);
+    cout << "Step count: " << plan.step_count() << ", slot count: " << plan.slot_count() << std::endl;
+    if (plan.step_count() != 3u || !plan.find_slot("first/scaled").has_value() ||
+        plan.find_slot("second/scaled").has_value())
+    {
+        throw std::runtime_error("scope_step_testcase_1: unexpected plan.");
+    }
+    for (ThreadPoolPtr pool : {ThreadPoolPtr{}, std::make_shared<ThreadPool>(2u)})
+    {
+        Executor executor(pool);
+        std::vector<VarData> slots(plan.slot_count());
+        slots.at(plan.find_slot("a").value()).emplace<int>(5);
+        executor.run(plan, slots);
+        const int c = slots.at(plan.find_slot("c").value()).as<int>();
+        cout << "c = " << c << std::endl;
+        if (c != 3 * (3 * 5 + 1) + 1)
+        {
+            throw std::runtime_error("scope_step_testcase_1: unexpected result.");
+        }
+    }
+    cout << "scope_step_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void scope_step_testcase_2(OStrm cout)
+{
+    cout << "running scope_step_testcase_2..." << std::endl;
+    // Breadboard style: components share no data names; wires connect them.
+    Scope first_inner("affine_scope");
+    build_affine_scope(first_inner);
+    Scope second_inner("affine_scope");
+    build_affine_scope(second_inner);
+    Scope scope("breadboard_scope");
+    scope.add(std::make_shared<ScopeStep>("first", first_inner, ScopeStepMode::Inline));
+    scope.add(std::make_shared<ScopeStep>("second", second_inner, ScopeStepMode::Inline));
+    scope.add(std::make_shared<AffineStep>("negate", "p", "q", -1, 0));
+    scope.wire("a", "first/x");
+    scope.wire("first/y", "second/x");
+    scope.wire("second/y", "p");
+    scope.wire("q", "result");
+    scope.wire("unused", "receptacle");
+    scope.freeze();
+    Plan plan(scope);
+    cout << "Step count: " << plan.step_count() << ", slot count: " << plan.slot_count() << std::endl;
+    const auto a_slot = plan.find_slot("a");
+    if (plan.step_count() != 5u || plan.slot_count() != 6u || !a_slot.has_value() ||
+        plan.find_slot("first/x") != a_slot || plan.slot_at(a_slot.value()).m_name != "a" ||
+        plan.find_slot("second/y") != plan.find_slot("p") || plan.find_slot("unused").has_value())
+    {
+        throw std::runtime_error("scope_step_testcase_2: unexpected plan.");
+    }
+    Executor executor;
+    std::vector<VarData> slots(plan.slot_count());
+    slots.at(a_slot.value()).emplace<int>(5);
+    executor.run(plan, slots);
+    const int result = slots.at(plan.find_slot("result").value()).as<int>();
+    cout << "result = " << result << std::endl;
+    if (result != -(3 * (3 * 5 + 1) + 1))
+    {
+        throw std::runtime_error("scope_step_testcase_2: unexpected result.");
+    }
+    cout << "scope_step_testcase_2 success." << std::endl;
+}
+
+INLINE_NEVER
+void scope_step_testcase()
+{
+    OStrm cout;
+    scope_step_testcase_1(cout);
+    scope_step_testcase_2(cout);
+}
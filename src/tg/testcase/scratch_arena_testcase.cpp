@@ -0,0 +1,107 @@
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "tg/core/fwd.hpp"
+#include "tg/core/scratch_arena.hpp"
+#include "tg/core/thread_pool.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+
+INLINE_NEVER
+void scratch_arena_testcase_1(OStrm cout)
+{
+    cout << "running scratch_arena_testcase_1..." << std::endl;
+    ScratchArena arena;
+    size_t grow_after_first = 0u;
+    bool is_ok = true;
+    for (int round = 0; round < 3; ++round)
+    {
+        const ScratchArena::Lease outer = arena.acquire(1000u);
+        {
+            // Does not fit the first block; the arena grows.
+            const ScratchArena::Lease inner = arena.acquire(100000u);
+            const ScratchArena::Lease aligned = arena.acquire(10u, 64u);
+            std::memset(outer.data(), 1, outer.size());
+            std::memset(inner.data(), 2, inner.size());
+            std::memset(aligned.data(), 3, aligned.size());
+            is_ok = is_ok &&
+                outer.as<unsigned char>()[999] == 1 &&
+                inner.as<unsigned char>()[0] == 2 &&
+                (reinterpret_cast<std::uintptr_t>(aligned.data()) % 64u) == 0u;
+        }
+        if (round == 0)
+        {
+            grow_after_first = arena.grow_count();
+        }
+    }
+    cout << "Capacity: " << arena.capacity() << ", blocks added: " << arena.grow_count()
+        << ", in use: " << arena.in_use() << std::endl;
+    // Once merged, the same requests fit without growing.
+    is_ok = is_ok && grow_after_first >= 2u && arena.grow_count() == grow_after_first &&
+        arena.in_use() == 0u && arena.capacity() >= 101000u;
+    bool is_thrown = false;
+    try
+    {
+        arena.acquire(8u, 3u);
+    }
+    catch (const std::invalid_argument&)
+    {
+        is_thrown = true;
+    }
+    if (!is_ok || !is_thrown)
+    {
+        throw std::runtime_error("scratch_arena_testcase_1: unexpected arena state.");
+    }
+    cout << "scratch_arena_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void scratch_arena_testcase_2(OStrm cout)
+{
+    cout << "running scratch_arena_testcase_2..." << std::endl;
+    ThreadPool pool(4u);
+    std::atomic<int> errors{0};
+    size_t first_capacity = 0u;
+    for (int round = 0; round < 10; ++round)
+    {
+        pool.parallel_for(64u, [&](size_t index) {
+            ScratchArena& arena = ScratchArena::local();
+            ScratchArena* p_worker_arena = ThreadPool::current_scratch();
+            if (p_worker_arena && p_worker_arena != &arena)
+            {
+                ++errors;
+            }
+            const ScratchArena::Lease lease = arena.acquire(32768u * sizeof(size_t));
+            size_t* p_values = lease.as<size_t>();
+            for (size_t k = 0u; k < 32768u; ++k)
+            {
+                p_values[k] = index + k;
+            }
+            for (size_t k = 0u; k < 32768u; ++k)
+            {
+                errors += (p_values[k] != index + k) ? 1 : 0;
+            }
+        });
+        if (round == 0)
+        {
+            first_capacity = pool.scratch_capacity();
+        }
+    }
+    cout << "Worker scratch capacity: " << pool.scratch_capacity() << ", errors: " << errors.load() << std::endl;
+    // Later rounds reuse the arenas grown by the first one.
+    if (errors.load() != 0 || pool.scratch_capacity() > first_capacity + 4u * ScratchArena::initial_capacity * 8u)
+    {
+        throw std::runtime_error("scratch_arena_testcase_2: unexpected result.");
+    }
+    cout << "scratch_arena_testcase_2 success." << std::endl;
+}
+
+INLINE_NEVER
+void scratch_arena_testcase()
+{
+    OStrm cout;
+    scratch_arena_testcase_1(cout);
+    scratch_arena_testcase_2(cout);
+}
@@ -0,0 +1,97 @@
+#include <iostream>
+#include <string>
+#include <opencv2/core.hpp>
+#include "tg/core/fwd.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/executor.hpp"
+#include "tg/core/shape_inference.hpp"
+#include "tg/core/thread_pool.hpp"
+#include "tg/core/testcase/blur_conncomp_plan.hpp"
+#include "tg/opencv/data_meta.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+using namespace tg::core::testcase;
+
+INLINE_NEVER
+void shape_inference_testcase_1(OStrm cout)
+{
+    cout << "running shape_inference_testcase_1..." << std::endl;
+    PlanPtr plan = make_blur_conncomp_plan();
+    ShapeInference inference(*plan);
+    inference.set_input("input", DataMeta{480, 640, CV_8UC1, 1u});
+    inference.propagate();
+    const auto& smooth = inference.slot_meta(plan->find_slot("smooth").value());
+    const auto& labels = inference.slot_meta(plan->find_slot("labels").value());
+    const auto& stats = inference.slot_meta(plan->find_slot("stats").value());
+    const auto& centroids = inference.slot_meta(plan->find_slot("centroids").value());
+    cout << "Known bytes: " << inference.known_bytes() << std::endl;
+    const bool is_ok =
+        smooth == std::optional<DataMeta>(DataMeta{480, 640, CV_8UC1, 1u}) &&
+        labels == std::optional<DataMeta>(DataMeta{480, 640, CV_32S, 4u}) &&
+        stats.has_value() && !stats->is_exact() && stats->m_cols == 5 && stats->m_type == CV_32S &&
+        centroids.has_value() && !centroids->is_exact() && centroids->m_type == CV_64F &&
+        !inference.is_complete() &&
+        inference.known_bytes() == 2u * 307200u + 1228800u;
+    if (!is_ok)
+    {
+        throw std::runtime_error("shape_inference_testcase_1: unexpected metadata.");
+    }
+    cout << "shape_inference_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void shape_inference_testcase_2(OStrm cout)
+{
+    cout << "running shape_inference_testcase_2..." << std::endl;
+    tg::opencv::register_data_meta();
+    PlanPtr plan = make_blur_conncomp_plan();
+    cv::Mat image = cv::Mat::zeros(120, 160, CV_8UC1);
+    for (int row = 20; row < 60; ++row)
+    {
+        for (int col = 30; col < 90; ++col)
+        {
+            image.at<uchar>(row, col) = 255;
+        }
+    }
+    Executor executor(std::make_shared<ThreadPool>(2u));
+    std::vector<VarData> slots(plan->slot_count());
+    slots.at(plan->find_slot("input").value()).emplace<cv::Mat>(image);
+    ShapeInference inference(*plan);
+    inference.set_inputs(slots);
+    inference.propagate();
+    const size_t predicted = executor.predict_peak(*plan, slots);
+    executor.run(*plan, slots);
+    // Exact predictions must match the executed outputs.
+    for (size_t slot_index = 0u; slot_index < plan->slot_count(); ++slot_index)
+    {
+        const auto& meta = inference.slot_meta(slot_index);
+        const DataMeta actual = tg::opencv::to_data_meta(slots.at(slot_index).as<cv::Mat>());
+        const bool is_match = meta.has_value() && (meta->is_exact()
+            ? meta.value() == actual
+            : (meta->m_cols == actual.m_cols && meta->m_type == actual.m_type));
+        if (!is_match)
+        {
+            throw std::runtime_error(
+                "shape_inference_testcase_2: mismatch on " + plan->slot_at(slot_index).m_name + "."
+            );
+        }
+    }
+    cout << "Predicted peak: " << predicted << std::endl;
+    // Input and blurred image, labels, and stats and centroids (inexact,
+    // each counted as large as the input).
+    if (predicted != 2u * 19200u + 4u * 19200u + 2u * 19200u)
+    {
+        throw std::runtime_error("shape_inference_testcase_2: unexpected prediction.");
+    }
+    cout << "shape_inference_testcase_2 success." << std::endl;
+}
+
+INLINE_NEVER
+void shape_inference_testcase()
+{
+    OStrm cout;
+    shape_inference_testcase_1(cout);
+    shape_inference_testcase_2(cout);
+}
@@ -0,0 +1,143 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include "tg/core/fwd.hpp"
+#include "tg/core/step.hpp"
+#include "tg/core/step_info.hpp"
+#include "tg/core/scope.hpp"
+#include "tg/core/plan.hpp"
+#include "tg/core/stream_pipeline.hpp"
+#include "tg/core/thread_pool.hpp"
+#include "tg/common/project_macros.hpp"
+#include "tg/testcase/ostrm.hpp"
+
+using namespace tg::core;
+
+namespace //(unnamed)
+{
+
+/**
+ * @brief Adds its version number to the input; both Steps of the pipeline
+ * are replaced together, so each frame must come out as x + 2 * version.
+ */
+class AddVersionStep : public Step
+{
+public:
+    AddVersionStep(std::string_view shortname, std::string_view input, std::string_view output, int version)
+        : Step{}
+        , m_version{version}
+    {
+        this->info().set_shortname(shortname);
+        this->info().add_data<int>(input, DataUsage::Read);
+        this->info().add_data<int>(output, DataUsage::Write);
+    }
+    void execute(std::vector<VarData>& data) override {
+        this->pre_execute_validation(data);
+        std::this_thread::yield();
+        data.at(1).emplace<int>(data.at(0).as<int>() + m_version);
+        this->post_execute_validation(data);
+    }
+private:
+    int m_version;
+};
+
+} // namespace(unnamed)
+
+INLINE_NEVER
+void stream_pipeline_testcase_1(OStrm cout)
+{
+    cout << "running stream_pipeline_testcase_1..." << std::endl;
+    Scope scope("stream_scope");
+    scope.add(std::make_shared<AddVersionStep>("first", "frame", "middle", 0));
+    scope.add(std::make_shared<AddVersionStep>("second", "middle", "result", 0));
+    scope.freeze();
+    StreamPipeline pipeline(std::make_shared<Plan>(scope), std::make_shared<ThreadPool>(2u));
+    const size_t first = pipeline.find_step("first").value();
+    const size_t second = pipeline.find_step("second").value();
+    const size_t frame_slot = pipeline.plan().find_slot("frame").value();
+    const size_t result_slot = pipeline.plan().find_slot("result").value();
+    const int frame_count = 2000;
+    const int version_count = 50;
+    std::atomic<int> mixed_count{0};
+    std::atomic<int> max_seen{0};
+    auto feed = [&](int start) {
+        for (int frame = start; frame < frame_count; frame += 4)
+        {
+            std::vector<VarData> slots(pipeline.plan().slot_count());
+            slots.at(frame_slot).emplace<int>(frame * 1000);
+            pipeline.process(slots);
+            const int delta = slots.at(result_slot).as<int>() - frame * 1000;
+            if (delta % 2 != 0)
+            {
+                ++mixed_count;
+            }
+            int seen = max_seen.load();
+            while (delta / 2 > seen && !max_seen.compare_exchange_weak(seen, delta / 2)) {}
+        }
+    };
+    std::vector<std::thread> feeders;
+    for (int start = 0; start < 4; ++start)
+    {
+        feeders.emplace_back(feed, start);
+    }
+    for (int version = 1; version <= version_count; ++version)
+    {
+        pipeline.replace_steps({
+            {first, std::make_shared<AddVersionStep>("first", "frame", "middle", version)},
+            {second, std::make_shared<AddVersionStep>("second", "middle", "result", version)},
+        });
+        std::this_thread::yield();
+    }
+    for (auto& feeder : feeders)
+    {
+        feeder.join();
+    }
+    cout << "Versions published: " << pipeline.version() << ", highest version seen: " << max_seen.load()
+        << ", frames with mixed versions: " << mixed_count.load() << std::endl;
+    if (mixed_count.load() != 0 || pipeline.version() != static_cast<size_t>(version_count))
+    {
+        throw std::runtime_error("stream_pipeline_testcase_1: frames ran on mixed versions.");
+    }
+    // After the last swap, new frames see the last version.
+    std::vector<VarData> slots(pipeline.plan().slot_count());
+    slots.at(frame_slot).emplace<int>(0);
+    pipeline.process(slots);
+    if (slots.at(result_slot).as<int>() != 2 * version_count)
+    {
+        throw std::runtime_error("stream_pipeline_testcase_1: new frame did not use the new version.");
+    }
+    cout << "stream_pipeline_testcase_1 success." << std::endl;
+}
+
+INLINE_NEVER
+void stream_pipeline_testcase_2(OStrm cout)
+{
+    cout << "running stream_pipeline_testcase_2..." << std::endl;
+    Scope scope("stream_scope");
+    scope.add(std::make_shared<AddVersionStep>("first", "frame", "result", 0));
+    scope.freeze();
+    StreamPipeline pipeline(std::make_shared<Plan>(scope));
+    bool rejected = false;
+    try
+    {
+        pipeline.replace_step(0u, std::make_shared<AddVersionStep>("first", "frame", "other", 1));
+    }
+    catch (const std::invalid_argument& e)
+    {
+        cout << "Rejected: " << e.what() << std::endl;
+        rejected = true;
+    }
+    if (!rejected || pipeline.version() != 0u)
+    {
+        throw std::runtime_error("stream_pipeline_testcase_2: incompatible replacement accepted.");
+    }
+    cout << "stream_pipeline_testcase_2 success." << std::endl;
+}
+
+INLINE_NEVER
+void stream_pipeline_testcase()
+{
+    OStrm cout;
+    stream_pipeline_testcase_1(cout);
+    stream_pipeline_testcase_2(cout);
+}
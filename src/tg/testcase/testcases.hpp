@@ -7,3 +7,26 @@ void tg_testcase();
 void opaque_subindex_testcase();
 void opaque_ptr_key_testcase();
 void scope_step_iter_testcase();
+void roi_demand_testcase();
+void map_step_testcase();
+void branch_step_testcase();
+void loop_step_testcase();
+void scope_step_testcase();
+void dag_validator_testcase();
+void plan_edit_testcase();
+void stream_pipeline_testcase();
+void plan_reduce_testcase();
+void coarsening_testcase();
+void chunk_step_testcase();
+void opencv_backend_testcase();
+void batch_testcase();
+void runtime_testcase();
+void run_control_testcase();
+void priority_lane_testcase();
+void fair_scheduling_testcase();
+void resource_testcase();
+void memory_budget_testcase();
+void shape_inference_testcase();
+void buffer_pool_testcase();
+void prepare_testcase();
+void scratch_arena_testcase();